@@ -85,7 +85,9 @@ class TranslationUnit;
 class Semantic;
 class Control;
 class MemoryPool;
+class MemoryPoolStatistics;
 class DiagnosticClient;
+class NameTable;
 
 class Identifier;
 class Literal;
@@ -59,22 +59,14 @@
 #include "Symbols.h"
 #include "Names.h"
 #include "Array.h"
-#include <map> // ### replace me with LiteralTable
+#include "NameTable.h"
+#include <vector>
 #include <string>
+#include <new>
+#include <cstdlib>
 
 CPLUSPLUS_BEGIN_NAMESPACE
 
-template <typename _Iterator>
-static void delete_map_entries(_Iterator first, _Iterator last)
-{
-    for (; first != last; ++first)
-        delete first->second;
-}
-
-template <typename _Map>
-static void delete_map_entries(const _Map &m)
-{ delete_map_entries(m.begin(), m.end()); }
-
 template <typename _Iterator>
 static void delete_array_entries(_Iterator first, _Iterator last)
 {
@@ -86,33 +78,279 @@ template <typename _Array>
 static void delete_array_entries(const _Array &a)
 { delete_array_entries(a.begin(), a.end()); }
 
+static inline unsigned hashCombine(unsigned h, unsigned value)
+{ return h * 31 + value; }
+
+static inline unsigned hashFinish(unsigned h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline unsigned hashPointer(const void *ptr)
+{ return unsigned(reinterpret_cast<size_t>(ptr) >> 3); }
+
+struct TemplateNameIdKey {
+    Identifier *id;
+    const FullySpecifiedType *args;
+    unsigned argc;
+
+    TemplateNameIdKey(Identifier *id, const FullySpecifiedType *args, unsigned argc)
+        : id(id), args(args), argc(argc)
+    { }
+
+    unsigned hashCode() const
+    {
+        unsigned h = hashPointer(id);
+        for (unsigned i = 0; i < argc; ++i)
+            h = hashCombine(h, args[i].hashCode());
+        return hashFinish(h);
+    }
+
+    bool isEqualTo(TemplateNameId *name) const
+    {
+        if (name->identifier() != id || name->templateArgumentCount() != argc)
+            return false;
+        for (unsigned i = 0; i < argc; ++i) {
+            if (name->templateArgumentAt(i) != args[i])
+                return false;
+        }
+        return true;
+    }
+};
+
+struct QualifiedNameIdKey {
+    Name *const *names;
+    unsigned nameCount;
+    bool isGlobal;
+
+    QualifiedNameIdKey(Name *const *names, unsigned nameCount, bool isGlobal)
+        : names(names), nameCount(nameCount), isGlobal(isGlobal)
+    { }
+
+    unsigned hashCode() const
+    {
+        unsigned h = isGlobal;
+        for (unsigned i = 0; i < nameCount; ++i)
+            h = hashCombine(h, hashPointer(names[i]));
+        return hashFinish(h);
+    }
+
+    bool isEqualTo(QualifiedNameId *name) const
+    {
+        if (name->isGlobal() != isGlobal || name->nameCount() != nameCount)
+            return false;
+        for (unsigned i = 0; i < nameCount; ++i) {
+            if (name->nameAt(i) != names[i])
+                return false;
+        }
+        return true;
+    }
+};
+
+struct PointerToMemberTypeKey {
+    Name *memberName;
+    FullySpecifiedType type;
+
+    PointerToMemberTypeKey(Name *memberName, FullySpecifiedType type)
+        : memberName(memberName), type(type)
+    { }
+
+    unsigned hashCode() const
+    { return hashFinish(hashCombine(hashPointer(memberName), type.hashCode())); }
+
+    bool isEqualTo(PointerToMemberType *ty) const
+    { return ty->memberName() == memberName && ty->elementType() == type; }
+};
+
+struct ArrayKey {
+    FullySpecifiedType type;
+    size_t size;
+
+    ArrayKey(FullySpecifiedType type, size_t size)
+        : type(type), size(size)
+    { }
+
+    unsigned hashCode() const
+    { return hashFinish(hashCombine(type.hashCode(), unsigned(size))); }
+
+    bool isEqualTo(ArrayType *ty) const
+    { return ty->elementType() == type && ty->size() == size; }
+};
+
+// Keys for the names and types that are identified by a single value.
+template <typename _Tp>
+struct IdentifierKey {
+    Identifier *id;
+
+    IdentifierKey(Identifier *id) : id(id) {}
+
+    unsigned hashCode() const
+    { return hashFinish(hashPointer(id)); }
+
+    bool isEqualTo(_Tp *value) const
+    { return value->identifier() == id; }
+};
+
+template <typename _Tp>
+struct KindKey {
+    int kind;
+
+    KindKey(int kind) : kind(kind) {}
+
+    unsigned hashCode() const
+    { return hashFinish(unsigned(kind)); }
+
+    bool isEqualTo(_Tp *value) const
+    { return value->kind() == kind; }
+};
+
+template <typename _Tp>
+struct ElementTypeKey {
+    FullySpecifiedType type;
+
+    ElementTypeKey(FullySpecifiedType type) : type(type) {}
+
+    unsigned hashCode() const
+    { return hashFinish(type.hashCode()); }
+
+    bool isEqualTo(_Tp *value) const
+    { return value->elementType() == type; }
+};
+
+struct ConversionNameIdKey {
+    FullySpecifiedType type;
+
+    ConversionNameIdKey(FullySpecifiedType type) : type(type) {}
+
+    unsigned hashCode() const
+    { return hashFinish(type.hashCode()); }
+
+    bool isEqualTo(ConversionNameId *name) const
+    { return name->type() == type; }
+};
+
+struct NamedTypeKey {
+    Name *name;
+
+    NamedTypeKey(Name *name) : name(name) {}
+
+    unsigned hashCode() const
+    { return hashFinish(hashPointer(name)); }
+
+    bool isEqualTo(NamedType *ty) const
+    { return ty->name() == name; }
+};
+
+// Open addressing (linear probing) hash table of canonical names or types.
+// The table stores pointers to objects that live in the MemoryPool of the
+// control, together with their hash code; the objects are destroyed, but
+// not deallocated, by the table.
+template <typename _Tp>
+class CanonicalTable
+{
+    CanonicalTable(const CanonicalTable &other);
+    void operator =(const CanonicalTable &other);
+
+    struct Slot {
+        _Tp *value;
+        unsigned hashCode;
+    };
+
+public:
+    CanonicalTable()
+        : _slots(0),
+          _allocatedSlots(0),
+          _count(0)
+    { }
+
+    ~CanonicalTable()
+    {
+        for (unsigned i = 0; i < _allocatedSlots; ++i) {
+            if (_Tp *value = _slots[i].value)
+                value->~_Tp();
+        }
+        free(_slots);
+    }
+
+    unsigned size() const
+    { return _count; }
+
+    template <typename _Key>
+    _Tp *find(const _Key &key, unsigned hashCode) const
+    {
+        if (! _slots)
+            return 0;
+
+        const unsigned mask = _allocatedSlots - 1;
+        for (unsigned i = hashCode & mask; _slots[i].value; i = (i + 1) & mask) {
+            const Slot &slot = _slots[i];
+            if (slot.hashCode == hashCode && key.isEqualTo(slot.value))
+                return slot.value;
+        }
+
+        return 0;
+    }
+
+    void insert(_Tp *value, unsigned hashCode)
+    {
+        if ((_count + 1) * 3 > _allocatedSlots * 2)
+            rehash();
+
+        insert_helper(_slots, _allocatedSlots, value, hashCode);
+        ++_count;
+    }
+
+private:
+    static void insert_helper(Slot *slots, unsigned allocatedSlots, _Tp *value, unsigned hashCode)
+    {
+        const unsigned mask = allocatedSlots - 1;
+        unsigned i = hashCode & mask;
+        while (slots[i].value)
+            i = (i + 1) & mask;
+        slots[i].value = value;
+        slots[i].hashCode = hashCode;
+    }
+
+    void rehash()
+    {
+        const unsigned allocatedSlots = _allocatedSlots ? _allocatedSlots << 1 : 16;
+        Slot *slots = (Slot *) calloc(allocatedSlots, sizeof(Slot));
+
+        for (unsigned i = 0; i < _allocatedSlots; ++i) {
+            const Slot &slot = _slots[i];
+            if (slot.value)
+                insert_helper(slots, allocatedSlots, slot.value, slot.hashCode);
+        }
+
+        free(_slots);
+        _slots = slots;
+        _allocatedSlots = allocatedSlots;
+    }
+
+private:
+    Slot *_slots;
+    unsigned _allocatedSlots;
+    unsigned _count;
+};
+
 class Control::Data
 {
 public:
     Data(Control *control)
         : control(control),
           translationUnit(0),
-          diagnosticClient(0)
+          diagnosticClient(0),
+          nameTable(0)
     { }
 
     ~Data()
     {
-        // names
-        delete_map_entries(nameIds);
-        delete_map_entries(destructorNameIds);
-        delete_map_entries(operatorNameIds);
-        delete_map_entries(conversionNameIds);
-        delete_map_entries(qualifiedNameIds);
-        delete_map_entries(templateNameIds);
-
-        // types
-        delete_map_entries(integerTypes);
-        delete_map_entries(floatTypes);
-        delete_map_entries(pointerToMemberTypes);
-        delete_map_entries(pointerTypes);
-        delete_map_entries(referenceTypes);
-        delete_map_entries(arrayTypes);
-        delete_map_entries(namedTypes);
+        // the names and types are destroyed by their tables.
 
         // symbols
         delete_array_entries(declarations);
@@ -127,137 +365,177 @@ public:
         delete_array_entries(usingDeclarations);
     }
 
+    template <typename _Tp, typename _Key>
+    static _Tp *find(const CanonicalTable<_Tp> &table, const _Key &key, unsigned *hashCode)
+    {
+        *hashCode = key.hashCode();
+        return table.find(key, *hashCode);
+    }
+
     NameId *findOrInsertNameId(Identifier *id)
     {
         if (! id)
             return 0;
-        std::map<Identifier *, NameId *>::iterator it = nameIds.lower_bound(id);
-        if (it == nameIds.end() || it->first != id)
-            it = nameIds.insert(it, std::make_pair(id, new NameId(id)));
-        return it->second;
+        if (nameTable) {
+            if (NameId *name = nameTable->nameId(id))
+                return name;
+        }
+        unsigned h;
+        NameId *name = find(nameIds, IdentifierKey<NameId>(id), &h);
+        if (! name) {
+            name = new (pool.allocate(sizeof(NameId))) NameId(id);
+            nameIds.insert(name, h);
+        }
+        return name;
     }
 
     TemplateNameId *findOrInsertTemplateNameId(Identifier *id,
-        const std::vector<FullySpecifiedType> &templateArguments)
+                                               const FullySpecifiedType *args,
+                                               unsigned argc)
     {
         if (! id)
             return 0;
-        const TemplateNameIdKey key(id, templateArguments);
-        std::map<TemplateNameIdKey, TemplateNameId *>::iterator it =
-                templateNameIds.lower_bound(key);
-        if (it == templateNameIds.end() || it->first != key) {
-            const FullySpecifiedType *args = 0;
-            if (templateArguments.size())
-                args = &templateArguments[0];
-            TemplateNameId *templ = new TemplateNameId(id, args,
-                                                       templateArguments.size());
-            it = templateNameIds.insert(it, std::make_pair(key, templ));
+        unsigned h;
+        TemplateNameId *name = find(templateNameIds, TemplateNameIdKey(id, args, argc), &h);
+        if (! name) {
+            name = new (pool.allocate(sizeof(TemplateNameId))) TemplateNameId(id, args, argc);
+            templateNameIds.insert(name, h);
         }
-        return it->second;
+        return name;
     }
 
     DestructorNameId *findOrInsertDestructorNameId(Identifier *id)
     {
         if (! id)
             return 0;
-        std::map<Identifier *, DestructorNameId *>::iterator it = destructorNameIds.lower_bound(id);
-        if (it == destructorNameIds.end() || it->first != id)
-            it = destructorNameIds.insert(it, std::make_pair(id, new DestructorNameId(id)));
-        return it->second;
+        if (nameTable) {
+            if (DestructorNameId *name = nameTable->destructorNameId(id))
+                return name;
+        }
+        unsigned h;
+        DestructorNameId *name = find(destructorNameIds, IdentifierKey<DestructorNameId>(id), &h);
+        if (! name) {
+            name = new (pool.allocate(sizeof(DestructorNameId))) DestructorNameId(id);
+            destructorNameIds.insert(name, h);
+        }
+        return name;
     }
 
     OperatorNameId *findOrInsertOperatorNameId(int kind)
     {
-        const int key(kind);
-        std::map<int, OperatorNameId *>::iterator it = operatorNameIds.lower_bound(key);
-        if (it == operatorNameIds.end() || it->first != key)
-            it = operatorNameIds.insert(it, std::make_pair(key, new OperatorNameId(kind)));
-        return it->second;
+        if (nameTable)
+            return nameTable->operatorNameId(kind);
+        unsigned h;
+        OperatorNameId *name = find(operatorNameIds, KindKey<OperatorNameId>(kind), &h);
+        if (! name) {
+            name = new (pool.allocate(sizeof(OperatorNameId))) OperatorNameId(kind);
+            operatorNameIds.insert(name, h);
+        }
+        return name;
     }
 
     ConversionNameId *findOrInsertConversionNameId(FullySpecifiedType type)
     {
-        std::map<FullySpecifiedType, ConversionNameId *>::iterator it =
-                conversionNameIds.lower_bound(type);
-        if (it == conversionNameIds.end() || it->first != type)
-            it = conversionNameIds.insert(it, std::make_pair(type, new ConversionNameId(type)));
-        return it->second;
+        unsigned h;
+        ConversionNameId *name = find(conversionNameIds, ConversionNameIdKey(type), &h);
+        if (! name) {
+            name = new (pool.allocate(sizeof(ConversionNameId))) ConversionNameId(type);
+            conversionNameIds.insert(name, h);
+        }
+        return name;
     }
 
-    QualifiedNameId *findOrInsertQualifiedNameId(const std::vector<Name *> &names, bool isGlobal)
+    QualifiedNameId *findOrInsertQualifiedNameId(Name *const *names, unsigned nameCount,
+                                                 bool isGlobal)
     {
-        const QualifiedNameIdKey key(names, isGlobal);
-        std::map<QualifiedNameIdKey, QualifiedNameId *>::iterator it =
-                qualifiedNameIds.lower_bound(key);
-        if (it == qualifiedNameIds.end() || it->first != key) {
-            QualifiedNameId *name = new QualifiedNameId(&names[0], names.size(), isGlobal);
-            it = qualifiedNameIds.insert(it, std::make_pair(key, name));
+        unsigned h;
+        QualifiedNameId *name = find(qualifiedNameIds,
+                                     QualifiedNameIdKey(names, nameCount, isGlobal), &h);
+        if (! name) {
+            name = new (pool.allocate(sizeof(QualifiedNameId))) QualifiedNameId(names, nameCount,
+                                                                               isGlobal);
+            qualifiedNameIds.insert(name, h);
         }
-        return it->second;
+        return name;
     }
 
     IntegerType *findOrInsertIntegerType(int kind)
     {
-        const int key = int(kind);
-        std::map<int, IntegerType *>::iterator it = integerTypes.lower_bound(key);
-        if (it == integerTypes.end() || it->first != key)
-            it = integerTypes.insert(it, std::make_pair(key, new IntegerType(kind)));
-        return it->second;
+        unsigned h;
+        IntegerType *ty = find(integerTypes, KindKey<IntegerType>(kind), &h);
+        if (! ty) {
+            ty = new (pool.allocate(sizeof(IntegerType))) IntegerType(kind);
+            integerTypes.insert(ty, h);
+        }
+        return ty;
     }
 
     FloatType *findOrInsertFloatType(int kind)
     {
-        const int key = int(kind);
-        std::map<int, FloatType *>::iterator it = floatTypes.lower_bound(key);
-        if (it == floatTypes.end() || it->first != key)
-            it = floatTypes.insert(it, std::make_pair(key, new FloatType(kind)));
-        return it->second;
+        unsigned h;
+        FloatType *ty = find(floatTypes, KindKey<FloatType>(kind), &h);
+        if (! ty) {
+            ty = new (pool.allocate(sizeof(FloatType))) FloatType(kind);
+            floatTypes.insert(ty, h);
+        }
+        return ty;
     }
 
     PointerToMemberType *findOrInsertPointerToMemberType(Name *memberName, FullySpecifiedType elementType)
     {
-        const PointerToMemberTypeKey key(memberName, elementType);
-        std::map<PointerToMemberTypeKey, PointerToMemberType *>::iterator it =
-                pointerToMemberTypes.lower_bound(key);
-        if (it == pointerToMemberTypes.end() || it->first != key)
-            it = pointerToMemberTypes.insert(it, std::make_pair(key, new PointerToMemberType(memberName, elementType)));
-        return it->second;
+        unsigned h;
+        PointerToMemberType *ty = find(pointerToMemberTypes,
+                                       PointerToMemberTypeKey(memberName, elementType), &h);
+        if (! ty) {
+            ty = new (pool.allocate(sizeof(PointerToMemberType))) PointerToMemberType(memberName,
+                                                                                     elementType);
+            pointerToMemberTypes.insert(ty, h);
+        }
+        return ty;
     }
 
     PointerType *findOrInsertPointerType(FullySpecifiedType elementType)
     {
-        std::map<FullySpecifiedType, PointerType *>::iterator it =
-                pointerTypes.lower_bound(elementType);
-        if (it == pointerTypes.end() || it->first != elementType)
-            it = pointerTypes.insert(it, std::make_pair(elementType, new PointerType(elementType)));
-        return it->second;
+        unsigned h;
+        PointerType *ty = find(pointerTypes, ElementTypeKey<PointerType>(elementType), &h);
+        if (! ty) {
+            ty = new (pool.allocate(sizeof(PointerType))) PointerType(elementType);
+            pointerTypes.insert(ty, h);
+        }
+        return ty;
     }
 
     ReferenceType *findOrInsertReferenceType(FullySpecifiedType elementType)
     {
-        std::map<FullySpecifiedType, ReferenceType *>::iterator it =
-                referenceTypes.lower_bound(elementType);
-        if (it == referenceTypes.end() || it->first != elementType)
-            it = referenceTypes.insert(it, std::make_pair(elementType, new ReferenceType(elementType)));
-        return it->second;
+        unsigned h;
+        ReferenceType *ty = find(referenceTypes, ElementTypeKey<ReferenceType>(elementType), &h);
+        if (! ty) {
+            ty = new (pool.allocate(sizeof(ReferenceType))) ReferenceType(elementType);
+            referenceTypes.insert(ty, h);
+        }
+        return ty;
     }
 
     ArrayType *findOrInsertArrayType(FullySpecifiedType elementType, size_t size)
     {
-        const ArrayKey key(elementType, size);
-        std::map<ArrayKey, ArrayType *>::iterator it =
-                arrayTypes.lower_bound(key);
-        if (it == arrayTypes.end() || it->first != key)
-            it = arrayTypes.insert(it, std::make_pair(key, new ArrayType(elementType, size)));
-        return it->second;
+        unsigned h;
+        ArrayType *ty = find(arrayTypes, ArrayKey(elementType, size), &h);
+        if (! ty) {
+            ty = new (pool.allocate(sizeof(ArrayType))) ArrayType(elementType, size);
+            arrayTypes.insert(ty, h);
+        }
+        return ty;
     }
 
     NamedType *findOrInsertNamedType(Name *name)
     {
-        std::map<Name *, NamedType *>::iterator it = namedTypes.lower_bound(name);
-        if (it == namedTypes.end() || it->first != name)
-            it = namedTypes.insert(it, std::make_pair(name, new NamedType(name)));
-        return it->second;
+        unsigned h;
+        NamedType *ty = find(namedTypes, NamedTypeKey(name), &h);
+        if (! ty) {
+            ty = new (pool.allocate(sizeof(NamedType))) NamedType(name);
+            namedTypes.insert(ty, h);
+        }
+        return ty;
     }
 
     Declaration *newDeclaration(unsigned sourceLocation, Name *name)
@@ -339,133 +617,36 @@ public:
         return u;
     }
 
-    struct TemplateNameIdKey {
-        Identifier *id;
-        std::vector<FullySpecifiedType> templateArguments;
-
-        TemplateNameIdKey(Identifier *id, const std::vector<FullySpecifiedType> &templateArguments)
-            : id(id), templateArguments(templateArguments)
-        { }
-
-        bool operator == (const TemplateNameIdKey &other) const
-        { return id == other.id && templateArguments == other.templateArguments; }
-
-        bool operator != (const TemplateNameIdKey &other) const
-        { return ! operator==(other); }
-
-        bool operator < (const TemplateNameIdKey &other) const
-        {
-            if (id == other.id)
-                return std::lexicographical_compare(templateArguments.begin(),
-                                                    templateArguments.end(),
-                                                    other.templateArguments.begin(),
-                                                    other.templateArguments.end());
-            return id < other.id;
-        }
-    };
-
-    struct QualifiedNameIdKey {
-        std::vector<Name *> names;
-        bool isGlobal;
-
-        QualifiedNameIdKey(const std::vector<Name *> &names, bool isGlobal) :
-            names(names), isGlobal(isGlobal)
-        { }
-
-        bool operator == (const QualifiedNameIdKey &other) const
-        { return isGlobal == other.isGlobal && names == other.names; }
-
-        bool operator != (const QualifiedNameIdKey &other) const
-        { return ! operator==(other); }
-
-        bool operator < (const QualifiedNameIdKey &other) const
-        {
-            if (isGlobal == other.isGlobal)
-                return std::lexicographical_compare(names.begin(), names.end(),
-                                                    other.names.begin(), other.names.end());
-            return isGlobal < other.isGlobal;
-        }
-    };
-
-    struct ArrayKey {
-        FullySpecifiedType type;
-        size_t size;
-
-        ArrayKey() :
-            size(0)
-        { }
-
-        ArrayKey(FullySpecifiedType type, size_t size) :
-            type(type), size(size)
-        { }
-
-        bool operator == (const ArrayKey &other) const
-        { return type == other.type && size == other.size; }
-
-        bool operator != (const ArrayKey &other) const
-        { return ! operator==(other); }
-
-        bool operator < (const ArrayKey &other) const
-        {
-            if (type == other.type)
-                return size < other.size;
-            return type < other.type;
-        }
-    };
-
-    struct PointerToMemberTypeKey {
-        Name *memberName;
-        FullySpecifiedType type;
-
-        PointerToMemberTypeKey()
-            : memberName(0)
-        { }
-
-        PointerToMemberTypeKey(Name *memberName, FullySpecifiedType type)
-            : memberName(memberName), type(type)
-        { }
-
-        bool operator == (const PointerToMemberTypeKey &other) const
-        { return memberName == other.memberName && type == other.type; }
-
-        bool operator != (const PointerToMemberTypeKey &other) const
-        { return ! operator==(other); }
-
-        bool operator < (const PointerToMemberTypeKey &other) const
-        {
-            if (memberName == other.memberName)
-                return type < other.type;
-            return memberName < other.memberName;
-        }
-    };
-
     Control *control;
     TranslationUnit *translationUnit;
     DiagnosticClient *diagnosticClient;
+    NameTable *nameTable;
     LiteralTable<Identifier> identifiers;
     LiteralTable<StringLiteral> stringLiterals;
     LiteralTable<NumericLiteral> numericLiterals;
     LiteralTable<StringLiteral> fileNames;
 
-    // ### replace std::map with lookup tables. ASAP!
+    // the canonical names and types are allocated in the pool; it must
+    // outlive the tables.
+    MemoryPool pool;
 
     // names
-    std::map<Identifier *, NameId *> nameIds;
-    std::map<Identifier *, DestructorNameId *> destructorNameIds;
-    std::map<int, OperatorNameId *> operatorNameIds;
-    std::map<FullySpecifiedType, ConversionNameId *> conversionNameIds;
-    std::map<TemplateNameIdKey, TemplateNameId *> templateNameIds;
-    std::map<QualifiedNameIdKey, QualifiedNameId *> qualifiedNameIds;
+    CanonicalTable<NameId> nameIds;
+    CanonicalTable<DestructorNameId> destructorNameIds;
+    CanonicalTable<OperatorNameId> operatorNameIds;
+    CanonicalTable<ConversionNameId> conversionNameIds;
+    CanonicalTable<TemplateNameId> templateNameIds;
+    CanonicalTable<QualifiedNameId> qualifiedNameIds;
 
     // types
     VoidType voidType;
-    std::map<int, IntegerType *> integerTypes;
-    std::map<int, FloatType *> floatTypes;
-    std::map<PointerToMemberTypeKey, PointerToMemberType *> pointerToMemberTypes;
-    std::map<FullySpecifiedType, PointerType *> pointerTypes;
-    std::map<FullySpecifiedType, ReferenceType *> referenceTypes;
-    std::map<ArrayKey, ArrayType *> arrayTypes;
-    std::map<Name *, NamedType *> namedTypes;
+    CanonicalTable<IntegerType> integerTypes;
+    CanonicalTable<FloatType> floatTypes;
+    CanonicalTable<PointerToMemberType> pointerToMemberTypes;
+    CanonicalTable<PointerType> pointerTypes;
+    CanonicalTable<ReferenceType> referenceTypes;
+    CanonicalTable<ArrayType> arrayTypes;
+    CanonicalTable<NamedType> namedTypes;
 
     // symbols
     std::vector<Declaration *> declarations;
@@ -502,8 +683,21 @@ DiagnosticClient *Control::diagnosticClient() const
 void Control::setDiagnosticClient(DiagnosticClient *diagnosticClient)
 { d->diagnosticClient = diagnosticClient; }
 
+NameTable *Control::nameTable() const
+{ return d->nameTable; }
+
+MemoryPoolStatistics Control::memoryPoolStatistics() const
+{ return d->pool.statistics(); }
+
+void Control::setNameTable(NameTable *nameTable)
+{ d->nameTable = nameTable; }
+
 Identifier *Control::findOrInsertIdentifier(const char *chars, unsigned size)
-{ return d->identifiers.findOrInsertLiteral(chars, size); }
+{
+    if (d->nameTable)
+        return d->nameTable->findOrInsertIdentifier(chars, size);
+    return d->identifiers.findOrInsertLiteral(chars, size);
+}
 
 Identifier *Control::findOrInsertIdentifier(const char *chars)
 {
@@ -518,7 +712,11 @@ Control::IdentifierIterator Control::lastIdentifier() const
 { return d->identifiers.end(); }
 
 StringLiteral *Control::findOrInsertStringLiteral(const char *chars, unsigned size)
-{ return d->stringLiterals.findOrInsertLiteral(chars, size); }
+{
+    if (d->nameTable)
+        return d->nameTable->findOrInsertStringLiteral(chars, size);
+    return d->stringLiterals.findOrInsertLiteral(chars, size);
+}
 
 StringLiteral *Control::findOrInsertStringLiteral(const char *chars)
 {
@@ -527,7 +725,11 @@ StringLiteral *Control::findOrInsertStringLiteral(const char *chars)
 }
 
 NumericLiteral *Control::findOrInsertNumericLiteral(const char *chars, unsigned size)
-{ return d->numericLiterals.findOrInsertLiteral(chars, size); }
+{
+    if (d->nameTable)
+        return d->nameTable->findOrInsertNumericLiteral(chars, size);
+    return d->numericLiterals.findOrInsertLiteral(chars, size);
+}
 
 NumericLiteral *Control::findOrInsertNumericLiteral(const char *chars)
 {
@@ -556,10 +758,7 @@ NameId *Control::nameId(Identifier *id)
 TemplateNameId *Control::templateNameId(Identifier *id,
        FullySpecifiedType *const args,
        unsigned argv)
-{
-    std::vector<FullySpecifiedType> templateArguments(args, args + argv);
-    return d->findOrInsertTemplateNameId(id, templateArguments);
-}
+{ return d->findOrInsertTemplateNameId(id, args, argv); }
 
 DestructorNameId *Control::destructorNameId(Identifier *id)
 { return d->findOrInsertDestructorNameId(id); }
@@ -573,10 +772,7 @@ ConversionNameId *Control::conversionNameId(FullySpecifiedType type)
 QualifiedNameId *Control::qualifiedNameId(Name *const *names,
                                              unsigned nameCount,
                                              bool isGlobal)
-{
-    std::vector<Name *> classOrNamespaceNames(names, names + nameCount);
-    return d->findOrInsertQualifiedNameId(classOrNamespaceNames, isGlobal);
-}
+{ return d->findOrInsertQualifiedNameId(names, nameCount, isGlobal); }
 
 VoidType *Control::voidType()
 { return &d->voidType; }
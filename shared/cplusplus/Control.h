@@ -71,6 +71,16 @@ public:
     DiagnosticClient *diagnosticClient() const;
     void setDiagnosticClient(DiagnosticClient *diagnosticClient);
 
+    /// Returns the table that interns the identifiers, literals and simple
+    /// names of this control, or 0 if the control owns them.
+    NameTable *nameTable() const;
+
+    /// Must be called before any identifier or literal is created.
+    void setNameTable(NameTable *nameTable);
+
+    /// Returns the statistics of the pool of the canonical names and types.
+    MemoryPoolStatistics memoryPoolStatistics() const;
+
     /// Returns the canonical name id.
     NameId *nameId(Identifier *id);
 
@@ -153,6 +163,8 @@ public:
 
     typedef const Identifier *const *IdentifierIterator;
 
+    /// Iterates the identifiers owned by this control; empty if they are
+    /// interned in a name table.
     IdentifierIterator firstIdentifier() const;
     IdentifierIterator lastIdentifier() const;
 
@@ -201,4 +201,7 @@ bool FullySpecifiedType::operator < (const FullySpecifiedType &other) const
     return _type < other._type;
 }
 
+unsigned FullySpecifiedType::hashCode() const
+{ return unsigned(reinterpret_cast<size_t>(_type) >> 3) * 31 + _flags; }
+
 CPLUSPLUS_END_NAMESPACE
@@ -123,6 +123,8 @@ public:
     bool operator != (const FullySpecifiedType &other) const;
     bool operator < (const FullySpecifiedType &other) const;
 
+    unsigned hashCode() const;
+
 private:
     Type *_type;
     union {
@@ -55,9 +55,130 @@
 #include "TranslationUnit.h"
 #include <cctype>
 #include <cassert>
+#include <cstring>
+
+#if ! defined(CPLUSPLUS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define CPLUSPLUS_LEXER_SSE2
+#  include <emmintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
+#endif
 
 CPLUSPLUS_BEGIN_NAMESPACE
 
+namespace {
+
+// The scanners below find the end of runs of characters 16 bytes at a time
+// when SSE2 is available. They never read beyond `end', the remainder of the
+// input is scanned one byte at a time.
+
+#ifdef CPLUSPLUS_LEXER_SSE2
+inline unsigned firstBit(unsigned mask)
+{
+#  ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#  else
+    return __builtin_ctz(mask);
+#  endif
+}
+#endif
+
+// Returns the first occurrence of a, b, c or d in [it, end), or end.
+inline const char *findFirstOf(const char *it, const char *end,
+                               char a, char b, char c, char d)
+{
+#ifdef CPLUSPLUS_LEXER_SSE2
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    const __m128i vd = _mm_set1_epi8(d);
+
+    for (; end - it >= 16; it += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(it));
+        const __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va),
+                                                        _mm_cmpeq_epi8(chunk, vb)),
+                                           _mm_or_si128(_mm_cmpeq_epi8(chunk, vc),
+                                                        _mm_cmpeq_epi8(chunk, vd)));
+        if (const unsigned mask = _mm_movemask_epi8(found))
+            return it + firstBit(mask);
+    }
+#endif
+
+    for (; it != end; ++it) {
+        if (*it == a || *it == b || *it == c || *it == d)
+            break;
+    }
+    return it;
+}
+
+// Returns the first character in [it, end) that is neither a space nor a tab,
+// or end.
+inline const char *skipBlanks(const char *it, const char *end)
+{
+#ifdef CPLUSPLUS_LEXER_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    for (; end - it >= 16; it += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(it));
+        const __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                           _mm_cmpeq_epi8(chunk, tab));
+        const unsigned mask = _mm_movemask_epi8(blank) ^ 0xffff;
+        if (mask)
+            return it + firstBit(mask);
+    }
+#endif
+
+    for (; it != end; ++it) {
+        if (*it != ' ' && *it != '\t')
+            break;
+    }
+    return it;
+}
+
+// Returns the first character in [it, end) that is not an ASCII letter, digit
+// or underscore, or end. The lexer checks the characters of other locales.
+inline const char *skipIdentifierChars(const char *it, const char *end)
+{
+#ifdef CPLUSPLUS_LEXER_SSE2
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i beforeA = _mm_set1_epi8('a' - 1);
+    const __m128i afterZ = _mm_set1_epi8('z' + 1);
+    const __m128i before0 = _mm_set1_epi8('0' - 1);
+    const __m128i after9 = _mm_set1_epi8('9' + 1);
+    const __m128i underscore = _mm_set1_epi8('_');
+
+    for (; end - it >= 16; it += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(it));
+        // the bytes >= 0x80 compare as negative numbers, so they are neither
+        // letters nor digits.
+        const __m128i lower = _mm_or_si128(chunk, caseBit);
+        const __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, beforeA),
+                                             _mm_cmplt_epi8(lower, afterZ));
+        const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, before0),
+                                            _mm_cmplt_epi8(chunk, after9));
+        const __m128i identifierChar = _mm_or_si128(_mm_or_si128(letter, digit),
+                                                    _mm_cmpeq_epi8(chunk, underscore));
+        const unsigned mask = _mm_movemask_epi8(identifierChar) ^ 0xffff;
+        if (mask)
+            return it + firstBit(mask);
+    }
+#endif
+
+    for (; it != end; ++it) {
+        const char ch = *it;
+        if (! ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+               (ch >= '0' && ch <= '9') || ch == '_'))
+            break;
+    }
+    return it;
+}
+
+} // end of anonymous namespace
+
 Lexer::Lexer(TranslationUnit *unit)
     : _translationUnit(unit),
       _state(Lexer::DefaultState),
@@ -177,11 +298,13 @@ void Lexer::scan_helper(Token *tok)
 {
   _Lagain:
     while (_yychar && std::isspace(_yychar)) {
-        if (_yychar == '\n')
+        if (_yychar == '\n') {
             tok->newline = true;
-        else
+            yyinp();
+        } else {
             tok->whitespace = true;
-        yyinp();
+            yyskip(skipBlanks(_currentChar + 1, _lastChar));
+        }
     }
 
     if (! _translationUnit)
@@ -198,7 +321,7 @@ void Lexer::scan_helper(Token *tok)
 
         while (_yychar) {
             if (_yychar != '*')
-                yyinp();
+                yyskip(findFirstOf(_currentChar + 1, _lastChar, '*', '\n', '\0', '\0'));
             else {
                 yyinp();
                 if (_yychar == '/') {
@@ -247,7 +370,7 @@ void Lexer::scan_helper(Token *tok)
 
         while (_yychar && _yychar != quote) {
             if (_yychar != '\\')
-                yyinp();
+                yyskip(findFirstOf(_currentChar + 1, _lastChar, quote, '\\', '\n', '\0'));
             else {
                 yyinp(); // skip `\\'
 
@@ -396,9 +519,7 @@ void Lexer::scan_helper(Token *tok)
 
     case '/':
         if (_yychar == '/') {
-            do {
-                yyinp();
-            } while (_yychar && _yychar != '\n');
+            yyskip(findFirstOf(_currentChar + 1, _lastChar, '\n', '\0', '\0', '\0'));
             if (! _scanCommentTokens)
                 goto _Lagain;
             tok->kind = T_COMMENT;
@@ -406,7 +527,7 @@ void Lexer::scan_helper(Token *tok)
             yyinp();
             while (_yychar) {
                 if (_yychar != '*') {
-                    yyinp();
+                    yyskip(findFirstOf(_currentChar + 1, _lastChar, '*', '\n', '\0', '\0'));
                 } else {
                     yyinp();
                     if (_yychar == '/')
@@ -563,7 +684,7 @@ void Lexer::scan_helper(Token *tok)
 
             while (_yychar && _yychar != quote) {
                 if (_yychar != '\\')
-                    yyinp();
+                    yyskip(findFirstOf(_currentChar + 1, _lastChar, quote, '\\', '\n', '\0'));
                 else {
                     yyinp(); // skip `\\'
 
@@ -583,7 +704,7 @@ void Lexer::scan_helper(Token *tok)
         } else if (std::isalpha(ch) || ch == '_') {
             const char *yytext = _currentChar - 1;
             while (std::isalnum(_yychar) || _yychar == '_')
-                yyinp();
+                yyskip(skipIdentifierChars(_currentChar + 1, _lastChar));
             int yylen = _currentChar - yytext;
             if (_scanKeywords)
                 tok->kind = classify(yytext, yylen, _qtMocRunEnabled);
@@ -125,6 +125,14 @@ private:
         }
     }
 
+    // Moves to the character at `pos'. The characters skipped must not
+    // include newlines.
+    inline void yyskip(const char *pos)
+    {
+        _currentChar = pos - 1;
+        yyinp();
+    }
+
     void pushLineStartOffset();
 
 private:
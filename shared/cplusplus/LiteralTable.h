@@ -105,7 +105,7 @@ public:
     iterator end() const
     { return _literals + _literalCount + 1; }
 
-    _Literal *findOrInsertLiteral(const char *chars, unsigned size)
+    _Literal *findLiteral(const char *chars, unsigned size) const
     {
        if (_buckets) {
            unsigned h = _Literal::hashCode(chars, size);
@@ -116,6 +116,14 @@ public:
            }
        }
 
+       return 0;
+    }
+
+    _Literal *findOrInsertLiteral(const char *chars, unsigned size)
+    {
+       if (_Literal *literal = findLiteral(chars, size))
+           return literal;
+
        _Literal *literal = new _Literal(chars, size);
 
        if (++_literalCount == _allocatedLiterals) {
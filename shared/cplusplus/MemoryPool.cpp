@@ -57,21 +57,46 @@
 
 CPLUSPLUS_BEGIN_NAMESPACE
 
-MemoryPool::MemoryPool()
-    : _initializeAllocatedMemory(true),
+BlockAllocator::~BlockAllocator()
+{ }
+
+MemoryPoolStatistics::MemoryPoolStatistics()
+    : blockCount(0),
+      allocatedBytes(0),
+      usedBytes(0),
+      wastedBytes(0)
+{ }
+
+void MemoryPoolStatistics::add(const MemoryPoolStatistics &other)
+{
+    blockCount += other.blockCount;
+    allocatedBytes += other.allocatedBytes;
+    usedBytes += other.usedBytes;
+    wastedBytes += other.wastedBytes;
+}
+
+BlockAllocator *MemoryPool::_defaultBlockAllocator = 0;
+
+MemoryPool::MemoryPool(size_t blockSize)
+    : _blockAllocator(_defaultBlockAllocator),
+      _blockSize(blockSize),
+      _initializeAllocatedMemory(true),
       _blocks(0),
       _allocatedBlocks(0),
       _blockCount(-1),
+      _wastedBytes(0),
       ptr(0),
       end(0)
 { }
 
 MemoryPool::~MemoryPool()
 {
-    if (_blockCount != -1) {
-        for (int i = 0; i < _blockCount + 1; ++i) {
-            free(_blocks[i]);
-        }
+    for (int i = 0; i < _blockCount + 1; ++i) {
+        const Block &block = _blocks[i];
+        if (_blockAllocator)
+            _blockAllocator->releaseBlock(block.data, block.size);
+        else
+            free(block.data);
     }
 
     if (_blocks)
@@ -84,28 +109,65 @@ bool MemoryPool::initializeAllocatedMemory() const
 void MemoryPool::setInitializeAllocatedMemory(bool initializeAllocatedMemory)
 { _initializeAllocatedMemory = initializeAllocatedMemory; }
 
-void *MemoryPool::allocate_helper(size_t size)
+size_t MemoryPool::blockSize() const
+{ return _blockSize; }
+
+MemoryPoolStatistics MemoryPool::statistics() const
 {
-    assert(size < BLOCK_SIZE);
+    MemoryPoolStatistics stats;
+    stats.blockCount = _blockCount + 1;
+    for (int i = 0; i < _blockCount + 1; ++i)
+        stats.allocatedBytes += _blocks[i].size;
+    stats.wastedBytes = _wastedBytes;
+    stats.usedBytes = stats.allocatedBytes - _wastedBytes - (end - ptr);
+    return stats;
+}
 
+BlockAllocator *MemoryPool::blockAllocator()
+{ return _defaultBlockAllocator; }
+
+void MemoryPool::setBlockAllocator(BlockAllocator *blockAllocator)
+{ _defaultBlockAllocator = blockAllocator; }
+
+char *MemoryPool::allocateBlock(size_t size)
+{
     if (++_blockCount == _allocatedBlocks) {
         if (! _allocatedBlocks)
             _allocatedBlocks = 8;
         else
             _allocatedBlocks *= 2;
 
-        _blocks = (char **) realloc(_blocks, sizeof(char *) * _allocatedBlocks);
+        _blocks = (Block *) realloc(_blocks, sizeof(Block) * _allocatedBlocks);
+    }
+
+    Block &block = _blocks[_blockCount];
+    block.size = size;
+
+    if (_blockAllocator) {
+        block.data = (char *) _blockAllocator->allocateBlock(size);
+        if (_initializeAllocatedMemory)
+            memset(block.data, 0, size);
+    } else if (_initializeAllocatedMemory) {
+        block.data = (char *) calloc(1, size);
+    } else {
+        block.data = (char *) malloc(size);
     }
 
-    char *&block = _blocks[_blockCount];
+    return block.data;
+}
+
+void *MemoryPool::allocate_helper(size_t size)
+{
+    if (size >= _blockSize / 2) {
+        // big objects get a block of their own, the current block stays
+        // in use for the small ones.
+        return allocateBlock(size);
+    }
 
-    if (_initializeAllocatedMemory)
-        block = (char *) calloc(1, BLOCK_SIZE);
-    else
-        block = (char *) malloc(BLOCK_SIZE);
+    _wastedBytes += end - ptr;
 
-    ptr = block;
-    end = ptr + BLOCK_SIZE;
+    ptr = allocateBlock(_blockSize);
+    end = ptr + _blockSize;
 
     void *addr = ptr;
     ptr += size;
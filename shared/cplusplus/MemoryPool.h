@@ -59,18 +59,60 @@
 CPLUSPLUS_BEGIN_HEADER
 CPLUSPLUS_BEGIN_NAMESPACE
 
+class CPLUSPLUS_EXPORT BlockAllocator
+{
+public:
+    virtual ~BlockAllocator();
+
+    /// Returns a block of at least size bytes, allocated with malloc().
+    virtual void *allocateBlock(size_t size) = 0;
+
+    /// Takes back a block of size bytes returned by allocateBlock() or
+    /// allocated with malloc().
+    virtual void releaseBlock(void *block, size_t size) = 0;
+};
+
+class CPLUSPLUS_EXPORT MemoryPoolStatistics
+{
+public:
+    MemoryPoolStatistics();
+
+    void add(const MemoryPoolStatistics &other);
+
+    unsigned blockCount;
+    size_t allocatedBytes;
+    size_t usedBytes;
+    size_t wastedBytes;
+};
+
 class CPLUSPLUS_EXPORT MemoryPool
 {
     MemoryPool(const MemoryPool &other);
     void operator =(const MemoryPool &other);
 
 public:
-    MemoryPool();
+    enum { DEFAULT_BLOCK_SIZE = 8 * 1024 };
+
+    MemoryPool(size_t blockSize = DEFAULT_BLOCK_SIZE);
     ~MemoryPool();
 
     bool initializeAllocatedMemory() const;
     void setInitializeAllocatedMemory(bool initializeAllocatedMemory);
 
+    size_t blockSize() const;
+
+    /// Returns the number of blocks, the bytes they take, the bytes handed
+    /// out, and the bytes left unused at the end of the full blocks.
+    MemoryPoolStatistics statistics() const;
+
+    /// Returns the allocator the new pools take their blocks from, or 0 if
+    /// they use malloc() and free().
+    static BlockAllocator *blockAllocator();
+
+    /// Sets the allocator of the pools created from now on. It must outlive
+    /// them.
+    static void setBlockAllocator(BlockAllocator *blockAllocator);
+
     inline void *allocate(size_t size)
     {
         size = (size + 7) & ~7;
@@ -84,19 +126,24 @@ public:
 
 private:
     void *allocate_helper(size_t size);
+    char *allocateBlock(size_t size);
 
 private:
+    struct Block {
+        char *data;
+        size_t size;
+    };
+
+    BlockAllocator *_blockAllocator;
+    size_t _blockSize;
     bool _initializeAllocatedMemory;
-    char **_blocks;
+    Block *_blocks;
     int _allocatedBlocks;
     int _blockCount;
+    size_t _wastedBytes;
     char *ptr, *end;
 
-    enum
-    {
-        BLOCK_SIZE = 8 * 1024,
-        DEFAULT_BLOCK_COUNT = 8
-    };
+    static BlockAllocator *_defaultBlockAllocator;
 };
 
 CPLUSPLUS_END_NAMESPACE
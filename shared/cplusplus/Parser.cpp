@@ -2362,7 +2362,8 @@ bool Parser::parseSimpleDeclaration(DeclarationAST *&node,
 
 bool Parser::parseFunctionBody(StatementAST *&node)
 {
-    if (_translationUnit->skipFunctionBody()) {
+    if (_translationUnit->skipFunctionBody()
+            && (LA() != T_LBRACE || ! _translationUnit->isFunctionBodyParsed(cursor()))) {
         unsigned token_lbrace = 0;
         match(T_LBRACE, &token_lbrace);
         if (! token_lbrace)
@@ -2373,6 +2374,8 @@ bool Parser::parseFunctionBody(StatementAST *&node)
             rewind(tk.close_brace);
         unsigned token_rbrace = 0;
         match(T_RBRACE, &token_rbrace);
+        if (token_rbrace)
+            _translationUnit->addSkippedFunctionBody(token_lbrace, token_rbrace);
         return true;
     }
 
@@ -226,7 +226,7 @@ private:
     bool switchTemplateArguments(bool templateArguments);
     bool blockErrors(bool block);
 
-    inline const Token &tok() const
+    inline Token tok() const
     { return _translationUnit->tokenAt(_tokenIndex); }
 
     inline int LA(int n = 1) const
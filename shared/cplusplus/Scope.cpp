@@ -54,6 +54,7 @@
 #include "Symbols.h"
 #include "Names.h"
 #include "Literals.h"
+#include "NameVisitor.h"
 #include <cstdlib>
 #include <cassert>
 #include <cstring>
@@ -61,6 +62,76 @@
 
 CPLUSPLUS_BEGIN_NAMESPACE
 
+namespace {
+
+// Spreads the weak low bits of Literal::hashCode() over the table.
+inline unsigned bucketOf(unsigned hashCode, int hashSize)
+{
+    hashCode *= 2654435761u;
+    return (hashCode ^ (hashCode >> 16)) & (hashSize - 1);
+}
+
+// Computes the key of a symbol in the hash table: the identifier of its
+// name, or the kind of the operator it declares.
+class KeyOfName: protected NameVisitor
+{
+public:
+    KeyOfName()
+        : _identifier(0), _hashCode(0), _hasKey(false)
+    { }
+
+    virtual ~KeyOfName()
+    { }
+
+    // Returns false for the names that cannot be looked up, that is no
+    // name at all and the names of conversion functions.
+    bool operator()(Name *name, Identifier **identifier, unsigned *hashCode)
+    {
+        _hasKey = false;
+        accept(name);
+        *identifier = _identifier;
+        *hashCode = _hashCode;
+        return _hasKey;
+    }
+
+protected:
+    void setIdentifier(Identifier *identifier)
+    {
+        _identifier = identifier;
+        _hashCode = identifier ? identifier->hashCode() : 0;
+        _hasKey = identifier != 0;
+    }
+
+    virtual void visit(NameId *name)
+    { setIdentifier(name->identifier()); }
+
+    virtual void visit(TemplateNameId *name)
+    { setIdentifier(name->identifier()); }
+
+    virtual void visit(DestructorNameId *name)
+    { setIdentifier(name->identifier()); }
+
+    virtual void visit(OperatorNameId *name)
+    {
+        _identifier = 0;
+        _hashCode = name->kind();
+        _hasKey = true;
+    }
+
+    virtual void visit(ConversionNameId *)
+    { }
+
+    virtual void visit(QualifiedNameId *name)
+    { accept(name->unqualifiedNameId()); }
+
+private:
+    Identifier *_identifier;
+    unsigned _hashCode;
+    bool _hasKey;
+};
+
+} // end of anonymous namespace
+
 Scope::Scope(ScopedSymbol *owner)
     : _owner(owner),
       _symbols(0),
@@ -68,6 +139,7 @@ Scope::Scope(ScopedSymbol *owner)
       _symbolCount(-1),
       _hash(0),
       _hashSize(0),
+      _entryCount(0),
       _uses(0),
       _allocatedUses(0),
       _useCount(-1)
@@ -188,38 +260,54 @@ void Scope::enterSymbol(Symbol *symbol)
     symbol->_scope = this;
     _symbols[_symbolCount] = symbol;
 
-    if (_symbolCount >= _hashSize * 0.6)
+    insertSymbol(symbol);
+}
+
+Scope::Entry *Scope::findEntry(Identifier *identifier, unsigned hashCode) const
+{
+    const int mask = _hashSize - 1;
+    int h = bucketOf(hashCode, _hashSize);
+    for (Entry *entry = &_hash[h]; entry->symbols; entry = &_hash[h]) {
+        if (entry->hashCode == hashCode) {
+            if (entry->identifier == identifier)
+                return entry;
+            else if (identifier && entry->identifier && entry->identifier->isEqualTo(identifier))
+                return entry;
+        }
+        h = (h + 1) & mask;
+    }
+    return &_hash[h];
+}
+
+void Scope::insertSymbol(Symbol *symbol)
+{
+    Identifier *identifier = 0;
+    unsigned hashCode = 0;
+    KeyOfName keyOf;
+    if (! keyOf(symbol->name(), &identifier, &hashCode)) {
+        symbol->_next = 0;
+        return;
+    }
+
+    if ((_entryCount + 1) * 2 > _hashSize)
         rehash();
-    else {
-        const unsigned h = hashValue(symbol);
-        symbol->_next = _hash[h];
-        _hash[h] = symbol;
+
+    Entry *entry = findEntry(identifier, hashCode);
+    if (! entry->symbols) {
+        entry->identifier = identifier;
+        entry->hashCode = hashCode;
+        ++_entryCount;
     }
+    symbol->_next = entry->symbols;
+    entry->symbols = symbol;
 }
 
 Symbol *Scope::lookat(Identifier *id) const
 {
-    if (! _hash)
+    if (! _hash || ! id)
         return 0;
 
-    const unsigned h = id->hashCode() % _hashSize;
-    Symbol *symbol = _hash[h];
-    for (; symbol; symbol = symbol->_next) {
-        Name *identity = symbol->identity();
-        if (NameId *nameId = identity->asNameId()) {
-            if (nameId->identifier()->isEqualTo(id))
-                break;
-        } else if (TemplateNameId *t = identity->asTemplateNameId()) {
-            if (t->identifier()->isEqualTo(id))
-                break;
-        } else if (DestructorNameId *d = identity->asDestructorNameId()) {
-            if (d->identifier()->isEqualTo(id))
-                break;
-        } else if (identity->isQualifiedNameId()) {
-            assert(0);
-        }
-    }
-    return symbol;
+    return findEntry(id, id->hashCode())->symbols;
 }
 
 Symbol *Scope::lookat(int operatorId) const
@@ -227,42 +315,36 @@ Symbol *Scope::lookat(int operatorId) const
     if (! _hash)
         return 0;
 
-    const unsigned h = operatorId % _hashSize;
-    Symbol *symbol = _hash[h];
-    for (; symbol; symbol = symbol->_next) {
-        Name *identity = symbol->identity();
-        if (OperatorNameId *op = identity->asOperatorNameId()) {
-            if (op->kind() == operatorId)
-                break;
-        }
-    }
-    return symbol;
+    return findEntry(0, unsigned(operatorId))->symbols;
 }
 
 void Scope::rehash()
 {
+    Entry *previousHash = _hash;
+    const int previousHashSize = _hashSize;
+
     _hashSize <<= 1;
 
     if (! _hashSize)
-        _hashSize = DefaultInitialSize;
+        _hashSize = DefaultInitialHashSize;
 
-    _hash = reinterpret_cast<Symbol **>(realloc(_hash, sizeof(Symbol *) * _hashSize));
-    memset(_hash, 0, sizeof(Symbol *) * _hashSize);
+    _hash = reinterpret_cast<Entry *>(calloc(_hashSize, sizeof(Entry)));
 
-    for (int index = 0; index < _symbolCount + 1; ++index) {
-        Symbol *symbol = _symbols[index];
-        const unsigned h = hashValue(symbol);
-        symbol->_next = _hash[h];
-        _hash[h] = symbol;
-    }
-}
+    // The chains live in the symbols, so only the heads have to move.
+    const int mask = _hashSize - 1;
+    for (int index = 0; index < previousHashSize; ++index) {
+        const Entry &entry = previousHash[index];
+        if (! entry.symbols)
+            continue;
 
-unsigned Scope::hashValue(Symbol *symbol) const
-{
-    if (! symbol)
-        return 0;
+        int h = bucketOf(entry.hashCode, _hashSize);
+        while (_hash[h].symbols)
+            h = (h + 1) & mask;
+        _hash[h] = entry;
+    }
 
-    return symbol->hashCode() % _hashSize;
+    if (previousHash)
+        free(previousHash);
 }
 
 bool Scope::isEmpty() const
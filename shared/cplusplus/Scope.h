@@ -161,7 +161,11 @@ public:
     /// Returns the last Symbol in the scope.
     iterator lastSymbol() const;
 
+    /// Returns the most recently entered Symbol named \a id; the other
+    /// Symbols with that name are reached through Symbol::next().
     Symbol *lookat(Identifier *id) const;
+
+    /// Returns the most recently entered operator Symbol of the given kind.
     Symbol *lookat(int operatorId) const;
 
     unsigned useCount() const;
@@ -169,14 +173,27 @@ public:
     void addUse(unsigned sourceOffset, Name *name);
 
 private:
-    /// Returns the hash value for the given Symbol.
-    unsigned hashValue(Symbol *symbol) const;
+    struct Entry
+    {
+        Symbol *symbols;        // the chain of Symbols with this name
+        Identifier *identifier; // 0 for operator names
+        unsigned hashCode;      // the hash code of identifier or the operator kind
+    };
+
+    /// Returns the slot of the given name, or the empty slot it would go to.
+    Entry *findEntry(Identifier *identifier, unsigned hashCode) const;
+
+    /// Adds the Symbol to the chain of its name.
+    void insertSymbol(Symbol *symbol);
 
-    /// Updates the hash table.
+    /// Grows the hash table.
     void rehash();
 
 private:
-    enum { DefaultInitialSize = 11 };
+    enum {
+        DefaultInitialSize = 11,
+        DefaultInitialHashSize = 8
+    };
 
     ScopedSymbol *_owner;
 
@@ -184,8 +201,9 @@ private:
     int _allocatedSymbols;
     int _symbolCount;
 
-    Symbol **_hash;
+    Entry *_hash;
     int _hashSize;
+    int _entryCount;
 
     Use *_uses;
     int _allocatedUses;
@@ -206,6 +206,9 @@ unsigned Symbol::sourceLocation() const
 unsigned Symbol::sourceOffset() const
 { return _sourceOffset; }
 
+void Symbol::setSourceOffset(unsigned sourceOffset)
+{ _sourceOffset = sourceOffset; }
+
 unsigned Symbol::line() const
 {
     unsigned line = 0, column = 0;
@@ -98,6 +98,9 @@ public:
     /// Returns this Symbol's source offset.
     unsigned sourceOffset() const;
 
+    /// Sets this Symbol's source offset.
+    void setSourceOffset(unsigned sourceOffset);
+
     /// Returns this Symbol's line number.
     unsigned line() const;
 
@@ -134,7 +137,7 @@ public:
     /// Returns this Symbol's scope.
     Scope *scope() const;
 
-    /// Returns the next chained Symbol.
+    /// Returns the previous Symbol with the same name in this Symbol's scope.
     Symbol *next() const;
 
     /// Returns true if this Symbol has friend storage specifier.
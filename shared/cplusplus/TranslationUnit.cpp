@@ -65,6 +65,101 @@
 
 CPLUSPLUS_BEGIN_NAMESPACE
 
+namespace {
+
+enum TokenFlag {
+    NewlineFlag    = 0x01,
+    WhitespaceFlag = 0x02,
+    JoinedFlag     = 0x04,
+    ExpandedFlag   = 0x08
+};
+
+} // end of anonymous namespace
+
+// Gives the identifiers and literals of the tokens an index in the array of
+// the distinct pointers of the translation unit, while it is tokenized.
+class TranslationUnit::PointerIndex
+{
+    PointerIndex(const PointerIndex &other);
+    void operator =(const PointerIndex &other);
+
+public:
+    PointerIndex(Array<void *, 8> *pointers)
+        : _pointers(pointers),
+          _slots(0),
+          _slotCount(0),
+          _count(0)
+    {
+        _pointers->push_back(0);
+        rehash(256);
+    }
+
+    ~PointerIndex()
+    { free(_slots); }
+
+    unsigned indexOf(void *ptr)
+    {
+        if (! ptr)
+            return 0;
+
+        unsigned h = hash(ptr) & (_slotCount - 1);
+        for (; _slots[h].ptr; h = (h + 1) & (_slotCount - 1)) {
+            if (_slots[h].ptr == ptr)
+                return _slots[h].index;
+        }
+
+        const unsigned index = _pointers->size();
+        _pointers->push_back(ptr);
+        _slots[h].ptr = ptr;
+        _slots[h].index = index;
+
+        if (++_count * 2 > _slotCount)
+            rehash(_slotCount * 2);
+
+        return index;
+    }
+
+private:
+    struct Slot {
+        void *ptr;
+        unsigned index;
+    };
+
+    static unsigned hash(void *ptr)
+    {
+        unsigned h = unsigned(reinterpret_cast<size_t>(ptr) >> 3);
+        h ^= h >> 16;
+        h *= 0x45d9f3b;
+        h ^= h >> 16;
+        return h;
+    }
+
+    void rehash(unsigned slotCount)
+    {
+        Slot *slots = (Slot *) calloc(slotCount, sizeof(Slot));
+
+        for (unsigned i = 0; i < _slotCount; ++i) {
+            if (! _slots[i].ptr)
+                continue;
+
+            unsigned h = hash(_slots[i].ptr) & (slotCount - 1);
+            while (slots[h].ptr)
+                h = (h + 1) & (slotCount - 1);
+            slots[h] = _slots[i];
+        }
+
+        free(_slots);
+        _slots = slots;
+        _slotCount = slotCount;
+    }
+
+private:
+    Array<void *, 8> *_pointers;
+    Slot *_slots;
+    unsigned _slotCount;
+    unsigned _count;
+};
+
 TranslationUnit::TranslationUnit(Control *control, StringLiteral *fileId)
     : _control(control),
       _fileId(fileId),
@@ -72,9 +167,11 @@ TranslationUnit::TranslationUnit(Control *control, StringLiteral *fileId)
       _lastSourceChar(0),
       _pool(0),
       _ast(0),
+      _firstParsedFunctionBodyLine(0),
+      _lastParsedFunctionBodyLine(0),
       _flags(0)
 {
-    _tokens = new Array<Token, 8>();
+    _tokens = new Tokens;
     _previousTranslationUnit = control->switchTranslationUnit(this);
     _pool = new MemoryPool();
 }
@@ -120,32 +217,64 @@ void TranslationUnit::setSource(const char *source, unsigned size)
 }
 
 unsigned TranslationUnit::tokenCount() const
-{ return _tokens->size(); }
+{ return _tokens->kinds.size(); }
+
+Token TranslationUnit::tokenAt(unsigned index) const
+{
+    Token tk;
+    tk.kind = _tokens->kinds.at(index);
+
+    const unsigned char flags = _tokens->flags.at(index);
+    tk.newline = (flags & NewlineFlag) != 0;
+    tk.whitespace = (flags & WhitespaceFlag) != 0;
+    tk.joined = (flags & JoinedFlag) != 0;
+    tk.expanded = (flags & ExpandedFlag) != 0;
+
+    tk.length = _tokens->lengths.at(index);
+    tk.offset = _tokens->offsets.at(index);
 
-const Token &TranslationUnit::tokenAt(unsigned index) const
-{ return _tokens->at(index); }
+    if (tk.kind == T_LBRACE)
+        tk.close_brace = _tokens->values.at(index);
+    else
+        tk.ptr = _tokens->pointers.at(_tokens->values.at(index));
+
+    return tk;
+}
+
+void *TranslationUnit::tokenPointer(unsigned index) const
+{
+    if (_tokens->kinds.at(index) == T_LBRACE)
+        return 0;
 
-int TranslationUnit::tokenKind(unsigned index) const
-{ return _tokens->at(index).kind; }
+    return _tokens->pointers.at(_tokens->values.at(index));
+}
 
 Identifier *TranslationUnit::identifier(unsigned index) const
-{ return _tokens->at(index).identifier; }
+{ return static_cast<Identifier *>(tokenPointer(index)); }
 
 Literal *TranslationUnit::literal(unsigned index) const
-{ return _tokens->at(index).literal; }
+{ return static_cast<Literal *>(tokenPointer(index)); }
 
 StringLiteral *TranslationUnit::stringLiteral(unsigned index) const
-{ return _tokens->at(index).string; }
+{ return static_cast<StringLiteral *>(tokenPointer(index)); }
 
 NumericLiteral *TranslationUnit::numericLiteral(unsigned index) const
-{ return _tokens->at(index).number; }
+{ return static_cast<NumericLiteral *>(tokenPointer(index)); }
 
 unsigned TranslationUnit::matchingBrace(unsigned index) const
-{ return _tokens->at(index).close_brace; }
+{ return _tokens->values.at(index); }
 
 MemoryPool *TranslationUnit::memoryPool() const
 { return _pool; }
 
+MemoryPoolStatistics TranslationUnit::memoryPoolStatistics() const
+{
+    if (_pool)
+        return _pool->statistics();
+
+    return MemoryPoolStatistics(); // the AST has been released.
+}
+
 AST *TranslationUnit::ast() const
 { return _ast; }
 
@@ -166,7 +295,8 @@ void TranslationUnit::tokenize()
     lex.setQtMocRunEnabled(_qtMocRunEnabled);
 
     std::stack<unsigned> braces;
-    _tokens->push_back(Token()); // the first token needs to be invalid!
+    PointerIndex pointerIndex(&_tokens->pointers);
+    appendToken(Token(), &pointerIndex); // the first token needs to be invalid!
 
     pushLineOffset(0);
     pushPreprocessorLine(0, 1, fileId());
@@ -197,27 +327,98 @@ void TranslationUnit::tokenize()
                 lex(&tk);
             goto _Lrecognize;
         } else if (tk.kind == T_LBRACE) {
-            braces.push(_tokens->size());
+            braces.push(tokenCount());
         } else if (tk.kind == T_RBRACE && ! braces.empty()) {
             const unsigned open_brace_index = braces.top();
             braces.pop();
-            (*_tokens)[open_brace_index].close_brace = _tokens->size();
+            _tokens->values[open_brace_index] = tokenCount();
         }
-        _tokens->push_back(tk);
+        appendToken(tk, &pointerIndex);
     } while (tk.kind);
 
     for (; ! braces.empty(); braces.pop()) {
         unsigned open_brace_index = braces.top();
-        (*_tokens)[open_brace_index].close_brace = _tokens->size();
+        _tokens->values[open_brace_index] = tokenCount();
     }
 }
 
+void TranslationUnit::appendToken(const Token &tk, PointerIndex *pointerIndex)
+{
+    unsigned char flags = 0;
+    if (tk.newline)
+        flags |= NewlineFlag;
+    if (tk.whitespace)
+        flags |= WhitespaceFlag;
+    if (tk.joined)
+        flags |= JoinedFlag;
+    if (tk.expanded)
+        flags |= ExpandedFlag;
+
+    _tokens->kinds.push_back(tk.kind);
+    _tokens->flags.push_back(flags);
+    _tokens->lengths.push_back(tk.length);
+    _tokens->offsets.push_back(tk.offset);
+
+    if (tk.kind == T_LBRACE)
+        _tokens->values.push_back(0); // set to the closing brace later
+    else
+        _tokens->values.push_back(pointerIndex->indexOf(tk.ptr));
+}
+
 bool TranslationUnit::skipFunctionBody() const
 { return _skipFunctionBody; }
 
 void TranslationUnit::setSkipFunctionBody(bool skipFunctionBody)
 { _skipFunctionBody = skipFunctionBody; }
 
+void TranslationUnit::setParsedFunctionBodyLines(unsigned firstLine, unsigned lastLine)
+{
+    _firstParsedFunctionBodyLine = firstLine;
+    _lastParsedFunctionBodyLine = lastLine;
+}
+
+bool TranslationUnit::isFunctionBodyParsed(unsigned lbraceIndex) const
+{
+    if (! _skipFunctionBody)
+        return true;
+    else if (! _firstParsedFunctionBodyLine)
+        return false;
+
+    unsigned firstLine = 0, lastLine = 0;
+    getTokenPosition(lbraceIndex, &firstLine);
+
+    if (firstLine > _lastParsedFunctionBodyLine)
+        return false;
+
+    const unsigned rbraceIndex = matchingBrace(lbraceIndex);
+    if (rbraceIndex && rbraceIndex < tokenCount())
+        getTokenPosition(rbraceIndex, &lastLine);
+    else
+        lastLine = firstLine;
+
+    return lastLine >= _firstParsedFunctionBodyLine;
+}
+
+void TranslationUnit::addSkippedFunctionBody(unsigned lbraceIndex, unsigned rbraceIndex)
+{
+    unsigned firstLine = 0, lastLine = 0;
+    getTokenPosition(lbraceIndex, &firstLine);
+    getTokenPosition(rbraceIndex, &lastLine);
+    _skippedFunctionBodies.push_back(firstLine);
+    _skippedFunctionBodies.push_back(lastLine);
+}
+
+unsigned TranslationUnit::skippedFunctionBodyCount() const
+{ return _skippedFunctionBodies.size() / 2; }
+
+void TranslationUnit::getSkippedFunctionBody(unsigned index,
+                                             unsigned *firstLine,
+                                             unsigned *lastLine) const
+{
+    *firstLine = _skippedFunctionBodies[index * 2];
+    *lastLine = _skippedFunctionBodies[index * 2 + 1];
+}
+
 bool TranslationUnit::parse(ParseMode mode)
 {
     if (isParsed())
@@ -271,6 +472,18 @@ void TranslationUnit::pushPreprocessorLine(unsigned offset,
                                            StringLiteral *fileName)
 { _ppLines.push_back(PPLine(offset, line, fileName)); }
 
+unsigned TranslationUnit::lineOffsetCount() const
+{ return _lineOffsets.size(); }
+
+unsigned TranslationUnit::lineOffsetAt(unsigned index) const
+{ return _lineOffsets[index]; }
+
+unsigned TranslationUnit::preprocessorLineCount() const
+{ return _ppLines.size(); }
+
+const TranslationUnit::PPLine &TranslationUnit::preprocessorLineAt(unsigned index) const
+{ return _ppLines[index]; }
+
 unsigned TranslationUnit::findLineNumber(unsigned offset) const
 {
     std::vector<unsigned>::const_iterator it =
@@ -433,7 +646,7 @@ void TranslationUnit::fatal(unsigned index, const char *format, ...)
 
 void TranslationUnit::showErrorLine(unsigned index, unsigned column, FILE *out)
 {
-    unsigned lineOffset = _lineOffsets[findLineNumber(_tokens->at(index).offset)];
+    unsigned lineOffset = _lineOffsets[findLineNumber(_tokens->offsets.at(index))];
     for (const char *cp = _firstSourceChar + lineOffset + 1; *cp && *cp != '\n'; ++cp) {
         fputc(*cp, out);
     }
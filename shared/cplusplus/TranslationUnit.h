@@ -85,8 +85,10 @@ public:
     void setSource(const char *source, unsigned size);
 
     unsigned tokenCount() const;
-    const Token &tokenAt(unsigned index) const;
-    int tokenKind(unsigned index) const;
+    Token tokenAt(unsigned index) const;
+
+    inline int tokenKind(unsigned index) const
+    { return _tokens->kinds.at(index); }
 
     unsigned matchingBrace(unsigned index) const;
     Identifier *identifier(unsigned index) const;
@@ -95,6 +97,7 @@ public:
     NumericLiteral *numericLiteral(unsigned index) const;
 
     MemoryPool *memoryPool() const;
+    MemoryPoolStatistics memoryPoolStatistics() const;
     AST *ast() const;
 
     bool blockErrors(bool block);
@@ -112,6 +115,18 @@ public:
     bool skipFunctionBody() const;
     void setSkipFunctionBody(bool skipFunctionBody);
 
+    // When skipFunctionBody() is set, the bodies that overlap the lines
+    // [firstLine, lastLine] are parsed nevertheless.
+    void setParsedFunctionBodyLines(unsigned firstLine, unsigned lastLine);
+    bool isFunctionBodyParsed(unsigned lbraceIndex) const;
+
+    // The lines of the function bodies skipped by the parser.
+    void addSkippedFunctionBody(unsigned lbraceIndex, unsigned rbraceIndex);
+    unsigned skippedFunctionBodyCount() const;
+    void getSkippedFunctionBody(unsigned index,
+                                unsigned *firstLine,
+                                unsigned *lastLine) const;
+
     bool isParsed() const;
 
     enum ParseMode {
@@ -163,22 +178,53 @@ public:
         { return offset < other.offset; }
     };
 
+    unsigned lineOffsetCount() const;
+    unsigned lineOffsetAt(unsigned index) const;
+
+    unsigned preprocessorLineCount() const;
+    const PPLine &preprocessorLineAt(unsigned index) const;
+
 private:
     unsigned findLineNumber(unsigned offset) const;
     unsigned findColumnNumber(unsigned offset, unsigned lineNumber) const;
     PPLine findPreprocessorLine(unsigned offset) const;
     void showErrorLine(unsigned index, unsigned column, FILE *out);
 
+    class PointerIndex;
+    void appendToken(const Token &tk, PointerIndex *pointerIndex);
+    void *tokenPointer(unsigned index) const;
+
+    // The fields of the tokens are stored in separate arrays, so that the
+    // parser looking ahead at the kinds of the next tokens touches as little
+    // memory as possible.
+    struct Tokens {
+        Array<unsigned char, 8> kinds;
+        Array<unsigned char, 8> flags;
+        Array<unsigned short, 8> lengths;
+        Array<unsigned, 8> offsets;
+
+        // The index of the closing brace for T_LBRACE tokens, otherwise the
+        // index of the identifier or literal of the token in pointers.
+        Array<unsigned, 8> values;
+
+        // The distinct identifiers and literals of the translation unit.
+        // The first one is null, for the tokens without any.
+        Array<void *, 8> pointers;
+    };
+
     Control *_control;
     StringLiteral *_fileId;
     const char *_firstSourceChar;
     const char *_lastSourceChar;
-    Array<Token, 8> *_tokens;
+    Tokens *_tokens;
     std::vector<unsigned> _lineOffsets;
     std::vector<PPLine> _ppLines;
+    std::vector<unsigned> _skippedFunctionBodies;
     MemoryPool *_pool;
     AST *_ast;
     TranslationUnit *_previousTranslationUnit;
+    unsigned _firstParsedFunctionBodyLine;
+    unsigned _lastParsedFunctionBodyLine;
     union {
         unsigned _flags;
         struct {
@@ -24,6 +24,7 @@ HEADERS += \
     $$PWD/MemoryPool.h \
     $$PWD/Name.h \
     $$PWD/NameVisitor.h \
+    $$PWD/NameTable.h \
     $$PWD/Names.h \
     $$PWD/Parser.h \
     $$PWD/Scope.h \
@@ -58,6 +59,7 @@ SOURCES += \
     $$PWD/MemoryPool.cpp \
     $$PWD/Name.cpp \
     $$PWD/NameVisitor.cpp \
+    $$PWD/NameTable.cpp \
     $$PWD/Names.cpp \
     $$PWD/Parser.cpp \
     $$PWD/Scope.cpp \
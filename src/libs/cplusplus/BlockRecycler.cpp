@@ -0,0 +1,191 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#include "BlockRecycler.h"
+
+#include <QtCore/QMutexLocker>
+
+#include <cstdlib>
+
+using namespace CPlusPlus;
+
+enum {
+    DefaultMaximumCachedBytes = 32 * 1024 * 1024,
+    BatchSize = 16 // the number of blocks a thread takes from the shared list at once
+};
+
+class BlockRecycler::ThreadCache
+{
+public:
+    ThreadCache(BlockRecycler *recycler)
+        : recycler(recycler),
+          bytes(0)
+    { }
+
+    ~ThreadCache()
+    {
+        // the thread exits, the other threads get its blocks.
+        QMutableHashIterator<size_t, QVector<void *> > it(blocks);
+        while (it.hasNext()) {
+            it.next();
+            recycler->addSharedBlocks(&it.value(), it.key(), it.value().size());
+        }
+    }
+
+    BlockRecycler *recycler;
+    Blocks blocks;
+    size_t bytes;
+};
+
+BlockRecycler::BlockRecycler()
+    : _sharedBytes(0),
+      _maximumCachedBytes(DefaultMaximumCachedBytes)
+{ }
+
+BlockRecycler::~BlockRecycler()
+{
+    foreach (const QVector<void *> &blocks, _sharedBlocks) {
+        foreach (void *block, blocks)
+            free(block);
+    }
+}
+
+BlockRecycler *BlockRecycler::instance()
+{
+    static BlockRecycler *recycler = new BlockRecycler;
+    return recycler;
+}
+
+size_t BlockRecycler::maximumCachedBytes() const
+{
+    QMutexLocker locker(&_mutex);
+    return _maximumCachedBytes;
+}
+
+void BlockRecycler::setMaximumCachedBytes(size_t maximumCachedBytes)
+{
+    QMutexLocker locker(&_mutex);
+    _maximumCachedBytes = maximumCachedBytes;
+}
+
+// Returns the bytes of the shared list; the blocks cached by the threads
+// are not included.
+size_t BlockRecycler::cachedBytes() const
+{
+    QMutexLocker locker(&_mutex);
+    return _sharedBytes;
+}
+
+void *BlockRecycler::allocateBlock(size_t size)
+{
+    if (size > MaximumBlockSize)
+        return malloc(size);
+
+    ThreadCache *cache = threadCache();
+    QVector<void *> &blocks = cache->blocks[size];
+
+    if (blocks.isEmpty()) {
+        takeSharedBlocks(&blocks, size, BatchSize);
+        cache->bytes += blocks.size() * size;
+
+        if (blocks.isEmpty())
+            return malloc(size);
+    }
+
+    void *block = blocks.last();
+    blocks.removeLast();
+    cache->bytes -= size;
+    return block;
+}
+
+void BlockRecycler::releaseBlock(void *block, size_t size)
+{
+    if (size > MaximumBlockSize) {
+        free(block);
+        return;
+    }
+
+    ThreadCache *cache = threadCache();
+    QVector<void *> &blocks = cache->blocks[size];
+    blocks.append(block);
+    cache->bytes += size;
+
+    if (cache->bytes > ThreadCacheSize) {
+        const int count = qMax(1, blocks.size() / 2);
+        cache->bytes -= count * size;
+        addSharedBlocks(&blocks, size, count);
+    }
+}
+
+BlockRecycler::ThreadCache *BlockRecycler::threadCache()
+{
+    if (! _threadCaches.hasLocalData())
+        _threadCaches.setLocalData(new ThreadCache(this));
+
+    return _threadCaches.localData();
+}
+
+// Moves up to count blocks of the given size from the shared list to blocks.
+void BlockRecycler::takeSharedBlocks(QVector<void *> *blocks, size_t size, int count)
+{
+    QMutexLocker locker(&_mutex);
+    QVector<void *> &shared = _sharedBlocks[size];
+
+    count = qMin(count, shared.size());
+    for (int i = 0; i < count; ++i) {
+        blocks->append(shared.last());
+        shared.removeLast();
+    }
+    _sharedBytes -= count * size;
+}
+
+// Moves the last count blocks to the shared list, or frees them if the
+// list is full.
+void BlockRecycler::addSharedBlocks(QVector<void *> *blocks, size_t size, int count)
+{
+    QMutexLocker locker(&_mutex);
+    QVector<void *> &shared = _sharedBlocks[size];
+
+    for (int i = 0; i < count; ++i) {
+        void *block = blocks->last();
+        blocks->removeLast();
+
+        if (_sharedBytes + size <= _maximumCachedBytes) {
+            shared.append(block);
+            _sharedBytes += size;
+        } else {
+            free(block);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#ifndef CPLUSPLUS_BLOCKRECYCLER_H
+#define CPLUSPLUS_BLOCKRECYCLER_H
+
+#include <CPlusPlusForwardDeclarations.h>
+#include <MemoryPool.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QVector>
+
+namespace CPlusPlus {
+
+/*
+    A BlockAllocator that keeps the blocks of the memory pools that go away
+    for the pools created next, instead of returning them to malloc().
+
+    Every thread has a small cache of blocks of its own, so that most blocks
+    are recycled without taking a lock; the caches overflow into a shared
+    list, which is bounded by maximumCachedBytes(). Only blocks up to
+    MaximumBlockSize bytes are recycled.
+*/
+class CPLUSPLUS_EXPORT BlockRecycler: public BlockAllocator
+{
+public:
+    enum {
+        MaximumBlockSize = 64 * 1024,
+        ThreadCacheSize = 1024 * 1024
+    };
+
+    BlockRecycler();
+    virtual ~BlockRecycler();
+
+    // The recycler of the process. It is never deleted, so that the
+    // threads can give their blocks back when they exit.
+    static BlockRecycler *instance();
+
+    size_t maximumCachedBytes() const;
+    void setMaximumCachedBytes(size_t maximumCachedBytes);
+
+    size_t cachedBytes() const;
+
+    virtual void *allocateBlock(size_t size);
+    virtual void releaseBlock(void *block, size_t size);
+
+private:
+    class ThreadCache;
+    typedef QHash<size_t, QVector<void *> > Blocks;
+
+    ThreadCache *threadCache();
+    void takeSharedBlocks(QVector<void *> *blocks, size_t size, int count);
+    void addSharedBlocks(QVector<void *> *blocks, size_t size, int count);
+
+private:
+    QThreadStorage<ThreadCache *> _threadCaches;
+
+    mutable QMutex _mutex;
+    Blocks _sharedBlocks;
+    size_t _sharedBytes;
+    size_t _maximumCachedBytes;
+};
+
+} // end of namespace CPlusPlus
+
+#endif // CPLUSPLUS_BLOCKRECYCLER_H
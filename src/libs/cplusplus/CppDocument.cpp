@@ -34,6 +34,7 @@
 #include "CppDocument.h"
 
 #include <Control.h>
+#include <MemoryPool.h>
 #include <TranslationUnit.h>
 #include <DiagnosticClient.h>
 #include <Semantic.h>
@@ -42,14 +43,22 @@
 #include <AST.h>
 #include <Scope.h>
 
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QtDebug>
 
 using namespace CPlusPlus;
 
+// The documents are shared by the threads computing completions.
+Q_GLOBAL_STATIC(QMutex, macroNamesMutex)
+
 namespace {
 
+QAtomicInt lastDocumentRevision;
+
 class DocumentDiagnosticClient : public DiagnosticClient
 {
     enum { MAX_MESSAGE_COUNT = 10 };
@@ -96,11 +105,18 @@ public:
 
 } // anonymous namespace
 
-Document::Document(const QString &fileName)
+Document::Document(const QString &fileName, SharedNameTable::Ptr nameTable)
     : _fileName(fileName),
-      _globalNamespace(0)
+      _revision(lastDocumentRevision.fetchAndAddRelaxed(1) + 1),
+      _editorRevision(0),
+      _nameTable(nameTable),
+      _globalNamespace(0),
+      _hasMacroNames(false),
+      _pragmaOnce(false),
+      _parsesFunctionBodyLines(false)
 {
     _control = new Control();
+    _control->setNameTable(_nameTable.data());
 
     _control->setDiagnosticClient(new DocumentDiagnosticClient(this, &_diagnosticMessages));
 
@@ -148,6 +164,16 @@ void Document::appendMacro(const Macro &macro)
     _definedMacros.append(macro);
 }
 
+QSet<QByteArray> Document::macroNames() const
+{
+    QMutexLocker locker(macroNamesMutex());
+    if (! _hasMacroNames) {
+        _macroNames = _macroTable.macroNames().toSet();
+        _hasMacroNames = true;
+    }
+    return _macroNames;
+}
+
 void Document::addMacroUse(const Macro &macro, unsigned offset, unsigned length)
 {
     _macroUses.append(MacroUse(macro, offset, offset + length));
@@ -158,6 +184,13 @@ TranslationUnit *Document::translationUnit() const
     return _translationUnit;
 }
 
+MemoryPoolStatistics Document::memoryPoolStatistics() const
+{
+    MemoryPoolStatistics stats = _control->memoryPoolStatistics();
+    stats.add(_translationUnit->memoryPoolStatistics());
+    return stats;
+}
+
 bool Document::skipFunctionBody() const
 {
     return _translationUnit->skipFunctionBody();
@@ -168,6 +201,32 @@ void Document::setSkipFunctionBody(bool skipFunctionBody)
     _translationUnit->setSkipFunctionBody(skipFunctionBody);
 }
 
+void Document::setParsedFunctionBodyLines(unsigned firstLine, unsigned lastLine)
+{
+    _translationUnit->setParsedFunctionBodyLines(firstLine, lastLine);
+    _parsesFunctionBodyLines = true;
+}
+
+bool Document::skipsAllFunctionBodies() const
+{
+    return skipFunctionBody() && ! _parsesFunctionBodyLines;
+}
+
+bool Document::isFunctionBodySkippedAt(unsigned line) const
+{
+    if (! skipFunctionBody())
+        return false;
+    else if (! _parsesFunctionBodyLines)
+        return true;
+
+    foreach (const Block &block, _skippedFunctionBodies) {
+        if (block.contains(line))
+            return true;
+    }
+
+    return false;
+}
+
 unsigned Document::globalSymbolCount() const
 {
     if (! _globalNamespace)
@@ -221,9 +280,9 @@ Symbol *Document::findSymbolAt(unsigned line, unsigned column, Scope *scope) con
     return previousSymbol;
 }
 
-Document::Ptr Document::create(const QString &fileName)
+Document::Ptr Document::create(const QString &fileName, SharedNameTable::Ptr nameTable)
 {
-    Document::Ptr doc(new Document(fileName));
+    Document::Ptr doc(new Document(fileName, nameTable));
     return doc;
 }
 
@@ -270,7 +329,17 @@ bool Document::parse(ParseMode mode)
         break;
     }
 
-    return _translationUnit->parse(m);
+    const bool parsed = _translationUnit->parse(m);
+
+    if (_parsesFunctionBodyLines) {
+        for (unsigned i = 0; i < _translationUnit->skippedFunctionBodyCount(); ++i) {
+            unsigned firstLine = 0, lastLine = 0;
+            _translationUnit->getSkippedFunctionBody(i, &firstLine, &lastLine);
+            _skippedFunctionBodies.append(Block(firstLine, lastLine + 1));
+        }
+    }
+
+    return parsed;
 }
 
 void Document::check()
@@ -295,3 +364,8 @@ void Document::releaseTranslationUnit()
 {
     _translationUnit->release();
 }
+
+void Document::recordIdentifierUses()
+{
+    _identifierUses = IdentifierUses::fromTranslationUnit(_translationUnit);
+}
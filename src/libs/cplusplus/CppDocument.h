@@ -37,10 +37,14 @@
 #include <CPlusPlusForwardDeclarations.h>
 
 #include "pp-macro.h"
+#include "pp-environment.h"
+#include "IdentifierUses.h"
+#include "SharedNameTable.h"
 
 #include <QByteArray>
 #include <QList>
 #include <QMap>
+#include <QSet>
 #include <QSharedPointer>
 #include <QString>
 #include <QStringList>
@@ -54,7 +58,7 @@ class CPLUSPLUS_EXPORT Document
     Document(const Document &other);
     void operator =(const Document &other);
 
-    Document(const QString &fileName);
+    Document(const QString &fileName, SharedNameTable::Ptr nameTable);
 
 public:
     typedef QSharedPointer<Document> Ptr;
@@ -64,6 +68,19 @@ public:
 
     QString fileName() const;
 
+    // A number that no other document created by this process has, so that
+    // the caches can tell the new version of a file from the previous one.
+    unsigned revision() const
+    { return _revision; }
+
+    // The revision of the editor contents the document was parsed from, or
+    // 0 if it wasn't parsed for an editor.
+    unsigned editorRevision() const
+    { return _editorRevision; }
+
+    void setEditorRevision(unsigned editorRevision)
+    { _editorRevision = editorRevision; }
+
     QStringList includedFiles() const;
     void addIncludeFile(const QString &fileName, unsigned line);
 
@@ -73,9 +90,24 @@ public:
     Control *control() const;
     TranslationUnit *translationUnit() const;
 
+    // The memory held by the pools of the control and of the translation
+    // unit; the latter is empty once the translation unit is released.
+    MemoryPoolStatistics memoryPoolStatistics() const;
+
     bool skipFunctionBody() const;
     void setSkipFunctionBody(bool skipFunctionBody);
 
+    // Parses the function bodies that overlap the lines [firstLine, lastLine]
+    // even if skipFunctionBody() is set.
+    void setParsedFunctionBodyLines(unsigned firstLine, unsigned lastLine);
+
+    // Returns true if all the function bodies were skipped.
+    bool skipsAllFunctionBodies() const;
+
+    // Returns true if line is in a function body that was skipped. If the
+    // position of the skipped bodies is not known, returns skipFunctionBody().
+    bool isFunctionBodySkippedAt(unsigned line) const;
+
     unsigned globalSymbolCount() const;
     Symbol *globalSymbolAt(unsigned index) const;
     Scope *globalSymbols() const; // ### deprecate?
@@ -84,6 +116,29 @@ public:
     QList<Macro> definedMacros() const
     { return _definedMacros; }
 
+    // The macros defined by this document and by the documents it includes.
+    MacroTable macroTable() const
+    { return _macroTable; }
+
+    void setMacroTable(const MacroTable &macroTable)
+    { _macroTable = macroTable; _hasMacroNames = false; }
+
+    // The names of the macros of the macro table that are not #undef'ed,
+    // collected the first time they are asked for.
+    QSet<QByteArray> macroNames() const;
+
+    QByteArray includeGuard() const
+    { return _includeGuard; }
+
+    void setIncludeGuard(const QByteArray &macroName)
+    { _includeGuard = macroName; }
+
+    bool hasPragmaOnce() const
+    { return _pragmaOnce; }
+
+    void setPragmaOnce(bool pragmaOnce)
+    { _pragmaOnce = pragmaOnce; }
+
     Symbol *findSymbolAt(unsigned line, unsigned column) const;
 
     void setSource(const QByteArray &source);
@@ -101,7 +156,22 @@ public:
     void check();
     void releaseTranslationUnit();
 
-    static Ptr create(const QString &fileName);
+    // Records the uses of the identifiers; must be called before the
+    // translation unit is released.
+    void recordIdentifierUses();
+
+    // The uses recorded by recordIdentifierUses(), empty if it wasn't called.
+    const IdentifierUses &identifierUses() const
+    { return _identifierUses; }
+
+    void setIdentifierUses(const IdentifierUses &identifierUses)
+    { _identifierUses = identifierUses; }
+
+    static Ptr create(const QString &fileName,
+                      SharedNameTable::Ptr nameTable = SharedNameTable::Ptr());
+
+    SharedNameTable::Ptr nameTable() const
+    { return _nameTable; }
 
     class DiagnosticMessage
     {
@@ -218,22 +288,40 @@ public:
     QList<Block> skippedBlocks() const
     { return _skippedBlocks; }
 
+    // The lines of the function bodies skipped by the parser; only known
+    // when setParsedFunctionBodyLines() was used.
+    QList<Block> skippedFunctionBodies() const
+    { return _skippedFunctionBodies; }
+
     QList<MacroUse> macroUses() const
     { return _macroUses; }
 
 private:
     Symbol *findSymbolAt(unsigned line, unsigned column, Scope *scope) const;
 
+    friend class DocumentCache;
+
 private:
     QString _fileName;
+    unsigned _revision;
+    unsigned _editorRevision;
+    SharedNameTable::Ptr _nameTable;
     Control *_control;
     TranslationUnit *_translationUnit;
     Namespace *_globalNamespace;
     QList<DiagnosticMessage> _diagnosticMessages;
     QList<Include> _includes;
     QList<Macro> _definedMacros;
+    MacroTable _macroTable;
+    mutable QSet<QByteArray> _macroNames;
+    mutable bool _hasMacroNames;
     QList<Block> _skippedBlocks;
+    QList<Block> _skippedFunctionBodies;
     QList<MacroUse> _macroUses;
+    IdentifierUses _identifierUses;
+    QByteArray _includeGuard;
+    bool _pragmaOnce;
+    bool _parsesFunctionBodyLines;
 };
 
 class CPLUSPLUS_EXPORT Snapshot: public QMap<QString, Document::Ptr>
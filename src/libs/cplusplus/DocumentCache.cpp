@@ -0,0 +1,1129 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+#include "DocumentCache.h"
+
+#include <Control.h>
+#include <TranslationUnit.h>
+#include <Literals.h>
+#include <Names.h>
+#include <CoreTypes.h>
+#include <Symbols.h>
+#include <Scope.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QVector>
+#include <QtCore/QtDebug>
+
+using namespace CPlusPlus;
+
+namespace {
+
+enum {
+    CacheMagic = 0x43505043, // "CPPC"
+    CacheVersion = 5
+};
+
+enum { DefaultMaximumSize = 256 * 1024 * 1024 };
+
+enum Tag {
+    NullTag,
+    ReferenceTag,
+
+    // names
+    NameIdTag,
+    TemplateNameIdTag,
+    DestructorNameIdTag,
+    OperatorNameIdTag,
+    ConversionNameIdTag,
+    QualifiedNameIdTag,
+
+    // types
+    VoidTypeTag,
+    IntegerTypeTag,
+    FloatTypeTag,
+    PointerToMemberTypeTag,
+    PointerTypeTag,
+    ReferenceTypeTag,
+    ArrayTypeTag,
+    NamedTypeTag,
+    SymbolTypeTag,
+
+    // symbols
+    DeclarationTag,
+    ArgumentTag,
+    FunctionTag,
+    NamespaceTag,
+    BaseClassTag,
+    ClassTag,
+    EnumTag,
+    BlockTag,
+    UsingNamespaceDirectiveTag,
+    UsingDeclarationTag
+};
+
+enum TypeFlag {
+    ConstFlag     = 1 << 0,
+    VolatileFlag  = 1 << 1,
+    SignedFlag    = 1 << 2,
+    UnsignedFlag  = 1 << 3,
+    FriendFlag    = 1 << 4,
+    RegisterFlag  = 1 << 5,
+    StaticFlag    = 1 << 6,
+    ExternFlag    = 1 << 7,
+    MutableFlag   = 1 << 8,
+    TypedefFlag   = 1 << 9,
+    InlineFlag    = 1 << 10,
+    VirtualFlag   = 1 << 11,
+    ExplicitFlag  = 1 << 12
+};
+
+enum FunctionFlag {
+    VariadicFunction    = 1 << 0,
+    PureVirtualFunction = 1 << 1,
+    ConstFunction       = 1 << 2,
+    VolatileFunction    = 1 << 3
+};
+
+class DocumentWriter
+{
+public:
+    DocumentWriter(QDataStream &out)
+        : out(out)
+    { }
+
+    void operator()(Document *doc)
+    {
+        out << quint32(doc->includes().size());
+        foreach (const Document::Include &include, doc->includes())
+            out << include.fileName() << quint32(include.line());
+
+        out << quint32(doc->definedMacros().size());
+        foreach (const Macro &macro, doc->definedMacros()) {
+            out << macro.name << macro.definition << macro.formals
+                << macro.fileName << qint32(macro.line) << quint32(macro.state);
+        }
+
+        out << quint32(doc->skippedBlocks().size());
+        foreach (const Document::Block &block, doc->skippedBlocks())
+            out << quint32(block.begin()) << quint32(block.end());
+
+        out << doc->includeGuard() << doc->hasPragmaOnce() << doc->skipFunctionBody();
+
+        out << quint32(doc->diagnosticMessages().size());
+        foreach (const Document::DiagnosticMessage &m, doc->diagnosticMessages()) {
+            out << qint32(m.level()) << m.fileName() << qint32(m.line())
+                << qint32(m.column()) << m.text();
+        }
+
+        TranslationUnit *unit = doc->translationUnit();
+
+        out << quint32(unit->lineOffsetCount());
+        for (unsigned i = 0; i < unit->lineOffsetCount(); ++i)
+            out << quint32(unit->lineOffsetAt(i));
+
+        out << quint32(unit->preprocessorLineCount());
+        for (unsigned i = 0; i < unit->preprocessorLineCount(); ++i) {
+            const TranslationUnit::PPLine &ppLine = unit->preprocessorLineAt(i);
+            out << quint32(ppLine.offset) << quint32(ppLine.line);
+            writeLiteral(ppLine.fileName);
+        }
+
+        writeSymbol(doc->globalNamespace());
+
+        const IdentifierUses &identifierUses = doc->identifierUses();
+        out << quint32(identifierUses.identifierCount());
+        for (unsigned i = 0; i < identifierUses.identifierCount(); ++i) {
+            writeIdentifier(identifierUses.identifierAt(i));
+            out << identifierUses.usesAt(i);
+        }
+    }
+
+private:
+    void writeLiteral(Literal *literal)
+    {
+        if (! literal) {
+            out << QByteArray();
+            return;
+        }
+
+        out << QByteArray::fromRawData(literal->chars(), literal->size());
+    }
+
+    void writeIdentifier(Identifier *id)
+    {
+        // identifiers are written once, and referenced by index afterwards.
+        QHash<Identifier *, quint32>::const_iterator it = _identifiers.find(id);
+        if (it != _identifiers.end()) {
+            out << it.value();
+            return;
+        }
+
+        const quint32 index = _identifiers.size();
+        _identifiers.insert(id, index);
+        out << index;
+        writeLiteral(id);
+    }
+
+    void writeName(Name *name)
+    {
+        if (! name) {
+            out << quint8(NullTag);
+            return;
+        }
+
+        QHash<Name *, quint32>::const_iterator it = _names.find(name);
+        if (it != _names.end()) {
+            out << quint8(ReferenceTag) << it.value();
+            return;
+        }
+
+        _names.insert(name, _names.size());
+
+        if (NameId *nameId = name->asNameId()) {
+            out << quint8(NameIdTag);
+            writeIdentifier(nameId->identifier());
+        } else if (TemplateNameId *templId = name->asTemplateNameId()) {
+            out << quint8(TemplateNameIdTag);
+            writeIdentifier(templId->identifier());
+            out << quint32(templId->templateArgumentCount());
+            for (unsigned i = 0; i < templId->templateArgumentCount(); ++i)
+                writeType(templId->templateArgumentAt(i));
+        } else if (DestructorNameId *dtorId = name->asDestructorNameId()) {
+            out << quint8(DestructorNameIdTag);
+            writeIdentifier(dtorId->identifier());
+        } else if (OperatorNameId *opId = name->asOperatorNameId()) {
+            out << quint8(OperatorNameIdTag) << qint32(opId->kind());
+        } else if (ConversionNameId *convId = name->asConversionNameId()) {
+            out << quint8(ConversionNameIdTag);
+            writeType(convId->type());
+        } else if (QualifiedNameId *q = name->asQualifiedNameId()) {
+            out << quint8(QualifiedNameIdTag) << q->isGlobal() << quint32(q->nameCount());
+            for (unsigned i = 0; i < q->nameCount(); ++i)
+                writeName(q->nameAt(i));
+        } else {
+            Q_ASSERT(false);
+            out << quint8(NullTag);
+        }
+    }
+
+    void writeType(const FullySpecifiedType &fullySpecifiedType)
+    {
+        quint32 flags = 0;
+        if (fullySpecifiedType.isConst())    flags |= ConstFlag;
+        if (fullySpecifiedType.isVolatile()) flags |= VolatileFlag;
+        if (fullySpecifiedType.isSigned())   flags |= SignedFlag;
+        if (fullySpecifiedType.isUnsigned()) flags |= UnsignedFlag;
+        if (fullySpecifiedType.isFriend())   flags |= FriendFlag;
+        if (fullySpecifiedType.isRegister()) flags |= RegisterFlag;
+        if (fullySpecifiedType.isStatic())   flags |= StaticFlag;
+        if (fullySpecifiedType.isExtern())   flags |= ExternFlag;
+        if (fullySpecifiedType.isMutable())  flags |= MutableFlag;
+        if (fullySpecifiedType.isTypedef())  flags |= TypedefFlag;
+        if (fullySpecifiedType.isInline())   flags |= InlineFlag;
+        if (fullySpecifiedType.isVirtual())  flags |= VirtualFlag;
+        if (fullySpecifiedType.isExplicit()) flags |= ExplicitFlag;
+        out << flags;
+
+        Type *ty = fullySpecifiedType.type();
+
+        if (! ty) {
+            out << quint8(NullTag);
+        } else if (ty->isVoidType()) {
+            out << quint8(VoidTypeTag);
+        } else if (IntegerType *intTy = ty->asIntegerType()) {
+            out << quint8(IntegerTypeTag) << qint32(intTy->kind());
+        } else if (FloatType *floatTy = ty->asFloatType()) {
+            out << quint8(FloatTypeTag) << qint32(floatTy->kind());
+        } else if (PointerToMemberType *ptrToMemberTy = ty->asPointerToMemberType()) {
+            out << quint8(PointerToMemberTypeTag);
+            writeName(ptrToMemberTy->memberName());
+            writeType(ptrToMemberTy->elementType());
+        } else if (PointerType *ptrTy = ty->asPointerType()) {
+            out << quint8(PointerTypeTag);
+            writeType(ptrTy->elementType());
+        } else if (ReferenceType *refTy = ty->asReferenceType()) {
+            out << quint8(ReferenceTypeTag);
+            writeType(refTy->elementType());
+        } else if (ArrayType *arrayTy = ty->asArrayType()) {
+            out << quint8(ArrayTypeTag) << quint64(arrayTy->size());
+            writeType(arrayTy->elementType());
+        } else if (NamedType *namedTy = ty->asNamedType()) {
+            out << quint8(NamedTypeTag);
+            writeName(namedTy->name());
+        } else if (Function *fun = ty->asFunction()) {
+            out << quint8(SymbolTypeTag);
+            writeSymbol(fun);
+        } else if (Class *klass = ty->asClass()) {
+            out << quint8(SymbolTypeTag);
+            writeSymbol(klass);
+        } else if (Enum *e = ty->asEnum()) {
+            out << quint8(SymbolTypeTag);
+            writeSymbol(e);
+        } else if (Namespace *ns = ty->asNamespace()) {
+            out << quint8(SymbolTypeTag);
+            writeSymbol(ns);
+        } else {
+            Q_ASSERT(false);
+            out << quint8(NullTag);
+        }
+    }
+
+    void writeScope(Scope *scope)
+    {
+        if (! scope) {
+            out << quint32(0);
+            return;
+        }
+
+        out << quint32(scope->symbolCount());
+        for (unsigned i = 0; i < scope->symbolCount(); ++i)
+            writeSymbol(scope->symbolAt(i));
+    }
+
+    void writeTemplateParameters(Scope *templateParameters)
+    {
+        out << bool(templateParameters != 0);
+        if (templateParameters)
+            writeScope(templateParameters);
+    }
+
+    void writeSymbol(Symbol *symbol)
+    {
+        if (! symbol) {
+            out << quint8(NullTag);
+            return;
+        }
+
+        // symbols can be reached through their scope and through the types
+        // referring to them, only the first occurrence is written out.
+        QHash<Symbol *, quint32>::const_iterator it = _symbols.find(symbol);
+        if (it != _symbols.end()) {
+            out << quint8(ReferenceTag) << it.value();
+            return;
+        }
+
+        _symbols.insert(symbol, _symbols.size());
+
+        if (Declaration *decl = symbol->asDeclaration()) {
+            writeSymbolHeader(DeclarationTag, decl);
+            writeType(decl->type());
+            writeTemplateParameters(decl->templateParameters());
+        } else if (Argument *arg = symbol->asArgument()) {
+            writeSymbolHeader(ArgumentTag, arg);
+            writeType(arg->type());
+            out << arg->hasInitializer();
+        } else if (Function *fun = symbol->asFunction()) {
+            writeSymbolHeader(FunctionTag, fun);
+            writeType(fun->returnType());
+            quint32 flags = 0;
+            if (fun->isVariadic())    flags |= VariadicFunction;
+            if (fun->isPureVirtual()) flags |= PureVirtualFunction;
+            if (fun->isConst())       flags |= ConstFunction;
+            if (fun->isVolatile())    flags |= VolatileFunction;
+            out << flags << qint32(fun->methodKey());
+            writeTemplateParameters(fun->templateParameters());
+            writeScope(fun->arguments());
+            writeScope(fun->members());
+        } else if (Namespace *ns = symbol->asNamespace()) {
+            writeSymbolHeader(NamespaceTag, ns);
+            writeScope(ns->members());
+        } else if (BaseClass *baseClass = symbol->asBaseClass()) {
+            writeSymbolHeader(BaseClassTag, baseClass);
+            out << baseClass->isVirtual();
+        } else if (Class *klass = symbol->asClass()) {
+            writeSymbolHeader(ClassTag, klass);
+            out << qint32(klass->classKey());
+            writeTemplateParameters(klass->templateParameters());
+            out << quint32(klass->baseClassCount());
+            for (unsigned i = 0; i < klass->baseClassCount(); ++i)
+                writeSymbol(klass->baseClassAt(i));
+            writeScope(klass->members());
+        } else if (Enum *e = symbol->asEnum()) {
+            writeSymbolHeader(EnumTag, e);
+            writeScope(e->members());
+        } else if (Block *block = symbol->asBlock()) {
+            writeSymbolHeader(BlockTag, block);
+            writeScope(block->members());
+        } else if (UsingNamespaceDirective *u = symbol->asUsingNamespaceDirective()) {
+            writeSymbolHeader(UsingNamespaceDirectiveTag, u);
+        } else if (UsingDeclaration *u = symbol->asUsingDeclaration()) {
+            writeSymbolHeader(UsingDeclarationTag, u);
+        } else {
+            Q_ASSERT(false);
+            out << quint8(NullTag);
+        }
+    }
+
+    void writeSymbolHeader(Tag tag, Symbol *symbol)
+    {
+        out << quint8(tag);
+        writeName(symbol->name());
+        out << quint32(symbol->sourceOffset())
+            << qint32(symbol->storage())
+            << qint32(symbol->visibility());
+    }
+
+private:
+    QDataStream &out;
+    QHash<Identifier *, quint32> _identifiers;
+    QHash<Name *, quint32> _names;
+    QHash<Symbol *, quint32> _symbols;
+};
+
+class DocumentReader
+{
+public:
+    DocumentReader(QDataStream &in, Document *doc)
+        : in(in),
+          doc(doc),
+          control(doc->control()),
+          _failed(false)
+    { }
+
+    Namespace *operator()()
+    {
+        quint32 count = 0;
+
+        in >> count;
+        for (quint32 i = 0; isValid() && i < count; ++i) {
+            QString fileName;
+            quint32 line = 0;
+            in >> fileName >> line;
+            doc->addIncludeFile(fileName, line);
+        }
+
+        in >> count;
+        for (quint32 i = 0; isValid() && i < count; ++i) {
+            Macro macro;
+            qint32 line = 0;
+            quint32 state = 0;
+            in >> macro.name >> macro.definition >> macro.formals
+               >> macro.fileName >> line >> state;
+            macro.line = line;
+            macro.state = state;
+            doc->appendMacro(macro);
+        }
+
+        in >> count;
+        for (quint32 i = 0; isValid() && i < count; ++i) {
+            quint32 begin = 0;
+            quint32 end = 0;
+            in >> begin >> end;
+            doc->startSkippingBlocks(begin);
+            if (end)
+                doc->stopSkippingBlocks(end);
+        }
+
+        QByteArray includeGuard;
+        bool pragmaOnce = false;
+        bool skipFunctionBody = false;
+        in >> includeGuard >> pragmaOnce >> skipFunctionBody;
+        doc->setIncludeGuard(includeGuard);
+        doc->setPragmaOnce(pragmaOnce);
+        doc->setSkipFunctionBody(skipFunctionBody);
+
+        in >> count;
+        for (quint32 i = 0; isValid() && i < count; ++i) {
+            qint32 level = 0;
+            QString fileName;
+            qint32 line = 0;
+            qint32 column = 0;
+            QString text;
+            in >> level >> fileName >> line >> column >> text;
+            doc->addDiagnosticMessage(Document::DiagnosticMessage(level, fileName,
+                                                                  line, column, text));
+        }
+
+        TranslationUnit *unit = doc->translationUnit();
+
+        in >> count;
+        for (quint32 i = 0; isValid() && i < count; ++i) {
+            quint32 offset = 0;
+            in >> offset;
+            unit->pushLineOffset(offset);
+        }
+
+        in >> count;
+        for (quint32 i = 0; isValid() && i < count; ++i) {
+            quint32 offset = 0;
+            quint32 line = 0;
+            in >> offset >> line;
+            const QByteArray fileName = readLiteral();
+            unit->pushPreprocessorLine(offset, line,
+                                       control->findOrInsertFileName(fileName.constData(),
+                                                                     fileName.size()));
+        }
+
+        Symbol *symbol = readSymbol(/*owner = */ 0);
+        if (! isValid() || ! symbol || ! symbol->asNamespace())
+            return 0;
+
+        QVector<IdentifierUses::Use> uses;
+        in >> count;
+        for (quint32 i = 0; isValid() && i < count; ++i) {
+            Identifier *id = readIdentifier();
+            QVector<unsigned> offsets;
+            in >> offsets;
+            foreach (unsigned offset, offsets)
+                uses.append(IdentifierUses::Use(id, offset));
+        }
+
+        if (! isValid())
+            return 0;
+
+        IdentifierUses identifierUses;
+        identifierUses.setUses(uses);
+        doc->setIdentifierUses(identifierUses);
+
+        return symbol->asNamespace();
+    }
+
+private:
+    bool isValid() const
+    { return ! _failed && in.status() == QDataStream::Ok; }
+
+    void fail()
+    { _failed = true; }
+
+    QByteArray readLiteral()
+    {
+        QByteArray chars;
+        in >> chars;
+        return chars;
+    }
+
+    Identifier *readIdentifier()
+    {
+        quint32 index = 0;
+        in >> index;
+
+        if (index < quint32(_identifiers.size()))
+            return _identifiers.at(index);
+        else if (index != quint32(_identifiers.size())) {
+            fail();
+            return 0;
+        }
+
+        const QByteArray chars = readLiteral();
+        Identifier *id = control->findOrInsertIdentifier(chars.constData(), chars.size());
+        _identifiers.append(id);
+        return id;
+    }
+
+    Name *readName()
+    {
+        quint8 tag = NullTag;
+        in >> tag;
+
+        if (tag == NullTag || ! isValid())
+            return 0;
+
+        if (tag == ReferenceTag) {
+            quint32 index = 0;
+            in >> index;
+            if (index >= quint32(_names.size())) {
+                fail();
+                return 0;
+            }
+            return _names.at(index);
+        }
+
+        const int index = _names.size();
+        _names.append(0);
+
+        Name *name = 0;
+
+        switch (tag) {
+        case NameIdTag:
+            name = control->nameId(readIdentifier());
+            break;
+
+        case TemplateNameIdTag: {
+            Identifier *id = readIdentifier();
+            quint32 argc = 0;
+            in >> argc;
+            QVector<FullySpecifiedType> args;
+            for (quint32 i = 0; isValid() && i < argc; ++i)
+                args.append(readType());
+            name = control->templateNameId(id, args.data(), args.size());
+        } break;
+
+        case DestructorNameIdTag:
+            name = control->destructorNameId(readIdentifier());
+            break;
+
+        case OperatorNameIdTag: {
+            qint32 kind = 0;
+            in >> kind;
+            name = control->operatorNameId(kind);
+        } break;
+
+        case ConversionNameIdTag:
+            name = control->conversionNameId(readType());
+            break;
+
+        case QualifiedNameIdTag: {
+            bool isGlobal = false;
+            quint32 nameCount = 0;
+            in >> isGlobal >> nameCount;
+            QVector<Name *> names;
+            for (quint32 i = 0; isValid() && i < nameCount; ++i)
+                names.append(readName());
+            name = control->qualifiedNameId(names.data(), names.size(), isGlobal);
+        } break;
+
+        default:
+            fail();
+            break;
+        } // switch
+
+        _names[index] = name;
+        return name;
+    }
+
+    FullySpecifiedType readType()
+    {
+        quint32 flags = 0;
+        quint8 tag = NullTag;
+        in >> flags >> tag;
+
+        FullySpecifiedType ty;
+
+        switch (tag) {
+        case NullTag:
+            break;
+
+        case VoidTypeTag:
+            ty.setType(control->voidType());
+            break;
+
+        case IntegerTypeTag: {
+            qint32 kind = 0;
+            in >> kind;
+            ty.setType(control->integerType(kind));
+        } break;
+
+        case FloatTypeTag: {
+            qint32 kind = 0;
+            in >> kind;
+            ty.setType(control->floatType(kind));
+        } break;
+
+        case PointerToMemberTypeTag: {
+            Name *memberName = readName();
+            ty.setType(control->pointerToMemberType(memberName, readType()));
+        } break;
+
+        case PointerTypeTag:
+            ty.setType(control->pointerType(readType()));
+            break;
+
+        case ReferenceTypeTag:
+            ty.setType(control->referenceType(readType()));
+            break;
+
+        case ArrayTypeTag: {
+            quint64 size = 0;
+            in >> size;
+            ty.setType(control->arrayType(readType(), size));
+        } break;
+
+        case NamedTypeTag:
+            ty.setType(control->namedType(readName()));
+            break;
+
+        case SymbolTypeTag:
+            if (Symbol *symbol = readSymbol(/*owner = */ 0)) {
+                if (Function *fun = symbol->asFunction())
+                    ty.setType(fun);
+                else if (Class *klass = symbol->asClass())
+                    ty.setType(klass);
+                else if (Enum *e = symbol->asEnum())
+                    ty.setType(e);
+                else if (Namespace *ns = symbol->asNamespace())
+                    ty.setType(ns);
+                else
+                    fail();
+            }
+            break;
+
+        default:
+            fail();
+            break;
+        } // switch
+
+        ty.setConst(flags & ConstFlag);
+        ty.setVolatile(flags & VolatileFlag);
+        ty.setSigned(flags & SignedFlag);
+        ty.setUnsigned(flags & UnsignedFlag);
+        ty.setFriend(flags & FriendFlag);
+        ty.setRegister(flags & RegisterFlag);
+        ty.setStatic(flags & StaticFlag);
+        ty.setExtern(flags & ExternFlag);
+        ty.setMutable(flags & MutableFlag);
+        ty.setTypedef(flags & TypedefFlag);
+        ty.setInline(flags & InlineFlag);
+        ty.setVirtual(flags & VirtualFlag);
+        ty.setExplicit(flags & ExplicitFlag);
+        return ty;
+    }
+
+    void readScope(Scope *scope)
+    {
+        quint32 count = 0;
+        in >> count;
+        for (quint32 i = 0; isValid() && i < count; ++i) {
+            if (Symbol *symbol = readSymbol(scope->owner()))
+                scope->enterSymbol(symbol);
+        }
+    }
+
+    Scope *readTemplateParameters(ScopedSymbol *owner)
+    {
+        bool hasTemplateParameters = false;
+        in >> hasTemplateParameters;
+        if (! hasTemplateParameters || ! isValid())
+            return 0;
+
+        Scope *templateParameters = new Scope(owner);
+        readScope(templateParameters);
+        return templateParameters;
+    }
+
+    // `owner' is the owner of the scope the symbol is read for, it is
+    // the owner of the template parameters declared by the symbol.
+    Symbol *readSymbol(ScopedSymbol *owner)
+    {
+        quint8 tag = NullTag;
+        in >> tag;
+
+        if (tag == NullTag || ! isValid())
+            return 0;
+
+        if (tag == ReferenceTag) {
+            quint32 index = 0;
+            in >> index;
+            if (index >= quint32(_symbols.size()) || ! _symbols.at(index)) {
+                fail();
+                return 0;
+            }
+            return _symbols.at(index);
+        }
+
+        const int index = _symbols.size();
+        _symbols.append(0);
+
+        Name *name = readName();
+        quint32 sourceOffset = 0;
+        qint32 storage = 0;
+        qint32 visibility = 0;
+        in >> sourceOffset >> storage >> visibility;
+
+        if (! isValid())
+            return 0;
+
+        Symbol *symbol = 0;
+
+        switch (tag) {
+        case DeclarationTag: {
+            Declaration *decl = control->newDeclaration(/*sourceLocation = */ 0, name);
+            _symbols[index] = symbol = decl;
+            decl->setType(readType());
+            decl->setTemplateParameters(readTemplateParameters(owner));
+        } break;
+
+        case ArgumentTag: {
+            Argument *arg = control->newArgument(/*sourceLocation = */ 0, name);
+            _symbols[index] = symbol = arg;
+            arg->setType(readType());
+            bool hasInitializer = false;
+            in >> hasInitializer;
+            arg->setInitializer(hasInitializer);
+        } break;
+
+        case FunctionTag: {
+            Function *fun = control->newFunction(/*sourceLocation = */ 0, name);
+            _symbols[index] = symbol = fun;
+            fun->setReturnType(readType());
+            quint32 flags = 0;
+            qint32 methodKey = 0;
+            in >> flags >> methodKey;
+            fun->setVariadic(flags & VariadicFunction);
+            fun->setPureVirtual(flags & PureVirtualFunction);
+            fun->setConst(flags & ConstFunction);
+            fun->setVolatile(flags & VolatileFunction);
+            fun->setMethodKey(methodKey);
+            fun->setTemplateParameters(readTemplateParameters(owner));
+            readScope(fun->arguments());
+            readScope(fun->members());
+        } break;
+
+        case NamespaceTag: {
+            Namespace *ns = control->newNamespace(/*sourceLocation = */ 0, name);
+            _symbols[index] = symbol = ns;
+            readScope(ns->members());
+        } break;
+
+        case BaseClassTag: {
+            BaseClass *baseClass = control->newBaseClass(/*sourceLocation = */ 0, name);
+            _symbols[index] = symbol = baseClass;
+            bool isVirtual = false;
+            in >> isVirtual;
+            baseClass->setVirtual(isVirtual);
+        } break;
+
+        case ClassTag: {
+            Class *klass = control->newClass(/*sourceLocation = */ 0, name);
+            _symbols[index] = symbol = klass;
+            qint32 classKey = 0;
+            in >> classKey;
+            klass->setClassKey(Class::Key(classKey));
+            klass->setTemplateParameters(readTemplateParameters(owner));
+            quint32 baseClassCount = 0;
+            in >> baseClassCount;
+            for (quint32 i = 0; isValid() && i < baseClassCount; ++i) {
+                Symbol *baseClass = readSymbol(owner);
+                if (baseClass && baseClass->asBaseClass())
+                    klass->addBaseClass(baseClass->asBaseClass());
+                else
+                    fail();
+            }
+            readScope(klass->members());
+        } break;
+
+        case EnumTag: {
+            Enum *e = control->newEnum(/*sourceLocation = */ 0, name);
+            _symbols[index] = symbol = e;
+            readScope(e->members());
+        } break;
+
+        case BlockTag: {
+            Block *block = control->newBlock(/*sourceLocation = */ 0);
+            _symbols[index] = symbol = block;
+            readScope(block->members());
+        } break;
+
+        case UsingNamespaceDirectiveTag:
+            _symbols[index] = symbol = control->newUsingNamespaceDirective(/*sourceLocation = */ 0, name);
+            break;
+
+        case UsingDeclarationTag:
+            _symbols[index] = symbol = control->newUsingDeclaration(/*sourceLocation = */ 0, name);
+            break;
+
+        default:
+            fail();
+            return 0;
+        } // switch
+
+        symbol->setSourceOffset(sourceOffset);
+        symbol->setStorage(storage);
+        symbol->setVisibility(visibility);
+        return symbol;
+    }
+
+private:
+    QDataStream &in;
+    Document *doc;
+    Control *control;
+    QVector<Identifier *> _identifiers;
+    QVector<Name *> _names;
+    QVector<Symbol *> _symbols;
+    bool _failed;
+};
+
+} // anonymous namespace
+
+DocumentCache::DocumentCache(const QString &path)
+    : _path(path),
+      _maximumSize(DefaultMaximumSize),
+      _size(-1)
+{
+    QDir().mkpath(_path);
+}
+
+DocumentCache::~DocumentCache()
+{ }
+
+QString DocumentCache::path() const
+{ return _path; }
+
+QByteArray DocumentCache::configuration() const
+{
+    QMutexLocker locker(&_mutex);
+    return _configuration;
+}
+
+void DocumentCache::setConfiguration(const QByteArray &defines,
+                                     const QStringList &includePaths,
+                                     const QStringList &frameworkPaths)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(defines);
+    foreach (const QString &includePath, includePaths) {
+        hash.addData("\0I", 2);
+        hash.addData(includePath.toUtf8());
+    }
+    foreach (const QString &frameworkPath, frameworkPaths) {
+        hash.addData("\0F", 2);
+        hash.addData(frameworkPath.toUtf8());
+    }
+
+    QMutexLocker locker(&_mutex);
+    _configuration = hash.result();
+}
+
+qint64 DocumentCache::maximumSize() const
+{
+    QMutexLocker locker(&_mutex);
+    return _maximumSize;
+}
+
+void DocumentCache::setMaximumSize(qint64 maximumSize)
+{
+    QMutexLocker locker(&_mutex);
+    _maximumSize = maximumSize;
+    if (_size > _maximumSize)
+        trim();
+}
+
+QString DocumentCache::cacheFileName(const QString &fileName) const
+{
+    const QByteArray key = QCryptographicHash::hash(fileName.toUtf8(),
+                                                    QCryptographicHash::Md5);
+    QString cacheFile = _path;
+    cacheFile += QLatin1Char('/');
+    cacheFile += QString::fromLatin1(key.toHex());
+    cacheFile += QLatin1String(".document");
+    return cacheFile;
+}
+
+// Returns a hash of the modification times and sizes of the given files,
+// a missing file counts too.
+QByteArray DocumentCache::fileStamps(const QStringList &fileNames)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    foreach (const QString &fileName, fileNames) {
+        const QFileInfo fileInfo(fileName);
+        qint64 stamp[2] = { -1, -1 };
+        if (fileInfo.isFile()) {
+            stamp[0] = fileInfo.lastModified().toTime_t();
+            stamp[1] = fileInfo.size();
+        }
+        hash.addData(fileName.toUtf8());
+        hash.addData(reinterpret_cast<const char *>(stamp), sizeof(stamp));
+    }
+    return hash.result();
+}
+
+Document::Ptr DocumentCache::load(const QString &fileName, SharedNameTable::Ptr nameTable,
+                                  QStringList *dependencies)
+{
+    const QFileInfo fileInfo(fileName);
+    if (! fileInfo.isFile())
+        return Document::Ptr();
+
+    QFile file(cacheFileName(fileName));
+    if (! file.open(QFile::ReadOnly))
+        return Document::Ptr();
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != CacheMagic || version != CacheVersion)
+        return Document::Ptr();
+
+    QString storedFileName;
+    qint64 lastModified = 0;
+    qint64 size = 0;
+    QByteArray configuration;
+    QStringList storedDependencies;
+    QByteArray dependencyStamps;
+    in >> storedFileName >> lastModified >> size >> configuration
+       >> storedDependencies >> dependencyStamps;
+
+    if (in.status() != QDataStream::Ok
+            || storedFileName != fileName
+            || lastModified != qint64(fileInfo.lastModified().toTime_t())
+            || size != fileInfo.size()
+            || configuration != this->configuration()
+            || dependencyStamps != fileStamps(storedDependencies)) {
+        return Document::Ptr();
+    }
+
+    QByteArray payload;
+    QByteArray checksum;
+    in >> payload >> checksum;
+    file.close();
+
+    if (in.status() != QDataStream::Ok
+            || QCryptographicHash::hash(payload, QCryptographicHash::Md5) != checksum) {
+        qWarning() << "DocumentCache: removing corrupted entry for" << fileName;
+        file.remove();
+        return Document::Ptr();
+    }
+
+    Document::Ptr doc = Document::create(fileName, nameTable);
+
+    QDataStream payloadStream(payload);
+    payloadStream.setVersion(QDataStream::Qt_4_0);
+    DocumentReader read(payloadStream, doc.data());
+    Namespace *globalNamespace = read();
+    if (! globalNamespace) {
+        qWarning() << "DocumentCache: removing unreadable entry for" << fileName;
+        file.remove();
+        return Document::Ptr();
+    }
+
+    doc->_globalNamespace = globalNamespace;
+    doc->releaseTranslationUnit();
+
+    if (dependencies)
+        *dependencies = storedDependencies;
+
+    return doc;
+}
+
+bool DocumentCache::store(Document::Ptr doc, const QStringList &dependencies)
+{
+    if (! doc || ! doc->globalNamespace())
+        return false;
+
+    const QFileInfo fileInfo(doc->fileName());
+    if (! fileInfo.isFile())
+        return false;
+
+    QByteArray payload;
+    QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+    payloadStream.setVersion(QDataStream::Qt_4_0);
+    DocumentWriter write(payloadStream);
+    write(doc.data());
+
+    const QString cacheFile = cacheFileName(doc->fileName());
+    QFile file(cacheFile + QLatin1String(".new"));
+    if (! file.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_0);
+    out << quint32(CacheMagic) << quint32(CacheVersion)
+        << doc->fileName()
+        << qint64(fileInfo.lastModified().toTime_t())
+        << qint64(fileInfo.size())
+        << configuration()
+        << dependencies
+        << fileStamps(dependencies)
+        << payload
+        << QCryptographicHash::hash(payload, QCryptographicHash::Md5);
+
+    const qint64 size = file.size();
+    file.close();
+
+    if (out.status() != QDataStream::Ok || size > maximumSize()) {
+        file.remove();
+        return false;
+    }
+
+    const qint64 previousSize = QFileInfo(cacheFile).size();
+    QFile::remove(cacheFile);
+    if (! file.rename(cacheFile)) {
+        file.remove();
+        return false;
+    }
+
+    QMutexLocker locker(&_mutex);
+    if (_size == -1)
+        _size = computeSize();
+    else
+        _size += size - previousSize;
+
+    if (_size > _maximumSize)
+        trim();
+
+    return true;
+}
+
+void DocumentCache::clear()
+{
+    QMutexLocker locker(&_mutex);
+
+    QDir dir(_path);
+    foreach (const QString &entry, dir.entryList(QStringList() << QLatin1String("*.document"),
+                                                 QDir::Files)) {
+        dir.remove(entry);
+    }
+
+    _size = 0;
+}
+
+qint64 DocumentCache::computeSize() const
+{
+    qint64 size = 0;
+
+    QDir dir(_path);
+    foreach (const QFileInfo &entry, dir.entryInfoList(QStringList() << QLatin1String("*.document"),
+                                                       QDir::Files)) {
+        size += entry.size();
+    }
+
+    return size;
+}
+
+// Removes the least recently written entries, until the cache is well below
+// its maximum size again. The caller must hold the mutex.
+void DocumentCache::trim()
+{
+    const qint64 targetSize = _maximumSize / 4 * 3;
+
+    QDir dir(_path);
+    const QFileInfoList entries = dir.entryInfoList(QStringList() << QLatin1String("*.document"),
+                                                    QDir::Files, QDir::Time);
+
+    // the entries are sorted by time, the most recent ones first.
+    for (int i = entries.size() - 1; i >= 0 && _size > targetSize; --i) {
+        const QFileInfo &entry = entries.at(i);
+        if (dir.remove(entry.fileName()))
+            _size -= entry.size();
+    }
+}
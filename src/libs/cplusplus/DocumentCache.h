@@ -0,0 +1,98 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+#ifndef CPLUSPLUS_DOCUMENTCACHE_H
+#define CPLUSPLUS_DOCUMENTCACHE_H
+
+#include <cplusplus/CppDocument.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+namespace CPlusPlus {
+
+/*
+    Stores checked documents on disk, so that the next session can load
+    their symbols, macros and diagnostics instead of preprocessing, parsing
+    and checking the file again.
+
+    A stored document is only used if the file and all the files it
+    includes, directly or not, still have the same modification time and
+    size, and if it was preprocessed with the same configuration (defines,
+    include and framework paths).
+*/
+class CPLUSPLUS_EXPORT DocumentCache
+{
+    DocumentCache(const DocumentCache &other);
+    void operator =(const DocumentCache &other);
+
+public:
+    DocumentCache(const QString &path);
+    ~DocumentCache();
+
+    QString path() const;
+
+    QByteArray configuration() const;
+    void setConfiguration(const QByteArray &defines,
+                          const QStringList &includePaths,
+                          const QStringList &frameworkPaths);
+
+    qint64 maximumSize() const;
+    void setMaximumSize(qint64 maximumSize);
+
+    Document::Ptr load(const QString &fileName,
+                       SharedNameTable::Ptr nameTable = SharedNameTable::Ptr(),
+                       QStringList *dependencies = 0);
+    bool store(Document::Ptr doc, const QStringList &dependencies = QStringList());
+
+    void clear();
+
+private:
+    QString cacheFileName(const QString &fileName) const;
+    static QByteArray fileStamps(const QStringList &fileNames);
+    qint64 computeSize() const;
+    void trim();
+
+private:
+    QString _path;
+    QByteArray _configuration;
+    qint64 _maximumSize;
+    qint64 _size;
+    mutable QMutex _mutex;
+};
+
+} // end of namespace CPlusPlus
+
+#endif // CPLUSPLUS_DOCUMENTCACHE_H
@@ -224,9 +224,14 @@ QString ExpressionUnderCursor::operator()(const QTextCursor &cursor)
         text += QLatin1Char('\n');
     }
 
+    return operator()(text, previousBlockState(initialBlock));
+}
+
+QString ExpressionUnderCursor::operator()(const QString &text, int state)
+{
     SimpleLexer tokenize;
     tokenize.setSkipComments(true);
-    QList<SimpleToken> tokens = tokenize(text, previousBlockState(initialBlock));
+    QList<SimpleToken> tokens = tokenize(text, state);
     tokens.prepend(SimpleToken()); // sentinel
 
     _jumpedComma = false;
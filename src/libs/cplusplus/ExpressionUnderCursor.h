@@ -55,6 +55,10 @@ public:
 
     QString operator()(const QTextCursor &cursor);
 
+    // Returns the expression that ends at the end of text; state is the
+    // state of the lexer at its start.
+    QString operator()(const QString &text, int state = 0);
+
 private:
     int startOfMatchingBrace(const QList<SimpleToken> &tk, int index);
     int startOfExpression(const QList<SimpleToken> &tk, int index);
@@ -0,0 +1,310 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#include "FindUsages.h"
+#include "ExpressionUnderCursor.h"
+#include "TypeOfExpression.h"
+
+#include <Literals.h>
+#include <Names.h>
+#include <Symbols.h>
+#include <TranslationUnit.h>
+
+#include <QtCore/QFile>
+#include <QtCore/QPair>
+
+using namespace CPlusPlus;
+
+namespace {
+
+Identifier *identifierOf(Name *name)
+{
+    if (! name)
+        return 0;
+    else if (QualifiedNameId *q = name->asQualifiedNameId())
+        name = q->unqualifiedNameId();
+
+    if (NameId *nameId = name->asNameId())
+        return nameId->identifier();
+    else if (TemplateNameId *templId = name->asTemplateNameId())
+        return templId->identifier();
+    else if (DestructorNameId *dtorId = name->asDestructorNameId())
+        return dtorId->identifier();
+
+    return 0; // ### operators and conversion functions
+}
+
+bool isIdentifierChar(const QChar &ch)
+{ return ch.isLetterOrNumber() || ch == QLatin1Char('_'); }
+
+// Returns the position of the occurrence of word in lineText that is the
+// closest to column, or -1.
+int findWord(const QString &lineText, const QString &word, int column)
+{
+    int best = -1;
+    int from = 0;
+
+    while ((from = lineText.indexOf(word, from)) != -1) {
+        const int end = from + word.length();
+
+        if ((from == 0 || ! isIdentifierChar(lineText.at(from - 1)))
+                && (end == lineText.length() || ! isIdentifierChar(lineText.at(end)))) {
+            if (best == -1 || qAbs(from - column) < qAbs(best - column))
+                best = from;
+        }
+
+        from = end;
+    }
+
+    return best;
+}
+
+bool isSameSymbol(Symbol *symbol, Symbol *other)
+{
+    if (symbol == other)
+        return true;
+
+    // The same declaration in another version of the document.
+    if (symbol->sourceOffset() != other->sourceOffset())
+        return false;
+    else if (symbol->fileNameLength() != other->fileNameLength()
+             || qstrncmp(symbol->fileName(), other->fileName(), symbol->fileNameLength()))
+        return false;
+
+    Identifier *id = identifierOf(symbol->name());
+    Identifier *otherId = identifierOf(other->name());
+    return id && otherId && id->isEqualTo(otherId);
+}
+
+} // anonymous namespace
+
+FindUsages::FindUsages(const Snapshot &snapshot)
+    : _snapshot(snapshot),
+      _visibleScopesCache(0)
+{ }
+
+FindUsages::~FindUsages()
+{ }
+
+void FindUsages::setWorkingCopy(const QMap<QString, QByteArray> &workingCopy)
+{ _workingCopy = workingCopy; }
+
+void FindUsages::setVisibleScopesCache(VisibleScopesCache *visibleScopesCache)
+{ _visibleScopesCache = visibleScopesCache; }
+
+QList<Usage> FindUsages::operator()(Symbol *symbol, QFutureInterface<Usage> *future)
+{
+    QList<Usage> usages;
+
+    Identifier *id = symbol ? identifierOf(symbol->name()) : 0;
+    if (! id)
+        return usages;
+
+    _targets = targetsOf(symbol);
+
+    const QString word = QString::fromUtf8(id->chars(), id->size());
+
+    TypeOfExpression typeOfExpression;
+    typeOfExpression.setSnapshot(_snapshot);
+    typeOfExpression.setVisibleScopesCache(_visibleScopesCache);
+
+    ExpressionUnderCursor expressionUnderCursor;
+
+    if (future)
+        future->setProgressRange(0, _snapshot.size());
+
+    int documentCount = 0;
+    foreach (Document::Ptr doc, _snapshot) {
+        if (future) {
+            if (future->isCanceled())
+                break;
+            future->setProgressValue(documentCount++);
+        }
+
+        const QVector<unsigned> offsets = candidates(doc, id);
+        if (offsets.isEmpty())
+            continue;
+
+        const QStringList lines = sourceLines(doc->fileName());
+
+        // The document the candidates are resolved in.
+        Document::Ptr lookupDoc = doc;
+
+        // The same expression in the same scope resolves to the same symbols.
+        QHash<QPair<Symbol *, QString>, bool> resolved;
+
+        foreach (unsigned offset, offsets) {
+            if (future && future->isCanceled())
+                break;
+
+            unsigned line = 0, column = 0;
+            doc->translationUnit()->getPosition(offset, &line, &column);
+
+            if (line == 0 || line > unsigned(lines.size()))
+                continue;
+
+            const QString lineText = lines.at(line - 1);
+            const int position = findWord(lineText, word, column > 0 ? column - 1 : 0);
+            if (position == -1)
+                continue; // the name comes from the expansion of a macro.
+
+            QString expression = expressionUnderCursor(lineText.left(position + word.length()));
+            if (expression.isEmpty())
+                expression = word;
+
+            if (lookupDoc == doc && doc->isFunctionBodySkippedAt(line)) {
+                if (Document::Ptr docWithBodies = documentWithFunctionBodies(doc))
+                    lookupDoc = docWithBodies;
+            }
+
+            Symbol *lastVisibleSymbol = lookupDoc->findSymbolAt(line, position + 1);
+            const QPair<Symbol *, QString> key(lastVisibleSymbol, expression);
+
+            QHash<QPair<Symbol *, QString>, bool>::const_iterator it = resolved.find(key);
+            bool isUsage = false;
+
+            if (it != resolved.end()) {
+                isUsage = it.value();
+            } else {
+                foreach (const TypeOfExpression::Result &r,
+                         typeOfExpression(expression, lookupDoc, lastVisibleSymbol)) {
+                    if (r.second && isTarget(r.second)) {
+                        isUsage = true;
+                        break;
+                    }
+                }
+                resolved.insert(key, isUsage);
+            }
+
+            if (isUsage) {
+                Usage usage;
+                usage.fileName = doc->fileName();
+                usage.lineText = lineText;
+                usage.line = line;
+                usage.column = position;
+                usage.length = word.length();
+                usages.append(usage);
+
+                if (future)
+                    future->reportResult(usage);
+            }
+        }
+    }
+
+    _targets.clear();
+    return usages;
+}
+
+Document::Ptr FindUsages::documentWithFunctionBodies(Document::Ptr doc)
+{ return doc; }
+
+// Returns the symbol, and the declarations of the function it defines.
+QList<Symbol *> FindUsages::targetsOf(Symbol *symbol) const
+{
+    QList<Symbol *> targets;
+    targets.append(symbol);
+
+    if (! symbol->isFunction() || ! symbol->name()->isQualifiedNameId())
+        return targets;
+
+    Document::Ptr doc = _snapshot.value(QString::fromUtf8(symbol->fileName(),
+                                                          symbol->fileNameLength()));
+    if (! doc)
+        return targets;
+
+    TypeOfExpression typeOfExpression;
+    typeOfExpression.setSnapshot(_snapshot);
+    typeOfExpression.setVisibleScopesCache(_visibleScopesCache);
+    (void) typeOfExpression(QString(), doc, symbol);
+
+    foreach (Symbol *declaration, typeOfExpression.lookupContext().resolve(symbol->name())) {
+        if (declaration->type()->isFunction() && ! targets.contains(declaration))
+            targets.append(declaration);
+    }
+
+    return targets;
+}
+
+bool FindUsages::isTarget(Symbol *symbol) const
+{
+    foreach (Symbol *target, _targets) {
+        if (isSameSymbol(symbol, target))
+            return true;
+    }
+
+    return false;
+}
+
+// Returns the offsets at which doc uses the identifier.
+QVector<unsigned> FindUsages::candidates(Document::Ptr doc, Identifier *id)
+{
+    const IdentifierUses &uses = doc->identifierUses();
+    SharedNameTable *nameTable = doc->nameTable().data();
+
+    if (! nameTable) {
+        for (unsigned i = 0; i < uses.identifierCount(); ++i) {
+            if (uses.identifierAt(i)->isEqualTo(id))
+                return uses.usesAt(i);
+        }
+        return QVector<unsigned>();
+    }
+
+    // The identifiers are compared by address, so use the one of the name
+    // table of the document; the table may be different from the one of
+    // the symbol when the snapshot was rebuilt in the meantime. A table that
+    // doesn't contain the identifier has no documents using it.
+    QHash<SharedNameTable *, Identifier *>::const_iterator it = _identifiers.find(nameTable);
+    if (it == _identifiers.end())
+        it = _identifiers.insert(nameTable, nameTable->findIdentifier(id->chars(), id->size()));
+
+    if (! it.value())
+        return QVector<unsigned>();
+
+    return uses.uses(it.value());
+}
+
+QStringList FindUsages::sourceLines(const QString &fileName) const
+{
+    QByteArray source = _workingCopy.value(fileName);
+
+    if (! _workingCopy.contains(fileName)) {
+        QFile file(fileName);
+        if (file.open(QFile::ReadOnly))
+            source = file.readAll();
+    }
+
+    QString text = QString::fromUtf8(source.constData(), source.size());
+    text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+    return text.split(QLatin1Char('\n'));
+}
@@ -0,0 +1,115 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#ifndef CPLUSPLUS_FINDUSAGES_H
+#define CPLUSPLUS_FINDUSAGES_H
+
+#include <cplusplus/CppDocument.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFutureInterface>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+namespace CPlusPlus {
+
+class VisibleScopesCache;
+
+class CPLUSPLUS_EXPORT Usage
+{
+public:
+    Usage()
+        : line(0), column(0), length(0)
+    { }
+
+    QString fileName;
+    QString lineText;
+    int line;   // starting at 1
+    int column; // the position of the name in lineText
+    int length;
+};
+
+/*
+    Finds the places where a symbol is used in the documents of a snapshot.
+
+    The candidates are the uses of the identifier of the symbol recorded by
+    the documents (see Document::recordIdentifierUses()), so that only the
+    documents that contain the name are looked at. A candidate is a usage
+    when the expression ending with the name resolves to the symbol, or to
+    the declaration of the function the symbol defines.
+
+    The candidates inside a function body the document skipped are resolved
+    in the document returned by documentWithFunctionBodies(), so that the
+    local declarations of the body are taken into account.
+*/
+class CPLUSPLUS_EXPORT FindUsages
+{
+public:
+    FindUsages(const Snapshot &snapshot);
+    virtual ~FindUsages();
+
+    // The contents of the files that differ from the ones on disk.
+    void setWorkingCopy(const QMap<QString, QByteArray> &workingCopy);
+
+    void setVisibleScopesCache(VisibleScopesCache *visibleScopesCache);
+
+    // If future is not 0, the usages are reported to it as they are found,
+    // and the search stops when it is canceled.
+    QList<Usage> operator()(Symbol *symbol, QFutureInterface<Usage> *future = 0);
+
+protected:
+    // Returns doc parsed with all its function bodies; by default doc itself.
+    virtual Document::Ptr documentWithFunctionBodies(Document::Ptr doc);
+
+private:
+    QList<Symbol *> targetsOf(Symbol *symbol) const;
+    bool isTarget(Symbol *symbol) const;
+
+    QVector<unsigned> candidates(Document::Ptr doc, Identifier *id);
+    QStringList sourceLines(const QString &fileName) const;
+
+private:
+    Snapshot _snapshot;
+    QMap<QString, QByteArray> _workingCopy;
+    VisibleScopesCache *_visibleScopesCache;
+    QList<Symbol *> _targets;
+    QHash<SharedNameTable *, Identifier *> _identifiers;
+};
+
+} // end of namespace CPlusPlus
+
+#endif // CPLUSPLUS_FINDUSAGES_H
@@ -0,0 +1,116 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#include "IdentifierUses.h"
+
+#include <Token.h>
+#include <TranslationUnit.h>
+
+#include <QtAlgorithms>
+
+using namespace CPlusPlus;
+
+IdentifierUses::IdentifierUses()
+{ }
+
+bool IdentifierUses::isEmpty() const
+{ return _offsets.isEmpty(); }
+
+unsigned IdentifierUses::useCount() const
+{ return _offsets.size(); }
+
+unsigned IdentifierUses::identifierCount() const
+{ return _identifiers.size(); }
+
+Identifier *IdentifierUses::identifierAt(unsigned index) const
+{ return _identifiers.at(index); }
+
+QVector<unsigned> IdentifierUses::uses(Identifier *id) const
+{
+    QVector<Identifier *>::const_iterator it =
+            qBinaryFind(_identifiers.constBegin(), _identifiers.constEnd(), id);
+
+    if (it == _identifiers.constEnd())
+        return QVector<unsigned>();
+
+    return usesAt(it - _identifiers.constBegin());
+}
+
+QVector<unsigned> IdentifierUses::usesAt(unsigned index) const
+{
+    const unsigned first = _firstUse.at(index);
+    const unsigned last = index + 1 < unsigned(_firstUse.size())
+                          ? _firstUse.at(index + 1) : unsigned(_offsets.size());
+    return _offsets.mid(first, last - first);
+}
+
+void IdentifierUses::setUses(QVector<Use> uses)
+{
+    _identifiers.clear();
+    _firstUse.clear();
+    _offsets.clear();
+
+    qSort(uses);
+
+    _offsets.reserve(uses.size());
+
+    for (int i = 0; i < uses.size(); ++i) {
+        const Use &use = uses.at(i);
+
+        if (_identifiers.isEmpty() || _identifiers.last() != use.first) {
+            _identifiers.append(use.first);
+            _firstUse.append(_offsets.size());
+        }
+
+        _offsets.append(use.second);
+    }
+
+    _identifiers.squeeze();
+    _firstUse.squeeze();
+}
+
+IdentifierUses IdentifierUses::fromTranslationUnit(TranslationUnit *unit)
+{
+    QVector<Use> uses;
+
+    for (unsigned index = 0; index < unit->tokenCount(); ++index) {
+        const Token tk = unit->tokenAt(index);
+        if (tk.is(T_IDENTIFIER))
+            uses.append(Use(unit->identifier(index), tk.offset));
+    }
+
+    IdentifierUses identifierUses;
+    identifierUses.setUses(uses);
+    return identifierUses;
+}
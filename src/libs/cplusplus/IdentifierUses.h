@@ -0,0 +1,83 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#ifndef CPLUSPLUS_IDENTIFIERUSES_H
+#define CPLUSPLUS_IDENTIFIERUSES_H
+
+#include <CPlusPlusForwardDeclarations.h>
+
+#include <QtCore/QPair>
+#include <QtCore/QVector>
+
+namespace CPlusPlus {
+
+/*
+    The source offsets at which a document uses each identifier, recorded
+    while its translation unit is still alive. The identifiers come from the
+    name table of the document, which is shared by the documents of a
+    snapshot, so they are found with a binary search on their address.
+
+    The offsets are stored in a single array, grouped by identifier, which
+    costs four bytes per use and eight per distinct identifier.
+*/
+class CPLUSPLUS_EXPORT IdentifierUses
+{
+public:
+    typedef QPair<Identifier *, unsigned> Use;
+
+    IdentifierUses();
+
+    bool isEmpty() const;
+    unsigned useCount() const;
+
+    unsigned identifierCount() const;
+    Identifier *identifierAt(unsigned index) const;
+
+    // The offsets at which the identifier is used, in increasing order.
+    QVector<unsigned> uses(Identifier *id) const;
+    QVector<unsigned> usesAt(unsigned index) const;
+
+    void setUses(QVector<Use> uses);
+
+    static IdentifierUses fromTranslationUnit(TranslationUnit *unit);
+
+private:
+    QVector<Identifier *> _identifiers;
+    QVector<unsigned> _firstUse; // the index in _offsets of the first use of each identifier
+    QVector<unsigned> _offsets;
+};
+
+} // end of namespace CPlusPlus
+
+#endif // CPLUSPLUS_IDENTIFIERUSES_H
@@ -32,6 +32,7 @@
 ***************************************************************************/
 
 #include "LookupContext.h"
+#include "VisibleScopesCache.h"
 #include <CoreTypes.h>
 #include <Symbols.h>
 #include <Literals.h>
@@ -71,17 +72,20 @@ bool LookupUtils::isNameCompatibleWithIdentifier(Name *name, Identifier *id)
 /////////////////////////////////////////////////////////////////////
 LookupContext::LookupContext(Control *control)
     : _control(control),
-      _symbol(0)
+      _symbol(0),
+      _visibleScopesCache(0)
 { }
 
 LookupContext::LookupContext(Symbol *symbol,
                              Document::Ptr expressionDocument,
                              Document::Ptr thisDocument,
-                             const Snapshot &documents)
+                             const Snapshot &documents,
+                             VisibleScopesCache *visibleScopesCache)
     : _symbol(symbol),
       _expressionDocument(expressionDocument),
       _thisDocument(thisDocument),
-      _documents(documents)
+      _documents(documents),
+      _visibleScopesCache(visibleScopesCache)
 {
     _control = _expressionDocument->control();
     _visibleScopes = buildVisibleScopes();
@@ -92,7 +96,8 @@ LookupContext::LookupContext(Symbol *symbol,
     : _control(context._control),
       _symbol(symbol),
       _expressionDocument(context._expressionDocument),
-      _documents(context._documents)
+      _documents(context._documents),
+      _visibleScopesCache(context._visibleScopesCache)
 {
     const QString fn = QString::fromUtf8(symbol->fileName(), symbol->fileNameLength());
     _thisDocument = _documents.value(fn);
@@ -106,7 +111,8 @@ LookupContext::LookupContext(Symbol *symbol,
       _symbol(symbol),
       _expressionDocument(context._expressionDocument),
       _thisDocument(thisDocument),
-      _documents(context._documents)
+      _documents(context._documents),
+      _visibleScopesCache(context._visibleScopesCache)
 {
     _visibleScopes = buildVisibleScopes();
 }
@@ -210,17 +216,23 @@ QList<Symbol *> LookupContext::resolve(Name *name, const QList<Scope *> &visible
 
 QList<Scope *> LookupContext::buildVisibleScopes()
 {
+    Scope *enclosingScope = _symbol ? _symbol->scope() : 0;
+
     QList<Scope *> scopes;
+    if (_visibleScopesCache && _visibleScopesCache->find(_thisDocument, enclosingScope,
+                                                         _documents, &scopes))
+        return scopes;
 
-    if (_symbol) {
-        for (Scope *scope = _symbol->scope(); scope; scope = scope->enclosingScope()) {
-            scopes.append(scope);
-        }
+    for (Scope *scope = enclosingScope; scope; scope = scope->enclosingScope()) {
+        scopes.append(scope);
     }
 
     QSet<QString> processed;
     processed.insert(_thisDocument->fileName());
 
+    QList<Document::Ptr> includedDocuments;
+    QStringList missingFiles;
+
     QList<QString> todo = _thisDocument->includedFiles();
     while (! todo.isEmpty()) {
         QString fn = todo.last();
@@ -231,8 +243,11 @@ QList<Scope *> LookupContext::buildVisibleScopes()
 
         processed.insert(fn);
         if (Document::Ptr doc = document(fn)) {
+            includedDocuments.append(doc);
             scopes.append(doc->globalNamespace()->members());
             todo += doc->includedFiles();
+        } else {
+            missingFiles.append(fn);
         }
     }
 
@@ -240,12 +255,16 @@ QList<Scope *> LookupContext::buildVisibleScopes()
         QList<Scope *> expandedScopes;
         expand(scopes, &expandedScopes);
 
-        if (expandedScopes.size() == scopes.size())
-            return expandedScopes;
-
+        const bool done = expandedScopes.size() == scopes.size();
         scopes = expandedScopes;
+        if (done)
+            break;
     }
 
+    if (_visibleScopesCache)
+        _visibleScopesCache->insert(_thisDocument, enclosingScope,
+                                    includedDocuments, missingFiles, scopes);
+
     return scopes;
 }
 
@@ -43,6 +43,8 @@
 
 namespace CPlusPlus {
 
+class VisibleScopesCache;
+
 class CPLUSPLUS_EXPORT LookupUtils
 {
 public:
@@ -57,7 +59,8 @@ public:
     LookupContext(Symbol *symbol,
                   Document::Ptr expressionDocument,
                   Document::Ptr thisDocument,
-                  const Snapshot &documents);
+                  const Snapshot &documents,
+                  VisibleScopesCache *visibleScopesCache = 0);
 
     LookupContext(Symbol *symbol,
                   const LookupContext &context);
@@ -142,6 +145,9 @@ private:
     // All documents.
     Snapshot _documents;
 
+    // The expanded visible scopes computed by the other contexts, if any.
+    VisibleScopesCache *_visibleScopesCache;
+
     // Visible scopes.
     QList<Scope *> _visibleScopes;
 };
@@ -0,0 +1,134 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+#include "SharedNameTable.h"
+
+#include <Names.h>
+
+#include <QtCore/QReadLocker>
+#include <QtCore/QWriteLocker>
+
+using namespace CPlusPlus;
+
+SharedNameTable::SharedNameTable()
+{ }
+
+SharedNameTable::~SharedNameTable()
+{
+    qDeleteAll(_nameIds);
+    qDeleteAll(_destructorNameIds);
+    qDeleteAll(_operatorNameIds);
+}
+
+unsigned SharedNameTable::identifierCount() const
+{
+    QReadLocker locker(&_literalLock);
+    return _identifiers.size();
+}
+
+Identifier *SharedNameTable::findIdentifier(const char *chars, unsigned size) const
+{
+    QReadLocker locker(&_literalLock);
+    return _identifiers.findLiteral(chars, size);
+}
+
+Identifier *SharedNameTable::findOrInsertIdentifier(const char *chars, unsigned size)
+{ return findOrInsertLiteral(&_identifiers, chars, size); }
+
+StringLiteral *SharedNameTable::findOrInsertStringLiteral(const char *chars, unsigned size)
+{ return findOrInsertLiteral(&_stringLiterals, chars, size); }
+
+NumericLiteral *SharedNameTable::findOrInsertNumericLiteral(const char *chars, unsigned size)
+{ return findOrInsertLiteral(&_numericLiterals, chars, size); }
+
+NameId *SharedNameTable::nameId(Identifier *id)
+{ return findOrInsertName(&_nameIds, id); }
+
+DestructorNameId *SharedNameTable::destructorNameId(Identifier *id)
+{ return findOrInsertName(&_destructorNameIds, id); }
+
+OperatorNameId *SharedNameTable::operatorNameId(int operatorId)
+{
+    {
+        QReadLocker locker(&_nameLock);
+        if (OperatorNameId *name = _operatorNameIds.value(operatorId))
+            return name;
+    }
+
+    QWriteLocker locker(&_nameLock);
+    OperatorNameId *&name = _operatorNameIds[operatorId];
+    if (! name)
+        name = new OperatorNameId(operatorId);
+    return name;
+}
+
+bool SharedNameTable::ownsIdentifier(Identifier *id) const
+{
+    QReadLocker locker(&_literalLock);
+    return _identifiers.findLiteral(id->chars(), id->size()) == id;
+}
+
+template <typename _Literal>
+_Literal *SharedNameTable::findOrInsertLiteral(LiteralTable<_Literal> *table,
+                                               const char *chars, unsigned size)
+{
+    {
+        QReadLocker locker(&_literalLock);
+        if (_Literal *literal = table->findLiteral(chars, size))
+            return literal;
+    }
+
+    QWriteLocker locker(&_literalLock);
+    return table->findOrInsertLiteral(chars, size);
+}
+
+template <typename _Name>
+_Name *SharedNameTable::findOrInsertName(QHash<Identifier *, _Name *> *names, Identifier *id)
+{
+    {
+        QReadLocker locker(&_nameLock);
+        if (_Name *name = names->value(id))
+            return name;
+    }
+
+    // names referring to identifiers of other tables would dangle as soon
+    // as their table goes away.
+    if (! ownsIdentifier(id))
+        return 0;
+
+    QWriteLocker locker(&_nameLock);
+    _Name *&name = (*names)[id];
+    if (! name)
+        name = new _Name(id);
+    return name;
+}
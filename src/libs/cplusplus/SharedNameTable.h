@@ -0,0 +1,104 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+#ifndef CPLUSPLUS_SHAREDNAMETABLE_H
+#define CPLUSPLUS_SHAREDNAMETABLE_H
+
+#include <CPlusPlusForwardDeclarations.h>
+#include <NameTable.h>
+#include <LiteralTable.h>
+#include <Literals.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSharedPointer>
+
+namespace CPlusPlus {
+
+/*
+    A thread-safe NameTable shared by the documents of a snapshot, so that
+    the identifiers and simple names used all over the code model ("QString",
+    "QObject", ...) exist only once, and comparing them across documents is
+    a pointer comparison.
+
+    Every document created with a shared name table keeps a reference to
+    it; the table goes away together with the last of those documents.
+*/
+class CPLUSPLUS_EXPORT SharedNameTable: public NameTable
+{
+public:
+    typedef QSharedPointer<SharedNameTable> Ptr;
+
+public:
+    SharedNameTable();
+    virtual ~SharedNameTable();
+
+    unsigned identifierCount() const;
+
+    // Returns 0 if the table doesn't contain the identifier, without
+    // inserting it.
+    Identifier *findIdentifier(const char *chars, unsigned size) const;
+
+    virtual Identifier *findOrInsertIdentifier(const char *chars, unsigned size);
+    virtual StringLiteral *findOrInsertStringLiteral(const char *chars, unsigned size);
+    virtual NumericLiteral *findOrInsertNumericLiteral(const char *chars, unsigned size);
+
+    virtual NameId *nameId(Identifier *id);
+    virtual DestructorNameId *destructorNameId(Identifier *id);
+    virtual OperatorNameId *operatorNameId(int operatorId);
+
+private:
+    bool ownsIdentifier(Identifier *id) const;
+
+    template <typename _Literal>
+    _Literal *findOrInsertLiteral(LiteralTable<_Literal> *table,
+                                  const char *chars, unsigned size);
+
+    template <typename _Name>
+    _Name *findOrInsertName(QHash<Identifier *, _Name *> *names, Identifier *id);
+
+private:
+    mutable QReadWriteLock _literalLock;
+    LiteralTable<Identifier> _identifiers;
+    LiteralTable<StringLiteral> _stringLiterals;
+    LiteralTable<NumericLiteral> _numericLiterals;
+
+    mutable QReadWriteLock _nameLock;
+    QHash<Identifier *, NameId *> _nameIds;
+    QHash<Identifier *, DestructorNameId *> _destructorNameIds;
+    QHash<int, OperatorNameId *> _operatorNameIds;
+};
+
+} // end of namespace CPlusPlus
+
+#endif // CPLUSPLUS_SHAREDNAMETABLE_H
@@ -42,6 +42,8 @@
 using namespace CPlusPlus;
 
 TypeOfExpression::TypeOfExpression():
+    m_visibleScopesCache(0),
+    m_future(0),
     m_ast(0)
 {
 }
@@ -52,6 +54,16 @@ void TypeOfExpression::setSnapshot(const Snapshot &documents)
     m_lookupContext = LookupContext();
 }
 
+void TypeOfExpression::setVisibleScopesCache(VisibleScopesCache *visibleScopesCache)
+{
+    m_visibleScopesCache = visibleScopesCache;
+}
+
+void TypeOfExpression::setFuture(QFutureInterfaceBase *future)
+{
+    m_future = future;
+}
+
 QList<TypeOfExpression::Result> TypeOfExpression::operator()(const QString &expression,
                                                              Document::Ptr document,
                                                              Symbol *lastVisibleSymbol,
@@ -59,12 +71,18 @@ QList<TypeOfExpression::Result> TypeOfExpression::operator()(const QString &expr
 {
     QString code = expression;
     if (mode == Preprocess)
-        code = preprocessedExpression(expression, m_snapshot, document);
+        code = preprocessedExpression(expression, document);
     Document::Ptr expressionDoc = documentForExpression(code);
     m_ast = extractExpressionAST(expressionDoc);
 
+    if (m_future && m_future->isCanceled())
+        return QList<Result>();
+
     m_lookupContext = LookupContext(lastVisibleSymbol, expressionDoc,
-                                    document, m_snapshot);
+                                    document, m_snapshot, m_visibleScopesCache);
+
+    if (m_future && m_future->isCanceled())
+        return QList<Result>();
 
     ResolveExpression resolveExpression(m_lookupContext);
     return resolveExpression(m_ast);
@@ -103,32 +121,12 @@ Document::Ptr TypeOfExpression::documentForExpression(const QString &expression)
     return doc;
 }
 
-void TypeOfExpression::processEnvironment(Snapshot documents,
-                                          Document::Ptr doc, Environment *env,
-                                          QSet<QString> *processed) const
-{
-    if (! doc)
-        return;
-    if (processed->contains(doc->fileName()))
-        return;
-    processed->insert(doc->fileName());
-    foreach (const Document::Include &incl, doc->includes()) {
-        processEnvironment(documents,
-                           documents.value(incl.fileName()),
-                           env, processed);
-    }
-    foreach (const Macro &macro, doc->definedMacros())
-        env->bind(macro);
-}
-
 QString TypeOfExpression::preprocessedExpression(const QString &expression,
-                                                 Snapshot documents,
                                                  Document::Ptr thisDocument) const
 {
     Environment env;
-    QSet<QString> processed;
-    processEnvironment(documents, thisDocument,
-                       &env, &processed);
+    if (thisDocument)
+        env.merge(thisDocument->macroTable());
     const QByteArray code = expression.toUtf8();
     pp preproc(0, env);
     QByteArray preprocessedCode;
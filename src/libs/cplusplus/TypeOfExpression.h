@@ -37,6 +37,7 @@
 #include <cplusplus/CppDocument.h>
 #include <cplusplus/LookupContext.h>
 
+#include <QtCore/QFutureInterface>
 #include <QtCore/QMap>
 #include <QtCore/QObject>
 #include <QtCore/QString>
@@ -45,6 +46,7 @@ namespace CPlusPlus {
 
 class Environment;
 class Macro;
+class VisibleScopesCache;
 
 class CPLUSPLUS_EXPORT TypeOfExpression
 {
@@ -63,6 +65,20 @@ public:
      */
     void setSnapshot(const Snapshot &documents);
 
+    /**
+     * Sets the cache of the visible scopes shared by the lookup contexts
+     * created for the expressions. Without a cache, every expression has
+     * the visible scopes of its context computed again.
+     */
+    void setVisibleScopesCache(VisibleScopesCache *visibleScopesCache);
+
+    /**
+     * Sets the future of the task evaluating the expressions. Once it is
+     * canceled, the evaluation stops between its steps and returns no
+     * results.
+     */
+    void setFuture(QFutureInterfaceBase *future);
+
     enum PreprocessMode {
         NoPreprocess,
         Preprocess
@@ -100,15 +116,12 @@ private:
     ExpressionAST *extractExpressionAST(Document::Ptr doc) const;
     Document::Ptr documentForExpression(const QString &expression) const;
 
-    void processEnvironment(CPlusPlus::Snapshot documents,
-                            CPlusPlus::Document::Ptr doc, CPlusPlus::Environment *env,
-                            QSet<QString> *processed) const;
-
     QString preprocessedExpression(const QString &expression,
-                                   CPlusPlus::Snapshot documents,
                                    CPlusPlus::Document::Ptr thisDocument) const;
 
     Snapshot m_snapshot;
+    VisibleScopesCache *m_visibleScopesCache;
+    QFutureInterfaceBase *m_future;
     ExpressionAST *m_ast;
     LookupContext m_lookupContext;
 };
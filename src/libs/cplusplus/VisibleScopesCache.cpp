@@ -0,0 +1,131 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+#include "VisibleScopesCache.h"
+
+#include <QtCore/QMutexLocker>
+
+using namespace CPlusPlus;
+
+VisibleScopesCache::VisibleScopesCache()
+{ }
+
+VisibleScopesCache::~VisibleScopesCache()
+{ }
+
+bool VisibleScopesCache::find(Document::Ptr thisDocument, Scope *enclosingScope,
+                              const Snapshot &snapshot, QList<Scope *> *visibleScopes)
+{
+    if (! thisDocument)
+        return false;
+
+    QMutexLocker locker(&_mutex);
+
+    QHash<Key, Entry>::iterator it = _entries.find(Key(thisDocument->revision(), enclosingScope));
+    if (it == _entries.end())
+        return false;
+    else if (! isValid(it.value(), snapshot)) {
+        _keysByFileName.remove(it.value().fileName, it.key());
+        _entries.erase(it);
+        return false;
+    }
+
+    *visibleScopes = it.value().visibleScopes;
+    return true;
+}
+
+void VisibleScopesCache::insert(Document::Ptr thisDocument, Scope *enclosingScope,
+                                const QList<Document::Ptr> &includedDocuments,
+                                const QStringList &missingFiles,
+                                const QList<Scope *> &visibleScopes)
+{
+    if (! thisDocument)
+        return;
+
+    Entry entry;
+    entry.fileName = thisDocument->fileName();
+    entry.thisDocument = thisDocument;
+    foreach (Document::Ptr doc, includedDocuments)
+        entry.documents.append(qMakePair(doc->fileName(), QWeakPointer<Document>(doc)));
+    entry.missingFiles = missingFiles;
+    entry.visibleScopes = visibleScopes;
+
+    const Key key(thisDocument->revision(), enclosingScope);
+
+    QMutexLocker locker(&_mutex);
+
+    if (_entries.size() >= MaxEntryCount) {
+        _entries.clear();
+        _keysByFileName.clear();
+    }
+
+    if (! _entries.contains(key))
+        _keysByFileName.insert(thisDocument->fileName(), key);
+    _entries.insert(key, entry);
+}
+
+void VisibleScopesCache::remove(const QString &fileName)
+{
+    QMutexLocker locker(&_mutex);
+
+    foreach (const Key &key, _keysByFileName.values(fileName))
+        _entries.remove(key);
+    _keysByFileName.remove(fileName);
+}
+
+void VisibleScopesCache::clear()
+{
+    QMutexLocker locker(&_mutex);
+    _entries.clear();
+    _keysByFileName.clear();
+}
+
+bool VisibleScopesCache::isValid(const Entry &entry, const Snapshot &snapshot) const
+{
+    if (! entry.thisDocument.toStrongRef())
+        return false;
+
+    for (int i = 0; i < entry.documents.size(); ++i) {
+        const QPair<QString, QWeakPointer<Document> > &d = entry.documents.at(i);
+        const Document::Ptr cachedDoc = d.second.toStrongRef();
+        if (! cachedDoc || snapshot.value(d.first) != cachedDoc)
+            return false;
+    }
+
+    foreach (const QString &fileName, entry.missingFiles) {
+        if (snapshot.contains(fileName))
+            return false;
+    }
+
+    return true;
+}
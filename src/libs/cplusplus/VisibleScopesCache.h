@@ -0,0 +1,107 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+#ifndef CPLUSPLUS_VISIBLESCOPESCACHE_H
+#define CPLUSPLUS_VISIBLESCOPESCACHE_H
+
+#include <cplusplus/CppDocument.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QWeakPointer>
+
+namespace CPlusPlus {
+
+/*
+    Remembers the expanded visible scopes that LookupContext computes for a
+    scope of a document, so that the contexts created over and over by code
+    completion, the hover handler and TypeOfExpression don't walk the
+    included documents, the using directives and the base classes again.
+
+    An entry is keyed by the revision of the document and the enclosing
+    scope, and is reused as long as the snapshot still holds the same
+    documents for all the files the document includes; a stale entry is
+    dropped when it is found. The cache can be shared by the threads looking
+    up symbols.
+*/
+class CPLUSPLUS_EXPORT VisibleScopesCache
+{
+    VisibleScopesCache(const VisibleScopesCache &other);
+    void operator =(const VisibleScopesCache &other);
+
+public:
+    VisibleScopesCache();
+    ~VisibleScopesCache();
+
+    bool find(Document::Ptr thisDocument, Scope *enclosingScope,
+              const Snapshot &snapshot, QList<Scope *> *visibleScopes);
+
+    void insert(Document::Ptr thisDocument, Scope *enclosingScope,
+                const QList<Document::Ptr> &includedDocuments,
+                const QStringList &missingFiles,
+                const QList<Scope *> &visibleScopes);
+
+    // Removes the entries computed for the documents of the given file.
+    void remove(const QString &fileName);
+
+    void clear();
+
+private:
+    typedef QPair<unsigned, Scope *> Key;
+
+    struct Entry
+    {
+        QString fileName;
+        QWeakPointer<Document> thisDocument;
+        QList<QPair<QString, QWeakPointer<Document> > > documents;
+        QStringList missingFiles;
+        QList<Scope *> visibleScopes;
+    };
+
+    bool isValid(const Entry &entry, const Snapshot &snapshot) const;
+
+private:
+    enum { MaxEntryCount = 512 };
+
+    QMutex _mutex;
+    QHash<Key, Entry> _entries;
+    QMultiHash<QString, Key> _keysByFileName;
+};
+
+} // end of namespace CPlusPlus
+
+#endif // CPLUSPLUS_VISIBLESCOPESCACHE_H
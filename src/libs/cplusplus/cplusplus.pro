@@ -14,6 +14,12 @@ HEADERS += \
     ExpressionUnderCursor.h \
     TokenUnderCursor.h \
     CppDocument.h \
+    DocumentCache.h \
+    FindUsages.h \
+    IdentifierUses.h \
+    VisibleScopesCache.h \
+    SharedNameTable.h \
+    BlockRecycler.h \
     Icons.h \
     Overview.h \
     OverviewModel.h \
@@ -36,6 +42,12 @@ SOURCES += \
     ExpressionUnderCursor.cpp \
     TokenUnderCursor.cpp \
     CppDocument.cpp \
+    DocumentCache.cpp \
+    FindUsages.cpp \
+    IdentifierUses.cpp \
+    VisibleScopesCache.cpp \
+    SharedNameTable.cpp \
+    BlockRecycler.cpp \
     Icons.cpp \
     Overview.cpp \
     OverviewModel.cpp \
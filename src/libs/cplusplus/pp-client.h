@@ -75,6 +75,10 @@ public:
 
   virtual void startSkippingBlocks(unsigned offset) = 0;
   virtual void stopSkippingBlocks(unsigned offset) = 0;
+
+  // The whole file is wrapped in  #ifndef macroName / #define macroName ... #endif
+  virtual void includeGuardDetected(const QByteArray &macroName) = 0;
+  virtual void pragmaOnceDetected() = 0;
 };
 
 } // namespace CPlusPlus
@@ -516,6 +516,9 @@ void pp::operator()(const QByteArray &source, QByteArray *result)
 {
     pushState(createStateFromSource(source));
 
+    if (client)
+        checkIncludeGuard();
+
     const unsigned previousCurrentLine = env.currentLine;
     env.currentLine = 0;
 
@@ -596,7 +599,7 @@ void pp::operator()(const QByteArray &source, QByteArray *result)
                     continue;
                 }
 
-                Macro *m = env.resolve(spell);
+                const Macro *m = env.resolve(spell);
                 if (! m) {
                     result->append(spell);
                 } else {
@@ -606,13 +609,13 @@ void pp::operator()(const QByteArray &source, QByteArray *result)
                                 client->startExpandingMacro(identifierToken->offset,
                                                             *m, spell);
 
-                            m->hidden = true;
+                            env.hide(m);
 
                             expand(m->definition.constBegin(),
                                    m->definition.constEnd(),
                                    result);
 
-                            m->hidden = false;
+                            env.unhide(m);
 
                             if (client)
                                 client->stopExpandingMacro(_dot->offset, *m);
@@ -624,13 +627,13 @@ void pp::operator()(const QByteArray &source, QByteArray *result)
                             if (client)
                                 client->startExpandingMacro(identifierToken->offset,
                                                             *m, spell);
-                            m->hidden = true;
+                            env.hide(m);
 
                             expand(m->definition.constBegin(),
                                    m->definition.constEnd(),
                                    &tmp);
 
-                            m->hidden = false;
+                            env.unhide(m);
 
                             if (client)
                                 client->stopExpandingMacro(_dot->offset, *m);
@@ -640,7 +643,7 @@ void pp::operator()(const QByteArray &source, QByteArray *result)
                             pushState(createStateFromSource(tmp));
                             if (_dot->is(T_IDENTIFIER)) {
                                 const QByteArray id = tokenSpell(*_dot);
-                                Macro *macro = env.resolve(id);
+                                const Macro *macro = env.resolve(id);
                                 if (macro && macro->function_like)
                                     m = macro;
                             }
@@ -700,6 +703,110 @@ void pp::operator()(const QByteArray &source, QByteArray *result)
     env.currentLine = previousCurrentLine;
 }
 
+void pp::checkIncludeGuard()
+{
+    enum {
+        ExpectIfndef,
+        ExpectDefine,
+        Guarded,
+        Closed,
+        NotGuarded
+    } guardState = ExpectIfndef;
+
+    QByteArray guard;
+    bool pragmaOnce = false;
+    int level = 0;
+
+    TokenIterator dot = _tokens.constBegin();
+    while (dot->isNot(T_EOF_SYMBOL)) {
+        const TokenIterator start = dot;
+        do {
+            ++dot;
+        } while (dot->isNot(T_EOF_SYMBOL) && (dot->joined || ! dot->newline));
+
+        if (start->isNot(T_POUND) || start->joined || ! start->newline) {
+            // code outside of the guard, or between #ifndef and #define.
+            if (level == 0 || guardState == ExpectDefine)
+                guardState = NotGuarded;
+            continue;
+        }
+
+        RangeLexer tk(start, dot);
+        ++tk; // skip T_POUND
+
+        if (tk->isNot(T_IDENTIFIER))
+            continue; // null directive
+
+        const PP_DIRECTIVE_TYPE d = classifyDirective(tokenSpell(*tk));
+        ++tk; // skip the directive
+
+        QByteArray name;
+        if (tk->is(T_IDENTIFIER)) {
+            name = tokenSpell(*tk);
+            ++tk;
+        }
+
+        switch (d) {
+        case PP_PRAGMA:
+            if (level == 0 && name == "once") {
+                pragmaOnce = true;
+                continue;
+            }
+            break;
+
+        case PP_IF:
+        case PP_IFDEF:
+        case PP_IFNDEF:
+            if (level == 0) {
+                if (guardState == ExpectIfndef && d == PP_IFNDEF
+                        && ! name.isEmpty() && tk.dot() == dot) {
+                    // a deep copy, the guard outlives the source
+                    guard = QByteArray(name.constData(), name.size());
+                    guardState = ExpectDefine;
+                } else {
+                    guardState = NotGuarded;
+                }
+            }
+            ++level;
+            continue;
+
+        case PP_ENDIF:
+            if (level == 0) {
+                guardState = NotGuarded; // unbalanced #endif
+                continue;
+            }
+            if (--level == 0 && guardState == Guarded)
+                guardState = Closed;
+            continue;
+
+        case PP_ELSE:
+        case PP_ELIF:
+            if (level == 1)
+                guardState = NotGuarded;
+            continue;
+
+        case PP_DEFINE:
+            if (guardState == ExpectDefine) {
+                guardState = (name == guard) ? Guarded : NotGuarded;
+                continue;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        if (level == 0 || guardState == ExpectDefine)
+            guardState = NotGuarded;
+    }
+
+    if (guardState == Closed && level == 0)
+        client->includeGuardDetected(guard);
+
+    if (pragmaOnce)
+        client->pragmaOnceDetected();
+}
+
 const char *pp::startOfToken(const Token &token) const
 { return _source.constBegin() + token.begin(); }
 
@@ -1066,6 +1173,8 @@ pp::PP_DIRECTIVE_TYPE pp::classifyDirective (const QByteArray &__directive) cons
             return PP_IFNDEF;
         else if (__directive[0] == 'd' && __directive == "define")
             return PP_DEFINE;
+        else if (__directive[0] == 'p' && __directive == "pragma")
+            return PP_PRAGMA;
         break;
 
     case 7:
@@ -158,6 +158,7 @@ namespace CPlusPlus {
             PP_IF,
             PP_IFDEF,
             PP_IFNDEF,
+            PP_PRAGMA,
             PP_UNDEF
         };
 
@@ -210,6 +211,8 @@ namespace CPlusPlus {
         QByteArray tokenSpell(const CPlusPlus::Token &token) const;
         QByteArray tokenText(const CPlusPlus::Token &token) const; // does a deep copy
 
+        void checkIncludeGuard();
+
         void processDirective(TokenIterator dot, TokenIterator lastToken);
         void processInclude(bool skipCurrentPath,
                             TokenIterator dot, TokenIterator lastToken,
@@ -57,68 +57,360 @@
 
 using namespace CPlusPlus;
 
-Environment::Environment()
-    : currentLine(0),
-      hide_next(false),
-      _macros(0),
-      _allocated_macros(0),
-      _macro_count(-1),
-      _hash(0),
-      _hash_count(401)
+namespace CPlusPlus {
+
+class MacroTableLeaf: public QSharedData
+{
+public:
+    MacroTableLeaf(const Macro &macro)
+        : macro(macro)
+    { }
+
+    Macro macro;
+};
+
+typedef QExplicitlySharedDataPointer<MacroTableNode> NodePtr;
+typedef QExplicitlySharedDataPointer<MacroTableLeaf> LeafPtr;
+
+// Every level of the trie consumes 5 bits of the hash code. Below the last
+// level the nodes are plain lists of the macros with the same hash code.
+class MacroTableNode: public QSharedData
+{
+public:
+    struct Entry {
+        NodePtr node;
+        LeafPtr leaf;
+    };
+
+    MacroTableNode()
+        : bitmap(0),
+          size(0)
+    { }
+
+    quint32 bitmap;
+    unsigned size; // number of macros in this subtree
+    QVector<Entry> entries;
+};
+
+} // namespace CPlusPlus
+
+namespace {
+
+enum { BITS_PER_LEVEL = 5, HASH_BITS = 32 };
+
+inline int bitCount(quint32 v)
 {
+    v = v - ((v >> 1) & 0x55555555);
+    v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+    return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
 }
 
-Environment::~Environment()
+inline quint32 bitAt(unsigned hashcode, unsigned shift)
+{ return 1u << ((hashcode >> shift) & 31); }
+
+inline MacroTableNode::Entry leafEntry(const LeafPtr &leaf)
+{
+    MacroTableNode::Entry entry;
+    entry.leaf = leaf;
+    return entry;
+}
+
+// Returns true if the leaf was added, false if it replaced a macro with the
+// same name. Nodes that are shared with other tables are copied first.
+bool insertLeaf(NodePtr &node, const LeafPtr &leaf, unsigned shift)
 {
-    if (_macros) {
-        qDeleteAll(firstMacro(), lastMacro());
-        free(_macros);
+    if (! node)
+        node = NodePtr(new MacroTableNode);
+    else
+        node.detach();
+
+    MacroTableNode *n = node.data();
+
+    if (shift >= HASH_BITS) {
+        for (int i = 0; i < n->entries.size(); ++i) {
+            MacroTableNode::Entry &e = n->entries[i];
+            if (e.leaf->macro.name == leaf->macro.name) {
+                e.leaf = leaf;
+                return false;
+            }
+        }
+        n->entries.append(leafEntry(leaf));
+        ++n->size;
+        return true;
+    }
+
+    const quint32 bit = bitAt(leaf->macro.hashcode, shift);
+    const int index = bitCount(n->bitmap & (bit - 1));
+
+    if (! (n->bitmap & bit)) {
+        n->bitmap |= bit;
+        n->entries.insert(index, leafEntry(leaf));
+        ++n->size;
+        return true;
+    }
+
+    MacroTableNode::Entry &e = n->entries[index];
+
+    if (e.node) {
+        const bool added = insertLeaf(e.node, leaf, shift + BITS_PER_LEVEL);
+        n->size += added;
+        return added;
     }
 
-    if (_hash)
-        free(_hash);
+    if (e.leaf == leaf)
+        return false;
+
+    if (e.leaf->macro.name == leaf->macro.name) {
+        e.leaf = leaf;
+        return false;
+    }
+
+    NodePtr child;
+    insertLeaf(child, e.leaf, shift + BITS_PER_LEVEL);
+    insertLeaf(child, leaf, shift + BITS_PER_LEVEL);
+    e.leaf = LeafPtr();
+    e.node = child;
+    ++n->size;
+    return true;
 }
 
-unsigned Environment::macroCount() const
+// Adds the entries of other to node. When both contain a macro with the same
+// name the one of other wins, unless keepExisting is set. Returns the number
+// of macros that were added. Subtrees shared by both tables are skipped.
+unsigned uniteNodes(NodePtr &node, const NodePtr &other, unsigned shift,
+                    bool keepExisting)
+{
+    if (! other || node == other)
+        return 0;
+
+    if (shift >= HASH_BITS) {
+        unsigned added = 0;
+        foreach (const MacroTableNode::Entry &oe, other->entries) {
+            if (! keepExisting || ! node) {
+                added += insertLeaf(node, oe.leaf, shift);
+                continue;
+            }
+
+            bool found = false;
+            foreach (const MacroTableNode::Entry &e, node->entries) {
+                if (e.leaf->macro.name == oe.leaf->macro.name) {
+                    found = true;
+                    break;
+                }
+            }
+            if (! found)
+                added += insertLeaf(node, oe.leaf, shift);
+        }
+        return added;
+    }
+
+    if (! node)
+        node = NodePtr(new MacroTableNode);
+    else
+        node.detach();
+
+    MacroTableNode *n = node.data();
+
+    unsigned added = 0;
+    int j = 0;
+    for (unsigned s = 0; s < 32; ++s) {
+        const quint32 bit = 1u << s;
+        if (! (other->bitmap & bit))
+            continue;
+
+        const MacroTableNode::Entry &oe = other->entries.at(j++);
+        const int index = bitCount(n->bitmap & (bit - 1));
+
+        if (! (n->bitmap & bit)) {
+            n->bitmap |= bit;
+            n->entries.insert(index, oe);
+            added += oe.node ? oe.node->size : 1;
+            continue;
+        }
+
+        MacroTableNode::Entry &e = n->entries[index];
+
+        if (e.leaf && (e.leaf == oe.leaf))
+            continue;
+
+        if (e.leaf && oe.leaf && e.leaf->macro.name == oe.leaf->macro.name) {
+            if (! keepExisting)
+                e.leaf = oe.leaf;
+            continue;
+        }
+
+        if (e.leaf) {
+            NodePtr child;
+            insertLeaf(child, e.leaf, shift + BITS_PER_LEVEL);
+            e.leaf = LeafPtr();
+            e.node = child;
+        }
+
+        if (oe.node) {
+            added += uniteNodes(e.node, oe.node, shift + BITS_PER_LEVEL, keepExisting);
+        } else {
+            NodePtr child;
+            insertLeaf(child, oe.leaf, shift + BITS_PER_LEVEL);
+            added += uniteNodes(e.node, child, shift + BITS_PER_LEVEL, keepExisting);
+        }
+    }
+
+    n->size += added;
+    return added;
+}
+
+void collectMacros(const MacroTableNode *node, QList<Macro> *macros)
 {
-    return _macro_count + 1;
+    foreach (const MacroTableNode::Entry &e, node->entries) {
+        if (e.node)
+            collectMacros(e.node.data(), macros);
+        else
+            macros->append(e.leaf->macro);
+    }
 }
 
-Macro *Environment::macroAt(unsigned index) const
+void collectMacroNames(const MacroTableNode *node, QList<QByteArray> *names)
 {
-    return _macros[index];
+    foreach (const MacroTableNode::Entry &e, node->entries) {
+        if (e.node)
+            collectMacroNames(e.node.data(), names);
+        else if (! e.leaf->macro.hidden)
+            names->append(e.leaf->macro.name);
+    }
 }
 
-Macro *Environment::bind(const Macro &__macro)
+} // end of anonymous namespace
+
+MacroTable::MacroTable()
+{ }
+
+MacroTable::MacroTable(const MacroTable &other)
+    : _root(other._root)
+{ }
+
+MacroTable::~MacroTable()
+{ }
+
+MacroTable &MacroTable::operator=(const MacroTable &other)
 {
-    Q_ASSERT(! __macro.name.isEmpty());
+    _root = other._root;
+    return *this;
+}
 
-    Macro *m = new Macro (__macro);
-    m->hashcode = hash_code(m->name);
+bool MacroTable::isEmpty() const
+{ return count() == 0; }
 
-    if (++_macro_count == _allocated_macros) {
-        if (! _allocated_macros)
-            _allocated_macros = 401;
-        else
-            _allocated_macros <<= 1;
+unsigned MacroTable::count() const
+{ return _root ? _root->size : 0; }
+
+bool MacroTable::isSharedWith(const MacroTable &other) const
+{ return _root == other._root; }
+
+const Macro *MacroTable::find(const QByteArray &name) const
+{
+    const unsigned hashcode = hashCode(name);
+    const MacroTableNode *n = _root.data();
 
-        _macros = (Macro **) realloc(_macros, sizeof(Macro *) * _allocated_macros);
+    for (unsigned shift = 0; n; shift += BITS_PER_LEVEL) {
+        if (shift >= HASH_BITS) {
+            foreach (const MacroTableNode::Entry &e, n->entries) {
+                if (e.leaf->macro.name == name)
+                    return &e.leaf->macro;
+            }
+            return 0;
+        }
+
+        const quint32 bit = bitAt(hashcode, shift);
+        if (! (n->bitmap & bit))
+            return 0;
+
+        const MacroTableNode::Entry &e = n->entries.at(bitCount(n->bitmap & (bit - 1)));
+        if (e.leaf)
+            return e.leaf->macro.name == name ? &e.leaf->macro : 0;
+
+        n = e.node.data();
     }
 
-    _macros[_macro_count] = m;
+    return 0;
+}
+
+const Macro *MacroTable::insert(const Macro &macro)
+{
+    LeafPtr leaf(new MacroTableLeaf(macro));
+    leaf->macro.hashcode = hashCode(macro.name);
+    insertLeaf(_root, leaf, 0);
+    return &leaf->macro;
+}
+
+void MacroTable::unite(const MacroTable &other)
+{
+    if (other._root == _root || other.isEmpty())
+        return;
+
+    if (isEmpty()) {
+        *this = other;
+        return;
+    }
 
-    if (! _hash || _macro_count > (_hash_count >> 1)) {
-        rehash();
+    // merge the smaller table into the bigger one.
+    if (count() < other.count()) {
+        NodePtr root = other._root;
+        uniteNodes(root, _root, 0, /*keepExisting = */ true);
+        _root = root;
     } else {
-        const unsigned h = m->hashcode % _hash_count;
-        m->next = _hash[h];
-        _hash[h] = m;
+        uniteNodes(_root, other._root, 0, /*keepExisting = */ false);
     }
+}
+
+QList<Macro> MacroTable::macros() const
+{
+    QList<Macro> macros;
+    if (_root)
+        collectMacros(_root.data(), &macros);
+    return macros;
+}
+
+QList<QByteArray> MacroTable::macroNames() const
+{
+    QList<QByteArray> names;
+    if (_root)
+        collectMacroNames(_root.data(), &names);
+    return names;
+}
+
+unsigned MacroTable::hashCode(const QByteArray &s)
+{
+    unsigned hash_value = 0;
+
+    for (int i = 0; i < s.size (); ++i)
+        hash_value = (hash_value << 5) - hash_value + s.at (i);
+
+    return hash_value;
+}
+
+Environment::Environment()
+    : currentLine(0),
+      hide_next(false)
+{
+}
 
-    return m;
+Environment::~Environment()
+{
 }
 
-Macro *Environment::remove(const QByteArray &name)
+unsigned Environment::macroCount() const
+{
+    return _macros.count();
+}
+
+const Macro *Environment::bind(const Macro &__macro)
+{
+    Q_ASSERT(! __macro.name.isEmpty());
+
+    return _macros.insert(__macro);
+}
+
+const Macro *Environment::remove(const QByteArray &name)
 {
     Macro macro;
     macro.name = name;
@@ -128,6 +420,26 @@ Macro *Environment::remove(const QByteArray &name)
     return bind(macro);
 }
 
+void Environment::merge(const MacroTable &macros)
+{
+    _macros.unite(macros);
+}
+
+void Environment::hide(const Macro *macro)
+{
+    _hidden.append(macro);
+}
+
+void Environment::unhide(const Macro *macro)
+{
+    for (int i = _hidden.size() - 1; i != -1; --i) {
+        if (_hidden.at(i) == macro) {
+            _hidden.remove(i);
+            break;
+        }
+    }
+}
+
 bool Environment::isBuiltinMacro(const QByteArray &s) const
 {
     if (s.length() != 8)
@@ -192,45 +504,12 @@ bool Environment::isBuiltinMacro(const QByteArray &s) const
     return false;
 }
 
-Macro *Environment::resolve (const QByteArray &name) const
+const Macro *Environment::resolve (const QByteArray &name) const
 {
-    if (! _macros)
+    const Macro *macro = _macros.find(name);
+    if (! macro || macro->hidden)
         return 0;
-
-    Macro *it = _hash[hash_code (name) % _hash_count];
-    for (; it; it = it->next) {
-        if (it->name != name)
-            continue;
-        else if (it->hidden)
-            return 0;
-        else break;
-    }
-    return it;
-}
-
-unsigned Environment::hash_code (const QByteArray &s)
-{
-    unsigned hash_value = 0;
-
-    for (int i = 0; i < s.size (); ++i)
-        hash_value = (hash_value << 5) - hash_value + s.at (i);
-
-    return hash_value;
-}
-
-void Environment::rehash()
-{
-    if (_hash) {
-        free(_hash);
-        _hash_count <<= 1;
-    }
-
-    _hash = (Macro **) calloc(_hash_count, sizeof(Macro *));
-
-    for (Macro **it = firstMacro(); it != lastMacro(); ++it) {
-        Macro *m= *it;
-        const unsigned h = m->hashcode % _hash_count;
-        m->next = _hash[h];
-        _hash[h] = m;
-    }
+    else if (! _hidden.isEmpty() && _hidden.contains(macro))
+        return 0;
+    return macro;
 }
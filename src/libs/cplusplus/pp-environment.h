@@ -57,10 +57,46 @@
 
 #include <QVector>
 #include <QByteArray>
+#include <QList>
+#include <QExplicitlySharedDataPointer>
 
 namespace CPlusPlus {
 
 class Macro;
+class MacroTableNode;
+
+// A persistent set of macros, keyed by name. Copying a table is cheap, the
+// copies share their nodes until one of them is modified.
+class CPLUSPLUS_EXPORT MacroTable
+{
+public:
+    MacroTable();
+    MacroTable(const MacroTable &other);
+    ~MacroTable();
+
+    MacroTable &operator=(const MacroTable &other);
+
+    bool isEmpty() const;
+    unsigned count() const;
+
+    bool isSharedWith(const MacroTable &other) const;
+
+    const Macro *find(const QByteArray &name) const;
+    const Macro *insert(const Macro &macro);
+
+    // Adds the macros of \a other, replacing the macros with the same name.
+    void unite(const MacroTable &other);
+
+    QList<Macro> macros() const;
+
+    // The names of the macros that are not #undef'ed.
+    QList<QByteArray> macroNames() const;
+
+    static unsigned hashCode(const QByteArray &name);
+
+private:
+    QExplicitlySharedDataPointer<MacroTableNode> _root;
+};
 
 class CPLUSPLUS_EXPORT Environment
 {
@@ -69,29 +105,21 @@ public:
     ~Environment();
 
     unsigned macroCount() const;
-    Macro *macroAt(unsigned index) const;
 
-    Macro *bind(const Macro &macro);
-    Macro *remove(const QByteArray &name);
+    const Macro *bind(const Macro &macro);
+    const Macro *remove(const QByteArray &name);
 
-    Macro *resolve(const QByteArray &name) const;
+    const Macro *resolve(const QByteArray &name) const;
     bool isBuiltinMacro(const QByteArray &name) const;
 
-    const Macro *const *firstMacro() const
+    MacroTable macros() const
     { return _macros; }
 
-    Macro **firstMacro()
-    { return _macros; }
-
-    const Macro *const *lastMacro() const
-    { return _macros + _macro_count + 1; }
+    void merge(const MacroTable &macros);
 
-    Macro **lastMacro()
-    { return _macros + _macro_count + 1; }
-
-private:
-    static unsigned hash_code (const QByteArray &s);
-    void rehash();
+    // A macro is hidden while it's being expanded.
+    void hide(const Macro *macro);
+    void unhide(const Macro *macro);
 
 public:
     QByteArray currentFile;
@@ -99,11 +127,8 @@ public:
     bool hide_next;
 
 private:
-    Macro **_macros;
-    int _allocated_macros;
-    int _macro_count;
-    Macro **_hash;
-    int _hash_count;
+    MacroTable _macros;
+    QVector<const Macro *> _hidden;
 };
 
 } // namespace CPlusPlus
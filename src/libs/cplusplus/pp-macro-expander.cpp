@@ -197,7 +197,7 @@ const char *MacroExpander::operator () (const char *__first, const char *__last,
                 continue;
             }
 
-            Macro *macro = env.resolve (fast_name);
+            const Macro *macro = env.resolve (fast_name);
             if (! macro || macro->hidden || env.hide_next)
             {
                 if (fast_name.size () == 7 && fast_name [0] == 'd' && fast_name == "defined")
@@ -247,11 +247,11 @@ const char *MacroExpander::operator () (const char *__first, const char *__last,
 
             if (! macro->function_like)
             {
-                Macro *m = 0;
+                const Macro *m = 0;
 
                 if (! macro->definition.isEmpty())
                 {
-                    macro->hidden = true;
+                    env.hide(macro);
 
                     QByteArray __tmp;
                     __tmp.reserve (256);
@@ -277,7 +277,7 @@ const char *MacroExpander::operator () (const char *__first, const char *__last,
                             *__result += __tmp;
                     }
 
-                    macro->hidden = false;
+                    env.unhide(macro);
                 }
 
                 if (! m)
@@ -333,9 +333,9 @@ const char *MacroExpander::operator () (const char *__first, const char *__last,
 
             pp_frame frame (macro, actuals);
             MacroExpander expand_macro (env, &frame);
-            macro->hidden = true;
+            env.hide(macro);
             expand_macro (macro->definition.constBegin (), macro->definition.constEnd (), __result);
-            macro->hidden = false;
+            env.unhide(macro);
             generated_lines += expand_macro.lines;
         }
         else
@@ -346,7 +346,7 @@ const char *MacroExpander::operator () (const char *__first, const char *__last,
 }
 
 const char *MacroExpander::skip_argument_variadics (QVector<QByteArray> const &__actuals,
-                                                    Macro *__macro,
+                                                    const Macro *__macro,
                                                     const char *__first, const char *__last)
 {
     const char *arg_end = skip_argument (__first, __last);
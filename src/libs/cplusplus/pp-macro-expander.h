@@ -57,10 +57,10 @@ namespace CPlusPlus {
 
     struct pp_frame
     {
-        Macro *expanding_macro;
+        const Macro *expanding_macro;
         const QVector<QByteArray> actuals;
 
-        pp_frame (Macro *expanding_macro, const QVector<QByteArray> &actuals)
+        pp_frame (const Macro *expanding_macro, const QVector<QByteArray> &actuals)
             : expanding_macro (expanding_macro),
               actuals (actuals)
         { }
@@ -89,7 +89,7 @@ namespace CPlusPlus {
                                  QByteArray *result);
 
         const char *skip_argument_variadics (const QVector<QByteArray> &actuals,
-                                             Macro *macro,
+                                             const Macro *macro,
                                              const char *first, const char *last);
 
     public: // attributes
@@ -69,7 +69,6 @@ public:
     QVector<QByteArray> formals;
     QByteArray fileName;
     int line;
-    Macro *next;
     unsigned hashcode;
 
     union
@@ -86,7 +85,6 @@ public:
 
     inline Macro():
             line(0),
-            next(0),
             hashcode(0),
             state(0)
     { }
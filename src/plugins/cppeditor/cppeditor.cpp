@@ -46,6 +46,7 @@
 #include <Literals.h>
 #include <Semantic.h>
 #include <cplusplus/ExpressionUnderCursor.h>
+#include <cplusplus/FindUsages.h>
 #include <cplusplus/LookupContext.h>
 #include <cplusplus/Overview.h>
 #include <cplusplus/OverviewModel.h>
@@ -58,6 +59,9 @@
 #include <coreplugin/actionmanager/actionmanagerinterface.h>
 #include <coreplugin/editormanager/ieditor.h>
 #include <coreplugin/editormanager/editormanager.h>
+#include <coreplugin/progressmanager/progressmanagerinterface.h>
+#include <find/searchresultwindow.h>
+#include <find/textfindconstants.h>
 #include <projectexplorer/projectexplorerconstants.h>
 #include <texteditor/basetextdocument.h>
 #include <texteditor/fontsettings.h>
@@ -66,6 +70,7 @@
 #include <indenter.h>
 
 #include <QtCore/QFileInfo>
+#include <QtCore/QSet>
 #include <QtCore/QTextStream>
 #include <QtCore/QDebug>
 #include <QtCore/QTime>
@@ -178,10 +183,16 @@ CPPEditor::CPPEditor(QWidget *parent) :
         connect(m_modelManager, SIGNAL(documentUpdated(CPlusPlus::Document::Ptr)),
                 this, SLOT(onDocumentUpdated(CPlusPlus::Document::Ptr)));
     }
+
+    m_usagesWatcher.setPendingResultsLimit(1);
+    connect(&m_usagesWatcher, SIGNAL(resultReadyAt(int)), this, SLOT(displayUsage(int)));
+    connect(&m_usagesWatcher, SIGNAL(finished()), this, SLOT(findUsagesFinished()));
 }
 
 CPPEditor::~CPPEditor()
 {
+    // the search holds its own references to the documents.
+    m_usagesWatcher.cancel();
 }
 
 TextEditor::BaseTextEditorEditable *CPPEditor::createEditableInterface()
@@ -427,9 +438,7 @@ void CPPEditor::switchDeclarationDefinition()
     if (!m_modelManager)
         return;
 
-    const Snapshot snapshot = m_modelManager->snapshot();
-
-    Document::Ptr doc = snapshot.value(file()->fileName());
+    Document::Ptr doc = m_modelManager->documentWithFunctionBodies(file()->fileName(), line);
     if (!doc)
         return;
     Symbol *lastSymbol = doc->findSymbolAt(line, column);
@@ -448,6 +457,7 @@ void CPPEditor::switchDeclarationDefinition()
     if (f) {
         TypeOfExpression typeOfExpression;
         typeOfExpression.setSnapshot(m_modelManager->snapshot());
+        typeOfExpression.setVisibleScopesCache(m_modelManager->visibleScopesCache());
         QList<TypeOfExpression::Result> resolvedSymbols = typeOfExpression(QString(), doc, lastSymbol);
         const LookupContext &context = typeOfExpression.lookupContext();
 
@@ -476,12 +486,10 @@ void CPPEditor::jumpToDefinition()
     if (!m_modelManager)
         return;
 
-    const Snapshot snapshot = m_modelManager->snapshot();
-
     // Find the last symbol up to the cursor position
     int line = 0, column = 0;
     convertPosition(position(), &line, &column);
-    Document::Ptr doc = snapshot.value(file()->fileName());
+    Document::Ptr doc = m_modelManager->documentWithFunctionBodies(file()->fileName(), line);
     if (!doc)
         return;
 
@@ -508,6 +516,7 @@ void CPPEditor::jumpToDefinition()
     // Evaluate the type of the expression
     TypeOfExpression typeOfExpression;
     typeOfExpression.setSnapshot(m_modelManager->snapshot());
+    typeOfExpression.setVisibleScopesCache(m_modelManager->visibleScopesCache());
     QList<TypeOfExpression::Result> resolvedSymbols =
             typeOfExpression(expression, doc, lastSymbol);
 
@@ -547,6 +556,85 @@ void CPPEditor::jumpToDefinition()
     }
 }
 
+void CPPEditor::findUsages()
+{
+    if (!m_modelManager)
+        return;
+
+    int line = 0, column = 0;
+    convertPosition(position(), &line, &column);
+    Document::Ptr doc = m_modelManager->documentWithFunctionBodies(file()->fileName(), line);
+    if (!doc)
+        return;
+
+    Symbol *lastSymbol = doc->findSymbolAt(line, column);
+    if (!lastSymbol)
+        return;
+
+    QTextCursor tc = textCursor();
+    tc.setPosition(endOfNameUnderCursor());
+    ExpressionUnderCursor expressionUnderCursor;
+    const QString expression = expressionUnderCursor(tc);
+
+    TypeOfExpression typeOfExpression;
+    typeOfExpression.setSnapshot(m_modelManager->snapshot());
+    typeOfExpression.setVisibleScopesCache(m_modelManager->visibleScopesCache());
+    QList<TypeOfExpression::Result> resolvedSymbols =
+            typeOfExpression(expression, doc, lastSymbol);
+
+    Symbol *symbol = 0;
+    if (!resolvedSymbols.isEmpty())
+        symbol = resolvedSymbols.first().second;
+    if (!symbol)
+        return;
+
+    Find::SearchResultWindow *resultWindow =
+            m_core->pluginManager()->getObject<Find::SearchResultWindow>();
+    if (!resultWindow)
+        return;
+
+    m_usagesWatcher.cancel();
+    m_usagesWatcher.setFuture(QFuture<Usage>());
+    resultWindow->clearContents();
+    resultWindow->popup(true);
+
+    m_usagesWatcher.setFuture(m_modelManager->findUsages(doc, symbol));
+    m_core->progressManager()->addTask(m_usagesWatcher.future(), tr("Searching"),
+                                       Find::Constants::TASK_SEARCH);
+}
+
+void CPPEditor::displayUsage(int index)
+{
+    Find::SearchResultWindow *resultWindow =
+            m_core->pluginManager()->getObject<Find::SearchResultWindow>();
+    if (!resultWindow)
+        return;
+
+    const Usage usage = m_usagesWatcher.future().resultAt(index);
+    Find::ResultWindowItem *item = resultWindow->addResult(usage.fileName, usage.line,
+                                                           usage.lineText, usage.column,
+                                                           usage.length);
+    if (item)
+        connect(item, SIGNAL(activated(const QString&,int,int)),
+                this, SLOT(openUsage(const QString&,int,int)));
+}
+
+void CPPEditor::findUsagesFinished()
+{
+    if (m_usagesWatcher.isCanceled())
+        return;
+
+    Find::SearchResultWindow *resultWindow =
+            m_core->pluginManager()->getObject<Find::SearchResultWindow>();
+    if (resultWindow && resultWindow->numberOfResults() == 0)
+        resultWindow->showNoMatchesFound();
+}
+
+void CPPEditor::openUsage(const QString &fileName, int line, int column)
+{
+    openCppEditorAt(fileName, line, column);
+}
+
 Symbol *CPPEditor::findDefinition(Symbol *lastSymbol)
 {
     // Currently only functions are supported
@@ -576,11 +664,36 @@ Symbol *CPPEditor::findDefinition(Symbol *lastSymbol)
     QualifiedNameId *q = control.qualifiedNameId(&qualifiedName[0], qualifiedName.size());
     LookupContext context(&control);
 
+    // Look at the documents defining a function with that name first; the
+    // definitions qualified through a using directive are indexed under
+    // another name, so fall back to all the documents.
     const Snapshot documents = m_modelManager->snapshot();
+    QList<Document::Ptr> candidates;
+    QSet<QString> processed;
+    Overview overview;
+    foreach (const CppTools::CppModelManagerInterface::SymbolLocation &location,
+             m_modelManager->findSymbols(overview.prettyName(q))) {
+        if (location.kind != CppTools::CppModelManagerInterface::SymbolLocation::Function
+                || processed.contains(location.fileName))
+            continue;
+        processed.insert(location.fileName);
+        if (Document::Ptr doc = documents.value(location.fileName))
+            candidates.append(doc);
+    }
+
+    if (Symbol *symbol = findDefinition(lastSymbol, q, candidates, &context))
+        return symbol;
+    return findDefinition(lastSymbol, q, documents.values(), &context);
+}
+
+Symbol *CPPEditor::findDefinition(Symbol *lastSymbol, QualifiedNameId *q,
+                                  const QList<Document::Ptr> &documents,
+                                  LookupContext *context)
+{
     foreach (Document::Ptr doc, documents) {
         QList<Scope *> visibleScopes;
         visibleScopes.append(doc->globalSymbols());
-        visibleScopes = context.expand(visibleScopes);
+        visibleScopes = context->expand(visibleScopes);
         //qDebug() << "** doc:" << doc->fileName() << "visible scopes:" << visibleScopes.count();
         foreach (Scope *visibleScope, visibleScopes) {
             Symbol *symbol = 0;
@@ -36,7 +36,9 @@
 
 #include "cppeditorenums.h"
 #include <cplusplus/CppDocument.h>
+#include <cplusplus/FindUsages.h>
 #include <texteditor/basetexteditor.h>
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QObject>
 
 QT_BEGIN_NAMESPACE
@@ -50,7 +52,9 @@ class ICore;
 }
 
 namespace CPlusPlus {
+class LookupContext;
 class OverviewModel;
+class QualifiedNameId;
 class Symbol;
 }
 
@@ -98,6 +102,7 @@ public slots:
     virtual void setFontSettings(const TextEditor::FontSettings &);
     void switchDeclarationDefinition();
     void jumpToDefinition();
+    void findUsages();
 
     void moveToPreviousToken();
     void moveToNextToken();
@@ -118,9 +123,16 @@ private slots:
     void updateMethodBoxIndex();
     void updateMethodBoxToolTip();
     void onDocumentUpdated(CPlusPlus::Document::Ptr doc);
+    void displayUsage(int index);
+    void findUsagesFinished();
+    void openUsage(const QString &fileName, int line, int column);
 
 private:
     CPlusPlus::Symbol *findDefinition(CPlusPlus::Symbol *symbol);
+    CPlusPlus::Symbol *findDefinition(CPlusPlus::Symbol *symbol,
+                                      CPlusPlus::QualifiedNameId *q,
+                                      const QList<CPlusPlus::Document::Ptr> &documents,
+                                      CPlusPlus::LookupContext *context);
     virtual void indentBlock(QTextDocument *doc, QTextBlock block, QChar typedChar);
 
     TextEditor::ITextEditor *openCppEditorAt(const QString &fileName, int line,
@@ -142,6 +154,7 @@ private:
     QList<int> m_contexts;
     QComboBox *m_methodCombo;
     CPlusPlus::OverviewModel *m_overviewModel;
+    QFutureWatcher<CPlusPlus::Usage> m_usagesWatcher;
 };
 
 } // namespace Internal
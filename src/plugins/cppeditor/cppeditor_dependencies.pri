@@ -4,3 +4,4 @@ include(../../plugins/texteditor/texteditor.pri)
 include(../../../shared/indenter/indenter.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
 include(../../plugins/cpptools/cpptools.pri)
+include(../../plugins/find/find.pri)
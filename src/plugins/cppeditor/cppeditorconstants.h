@@ -43,6 +43,7 @@ const char * const C_CPPEDITOR  = "C++ Editor";
 const char * const CPPEDITOR_KIND = "C++ Editor";
 const char * const SWITCH_DECLARATION_DEFINITION = "CppEditor.SwitchDeclarationDefinition";
 const char * const JUMP_TO_DEFINITION = "CppEditor.JumpToDefinition";
+const char * const FIND_USAGES = "CppEditor.FindUsages";
 
 const char * const HEADER_FILE_TYPE = "CppHeaderFiles";
 const char * const SOURCE_FILE_TYPE = "CppSourceFiles";
@@ -205,6 +205,15 @@ bool CppPlugin::initialize(const QStringList & /*arguments*/, QString *errorMess
     am->actionContainer(CppEditor::Constants::M_CONTEXT)->addAction(cmd);
     am->actionContainer(CppTools::Constants::M_TOOLS_CPP)->addAction(cmd);
 
+    QAction *findUsages = new QAction(tr("Find Usages"), this);
+    cmd = am->registerAction(findUsages,
+        Constants::FIND_USAGES, context);
+    cmd->setDefaultKeySequence(QKeySequence(tr("Ctrl+Shift+U")));
+    connect(findUsages, SIGNAL(triggered()),
+            this, SLOT(findUsages()));
+    am->actionContainer(CppEditor::Constants::M_CONTEXT)->addAction(cmd);
+    am->actionContainer(CppTools::Constants::M_TOOLS_CPP)->addAction(cmd);
+
     QAction *switchDeclarationDefinition = new QAction(tr("Switch between Method Declaration/Definition"), this);
     cmd = am->registerAction(switchDeclarationDefinition,
         Constants::SWITCH_DECLARATION_DEFINITION, context);
@@ -256,4 +265,12 @@ void CppPlugin::jumpToDefinition()
     }
 }
 
+void CppPlugin::findUsages()
+{
+    CPPEditor *editor = qobject_cast<CPPEditor*>(m_core->editorManager()->currentEditor()->widget());
+    if (editor) {
+        editor->findUsages();
+    }
+}
+
 Q_EXPORT_PLUGIN(CppPlugin)
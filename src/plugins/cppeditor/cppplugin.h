@@ -76,6 +76,7 @@ public:
 private slots:
     void switchDeclarationDefinition();
     void jumpToDefinition();
+    void findUsages();
 
 private:
     friend class CppPluginEditorFactory;
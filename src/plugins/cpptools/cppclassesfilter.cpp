@@ -41,8 +41,8 @@ CppClassesFilter::CppClassesFilter(CppModelManager *manager, Core::EditorManager
     setShortcutString("c");
     setIncludedByDefault(false);
 
-    search.setSymbolsToSearchFor(SearchSymbols::Classes);
-    search.setSeparateScope(true);
+    setSymbolsToSearchFor(SearchSymbols::Classes);
+    setSeparateScope(true);
 }
 
 CppClassesFilter::~CppClassesFilter()
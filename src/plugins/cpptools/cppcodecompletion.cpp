@@ -52,6 +52,7 @@
 #include <cplusplus/Overview.h>
 #include <cplusplus/ExpressionUnderCursor.h>
 #include <cplusplus/TokenUnderCursor.h>
+#include <cplusplus/TypeOfExpression.h>
 
 #include <coreplugin/icore.h>
 #include <coreplugin/editormanager/editormanager.h>
@@ -59,6 +60,7 @@
 #include <texteditor/itexteditable.h>
 #include <utils/qtcassert.h>
 #include <texteditor/basetexteditor.h>
+#include <qtconcurrent/runextensions.h>
 
 #include <QtCore/QDebug>
 #include <QtCore/QMap>
@@ -96,10 +98,12 @@ private:
     Function *m_item;
 };
 
+class CompletionJob;
+
 class ConvertToCompletionItem: protected NameVisitor
 {
-    // The completion collector.
-    CppCodeCompletion *_collector;
+    // The completion job.
+    CompletionJob *_job;
 
     // The completion item.
     TextEditor::CompletionItem _item;
@@ -111,8 +115,8 @@ class ConvertToCompletionItem: protected NameVisitor
     Overview overview;
 
 public:
-    ConvertToCompletionItem(CppCodeCompletion *collector)
-        : _collector(collector),
+    ConvertToCompletionItem(CompletionJob *job)
+        : _job(job),
           _item(0),
           _symbol(0)
     { }
@@ -146,13 +150,7 @@ protected:
         return previousItem;
     }
 
-    TextEditor::CompletionItem newCompletionItem(Name *name)
-    {
-        TextEditor::CompletionItem item(_collector);
-        item.m_text = overview.prettyName(name);
-        item.m_icon = _collector->iconForSymbol(_symbol);
-        return item;
-    }
+    TextEditor::CompletionItem newCompletionItem(Name *name);
 
     virtual void visit(NameId *name)
     { _item = newCompletionItem(name); }
@@ -176,6 +174,99 @@ protected:
     { _item = newCompletionItem(name->unqualifiedNameId()); }
 };
 
+/*
+    Computes the completions of an expression in a worker thread. The job
+    only looks at the document and the snapshot it is given; the editor is
+    left alone until the completions are delivered on the GUI thread.
+*/
+class CompletionJob
+{
+public:
+    CompletionJob(CppCodeCompletion *collector, const Icons &icons,
+                  VisibleScopesCache *visibleScopesCache,
+                  Document::Ptr thisDocument, const Snapshot &snapshot,
+                  const FunctionBodyParser &parseFunctionBodies,
+                  const QString &expression, unsigned completionOperator,
+                  unsigned line, unsigned column);
+
+    void run(QFutureInterface<void> &future);
+
+    CppCodeCompletion *collector() const
+    { return m_collector; }
+
+    QIcon iconForSymbol(Symbol *symbol) const
+    { return m_icons.iconForSymbol(symbol); }
+
+    QList<TextEditor::CompletionItem> completions() const
+    { return m_completions; }
+
+    // Whether the '.' in front of the completion has to be replaced with '->'.
+    bool replaceDotWithArrow() const
+    { return m_replaceDotWithArrow; }
+
+private:
+    bool isCanceled() const
+    { return m_future && m_future->isCanceled(); }
+
+    void addKeywords();
+    void addMacros(const LookupContext &context);
+    void addCompletionItem(Symbol *symbol);
+
+    bool completeFunction(FullySpecifiedType exprTy,
+                          const QList<TypeOfExpression::Result> &,
+                          const LookupContext &context);
+
+    bool completeMember(FullySpecifiedType exprTy,
+                        const QList<TypeOfExpression::Result> &,
+                        const LookupContext &context);
+
+    bool completeScope(FullySpecifiedType exprTy,
+                       const QList<TypeOfExpression::Result> &,
+                       const LookupContext &context);
+
+    void completeNamespace(const QList<Symbol *> &candidates,
+                           const LookupContext &context);
+
+    void completeClass(const QList<Symbol *> &candidates,
+                       const LookupContext &context,
+                       bool staticLookup = true);
+
+    bool completeQtMethod(FullySpecifiedType exprTy,
+                          const QList<TypeOfExpression::Result> &,
+                          const LookupContext &context,
+                          bool wantSignals);
+
+    bool completeSignal(FullySpecifiedType exprTy,
+                        const QList<TypeOfExpression::Result> &results,
+                        const LookupContext &context)
+    { return completeQtMethod(exprTy, results, context, true); }
+
+    bool completeSlot(FullySpecifiedType exprTy,
+                      const QList<TypeOfExpression::Result> &results,
+                      const LookupContext &context)
+    { return completeQtMethod(exprTy, results, context, false); }
+
+    CppCodeCompletion *m_collector;
+    Icons m_icons;
+    Document::Ptr m_thisDocument;
+    FunctionBodyParser m_parseFunctionBodies;
+    QString m_expression;
+    unsigned m_completionOperator;
+    unsigned m_line;
+    unsigned m_column;
+    bool m_replaceDotWithArrow;
+    QFutureInterface<void> *m_future;
+
+    Overview overview;
+    TypeOfExpression typeOfExpression;
+    QList<TextEditor::CompletionItem> m_completions;
+};
+
+static void runCompletionJob(QFutureInterface<void> &future, QSharedPointer<CompletionJob> job)
+{
+    job->run(future);
+}
+
 
 } // namespace Internal
 } // namespace CppTools
@@ -184,6 +275,14 @@ protected:
 
 using namespace CppTools::Internal;
 
+TextEditor::CompletionItem ConvertToCompletionItem::newCompletionItem(Name *name)
+{
+    TextEditor::CompletionItem item(_job->collector());
+    item.m_text = overview.prettyName(name);
+    item.m_icon = _job->iconForSymbol(_symbol);
+    return item;
+}
+
 FunctionArgumentWidget::FunctionArgumentWidget(Core::ICore *core)
     : m_item(0)
 {
@@ -315,8 +414,20 @@ CppCodeCompletion::CppCodeCompletion(CppModelManager *manager, Core::ICore *core
       m_core(core),
       m_manager(manager),
       m_forcedCompletion(false),
-      m_completionOperator(T_EOF_SYMBOL)
-{ }
+      m_completionOperator(T_EOF_SYMBOL),
+      m_completionPending(false),
+      m_completionIndexUpToDate(false)
+{
+    connect(&m_completionJobWatcher, SIGNAL(finished()), this, SLOT(completionJobFinished()));
+}
+
+CppCodeCompletion::~CppCodeCompletion()
+{
+    // The jobs refer to the collector
+    cancelCompletionJob();
+    foreach (QFuture<void> future, m_canceledJobs)
+        future.waitForFinished();
+}
 
 QIcon CppCodeCompletion::iconForSymbol(Symbol *symbol) const
 { return m_icons.iconForSymbol(symbol); }
@@ -391,6 +502,8 @@ bool CppCodeCompletion::triggersCompletion(TextEditor::ITextEditable *editor)
 
 int CppCodeCompletion::startCompletion(TextEditor::ITextEditable *editor)
 {
+    cancelCompletionJob();
+
     TextEditor::BaseTextEditor *edit = qobject_cast<TextEditor::BaseTextEditor *>(editor->widget());
     if (! edit)
         return -1;
@@ -398,6 +511,7 @@ int CppCodeCompletion::startCompletion(TextEditor::ITextEditable *editor)
     m_editor = editor;
     m_startPosition = findStartOfName(editor);
     m_completionOperator = T_EOF_SYMBOL;
+    m_completionIndexUpToDate = false;
 
     int endOfExpression = m_startPosition;
 
@@ -435,70 +549,171 @@ int CppCodeCompletion::startCompletion(TextEditor::ITextEditable *editor)
         //qDebug() << "***** expression:" << expression;
 
     const Snapshot snapshot = m_manager->snapshot();
+    Document::Ptr thisDocument = snapshot.value(fileName);
+    if (! thisDocument)
+        return -1;
 
-    if (Document::Ptr thisDocument = snapshot.value(fileName)) {
-        Symbol *symbol = thisDocument->findSymbolAt(line, column);
+    // The function body at the cursor is parsed by the completion job, if
+    // it was skipped.
+    FunctionBodyParser parseFunctionBodies;
+    if (thisDocument->isFunctionBodySkippedAt(line))
+        parseFunctionBodies = m_manager->functionBodyParser();
+
+    // The document and the snapshot are not modified once they are published by
+    // the model manager, so the completions can be computed in a worker thread.
+    m_completionJob = QSharedPointer<CompletionJob>(
+            new CompletionJob(this, m_icons, m_manager->visibleScopesCache(),
+                              thisDocument, snapshot, parseFunctionBodies, expression,
+                              m_completionOperator, line, column));
+    m_completionPending = true;
+    m_completionJobWatcher.setFuture(QtConcurrent::run(runCompletionJob, m_completionJob));
+
+    return m_startPosition;
+}
 
-        typeOfExpression.setSnapshot(m_manager->snapshot());
+bool CppCodeCompletion::completionsPending() const
+{
+    return m_completionPending;
+}
 
-        QList<TypeOfExpression::Result> resolvedTypes = typeOfExpression(expression, thisDocument, symbol,
-                                                                         TypeOfExpression::Preprocess);
-        LookupContext context = typeOfExpression.lookupContext();
+void CppCodeCompletion::completionJobFinished()
+{
+    if (! m_completionPending || m_completionJobWatcher.isCanceled())
+        return;
 
-        if (!typeOfExpression.expressionAST() && (! m_completionOperator ||
-                                                    m_completionOperator == T_COLON_COLON)) {
-            if (!m_completionOperator) {
-                addKeywords();
-                addMacros(context);
-            }
+    m_completionPending = false;
+    m_completions = m_completionJob->completions();
 
-            const QList<Scope *> scopes = context.expand(context.visibleScopes());
-            foreach (Scope *scope, scopes) {
-                for (unsigned i = 0; i < scope->symbolCount(); ++i) {
-                    addCompletionItem(scope->symbolAt(i));
-                }
-            }
-            return m_startPosition;
+    if (m_completionJob->replaceDotWithArrow() && m_editor) {
+        const int position = m_editor->position();
+
+        if (position >= m_startPosition
+                && m_editor->characterAt(m_startPosition - 1) == QLatin1Char('.')) {
+            // Replace . with ->
+            m_editor->setCurPos(m_startPosition - 1);
+            m_editor->replace(1, QLatin1String("->"));
+            m_editor->setCurPos(position + 1);
+            ++m_startPosition;
         }
+    }
+
+    emit completionsReady(m_startPosition);
+}
+
+void CppCodeCompletion::cancelCompletionJob()
+{
+    m_completionPending = false;
+
+    QFuture<void> future = m_completionJobWatcher.future();
+    if (future.isRunning()) {
+        future.cancel();
+        m_canceledJobs.append(future);
+    }
+
+    QMutableListIterator<QFuture<void> > it(m_canceledJobs);
+    while (it.hasNext()) {
+        if (it.next().isFinished())
+            it.remove();
+    }
+}
 
-        // qDebug() << "found" << resolvedTypes.count() << "symbols for expression:" << expression;
+CompletionJob::CompletionJob(CppCodeCompletion *collector, const Icons &icons,
+                             VisibleScopesCache *visibleScopesCache,
+                             Document::Ptr thisDocument, const Snapshot &snapshot,
+                             const FunctionBodyParser &parseFunctionBodies,
+                             const QString &expression, unsigned completionOperator,
+                             unsigned line, unsigned column)
+    : m_collector(collector),
+      m_icons(icons),
+      m_thisDocument(thisDocument),
+      m_parseFunctionBodies(parseFunctionBodies),
+      m_expression(expression),
+      m_completionOperator(completionOperator),
+      m_line(line),
+      m_column(column),
+      m_replaceDotWithArrow(false),
+      m_future(0)
+{
+    typeOfExpression.setVisibleScopesCache(visibleScopesCache);
+    typeOfExpression.setSnapshot(snapshot);
+}
 
-        if (resolvedTypes.isEmpty() && (m_completionOperator == T_SIGNAL ||
-                                        m_completionOperator == T_SLOT)) {
-            // Apply signal/slot completion on 'this'
-            expression = QLatin1String("this");
-            resolvedTypes = typeOfExpression(expression, thisDocument, symbol);
-            context = typeOfExpression.lookupContext();
+void CompletionJob::run(QFutureInterface<void> &future)
+{
+    m_future = &future;
+    typeOfExpression.setFuture(&future);
+
+    if (m_thisDocument->isFunctionBodySkippedAt(m_line)) {
+        if (Document::Ptr doc = m_parseFunctionBodies(m_thisDocument->fileName()))
+            m_thisDocument = doc;
+
+        if (isCanceled())
+            return;
+    }
+
+    Symbol *symbol = m_thisDocument->findSymbolAt(m_line, m_column);
+
+    QList<TypeOfExpression::Result> resolvedTypes = typeOfExpression(m_expression, m_thisDocument, symbol,
+                                                                     TypeOfExpression::Preprocess);
+    LookupContext context = typeOfExpression.lookupContext();
+
+    if (isCanceled())
+        return;
+
+    if (!typeOfExpression.expressionAST() && (! m_completionOperator ||
+                                                m_completionOperator == T_COLON_COLON)) {
+        if (!m_completionOperator) {
+            addKeywords();
+            addMacros(context);
         }
 
-        if (! resolvedTypes.isEmpty()) {
-            FullySpecifiedType exprTy = resolvedTypes.first().first;
-
-            if (exprTy->isReferenceType())
-                exprTy = exprTy->asReferenceType()->elementType();
-
-            if (m_completionOperator == T_LPAREN && completeFunction(exprTy, resolvedTypes, context)) {
-                return m_startPosition;
-            } if ((m_completionOperator == T_DOT || m_completionOperator == T_ARROW) &&
-                      completeMember(exprTy, resolvedTypes, context)) {
-                return m_startPosition;
-            } else if (m_completionOperator == T_COLON_COLON && completeScope(exprTy, resolvedTypes, context)) {
-                return m_startPosition;
-            } else if (m_completionOperator == T_SIGNAL && completeSignal(exprTy, resolvedTypes, context)) {
-                return m_startPosition;
-            } else if (m_completionOperator == T_SLOT && completeSlot(exprTy, resolvedTypes, context)) {
-                return m_startPosition;
+        const QList<Scope *> scopes = context.expand(context.visibleScopes());
+        foreach (Scope *scope, scopes) {
+            if (isCanceled())
+                return;
+
+            for (unsigned i = 0; i < scope->symbolCount(); ++i) {
+                addCompletionItem(scope->symbolAt(i));
             }
         }
+        return;
     }
 
-    // nothing to do.
-    return -1;
+    // qDebug() << "found" << resolvedTypes.count() << "symbols for expression:" << m_expression;
+
+    if (resolvedTypes.isEmpty() && (m_completionOperator == T_SIGNAL ||
+                                    m_completionOperator == T_SLOT)) {
+        // Apply signal/slot completion on 'this'
+        if (isCanceled())
+            return;
+
+        resolvedTypes = typeOfExpression(QLatin1String("this"), m_thisDocument, symbol);
+        context = typeOfExpression.lookupContext();
+    }
+
+    if (resolvedTypes.isEmpty() || isCanceled())
+        return;
+
+    FullySpecifiedType exprTy = resolvedTypes.first().first;
+
+    if (exprTy->isReferenceType())
+        exprTy = exprTy->asReferenceType()->elementType();
+
+    if (m_completionOperator == T_LPAREN)
+        completeFunction(exprTy, resolvedTypes, context);
+    else if (m_completionOperator == T_DOT || m_completionOperator == T_ARROW)
+        completeMember(exprTy, resolvedTypes, context);
+    else if (m_completionOperator == T_COLON_COLON)
+        completeScope(exprTy, resolvedTypes, context);
+    else if (m_completionOperator == T_SIGNAL)
+        completeSignal(exprTy, resolvedTypes, context);
+    else if (m_completionOperator == T_SLOT)
+        completeSlot(exprTy, resolvedTypes, context);
 }
 
-bool CppCodeCompletion::completeFunction(FullySpecifiedType exprTy,
-                                         const QList<TypeOfExpression::Result> &resolvedTypes,
-                                         const LookupContext &)
+bool CompletionJob::completeFunction(FullySpecifiedType exprTy,
+                                     const QList<TypeOfExpression::Result> &resolvedTypes,
+                                     const LookupContext &)
 {
     ConvertToCompletionItem toCompletionItem(this);
     Overview o;
@@ -542,9 +757,9 @@ bool CppCodeCompletion::completeFunction(FullySpecifiedType exprTy,
     return ! m_completions.isEmpty();
 }
 
-bool CppCodeCompletion::completeMember(FullySpecifiedType,
-                                       const QList<TypeOfExpression::Result> &results,
-                                       const LookupContext &context)
+bool CompletionJob::completeMember(FullySpecifiedType,
+                                   const QList<TypeOfExpression::Result> &results,
+                                   const LookupContext &context)
 {
     QTC_ASSERT(!results.isEmpty(), return false);
 
@@ -566,11 +781,17 @@ bool CppCodeCompletion::completeMember(FullySpecifiedType,
                     context.resolveClass(className, context.visibleScopes(p));
 
             foreach (Symbol *classObject, candidates) {
+                if (isCanceled())
+                    return false;
+
                 const QList<TypeOfExpression::Result> overloads =
                         resolveExpression.resolveArrowOperator(p, namedTy,
                                                                classObject->asClass());
 
                 foreach (TypeOfExpression::Result r, overloads) {
+                    if (isCanceled())
+                        return false;
+
                     FullySpecifiedType ty = r.first;
                     Function *funTy = ty->asFunction();
                     if (! funTy)
@@ -615,11 +836,8 @@ bool CppCodeCompletion::completeMember(FullySpecifiedType,
 
         NamedType *namedTy = 0;
         if (PointerType *ptrTy = ty->asPointerType()) {
-            // Replace . with ->
-            int length = m_editor->position() - m_startPosition + 1;
-            m_editor->setCurPos(m_startPosition - 1);
-            m_editor->replace(length, QLatin1String("->"));
-            m_startPosition++;
+            // The . is replaced with -> when the completions are delivered
+            m_replaceDotWithArrow = true;
             namedTy = ptrTy->elementType()->asNamedType();
         } else {
             namedTy = ty->asNamedType();
@@ -642,6 +860,9 @@ bool CppCodeCompletion::completeMember(FullySpecifiedType,
         }
     }
 
+    if (isCanceled())
+        return false;
+
     completeClass(classObjectCandidates, context, /*static lookup = */ false);
     if (! m_completions.isEmpty())
         return true;
@@ -649,9 +870,9 @@ bool CppCodeCompletion::completeMember(FullySpecifiedType,
     return false;
 }
 
-bool CppCodeCompletion::completeScope(FullySpecifiedType exprTy,
-                                      const QList<TypeOfExpression::Result> &resolvedTypes,
-                                      const LookupContext &context)
+bool CompletionJob::completeScope(FullySpecifiedType exprTy,
+                                  const QList<TypeOfExpression::Result> &resolvedTypes,
+                                  const LookupContext &context)
 {
     // Search for a class or a namespace.
     foreach (TypeOfExpression::Result p, resolvedTypes) {
@@ -680,55 +901,40 @@ bool CppCodeCompletion::completeScope(FullySpecifiedType exprTy,
     return ! m_completions.isEmpty();
 }
 
-void CppCodeCompletion::addKeywords()
+void CompletionJob::addKeywords()
 {
     // keyword completion items.
     for (int i = T_FIRST_KEYWORD; i < T_FIRST_QT_KEYWORD; ++i) {
-        TextEditor::CompletionItem item(this);
+        TextEditor::CompletionItem item(m_collector);
         item.m_text = QLatin1String(Token::name(i));
         item.m_icon = m_icons.keywordIcon();
         m_completions.append(item);
     }
 }
 
-void CppCodeCompletion::addMacros(const LookupContext &context)
+void CompletionJob::addMacros(const LookupContext &context)
 {
-    // macro completion items.
-    QSet<QByteArray> macroNames;
-    QSet<QString> processed;
-    QList<QString> todo;
-    todo.append(context.thisDocument()->fileName());
-    while (! todo.isEmpty()) {
-        QString fn = todo.last();
-        todo.removeLast();
-        if (processed.contains(fn))
-            continue;
-        processed.insert(fn);
-        if (Document::Ptr doc = context.document(fn)) {
-            foreach (const Macro macro, doc->definedMacros()) {
-                macroNames.insert(macro.name);
-            }
-            todo += doc->includedFiles();
-        }
-    }
+    // macro completion items, the macro table of the document holds the
+    // macros of its includes too.
+    const QSet<QByteArray> macroNames = context.thisDocument()->macroNames();
 
     foreach (const QByteArray macroName, macroNames) {
-        TextEditor::CompletionItem item(this);
+        TextEditor::CompletionItem item(m_collector);
         item.m_text = QString::fromLatin1(macroName.constData(), macroName.length());
         item.m_icon = m_icons.macroIcon();
         m_completions.append(item);
     }
 }
 
-void CppCodeCompletion::addCompletionItem(Symbol *symbol)
+void CompletionJob::addCompletionItem(Symbol *symbol)
 {
     ConvertToCompletionItem toCompletionItem(this);
     if (TextEditor::CompletionItem item = toCompletionItem(symbol))
         m_completions.append(item);
 }
 
-void CppCodeCompletion::completeNamespace(const QList<Symbol *> &candidates,
-                                          const LookupContext &context)
+void CompletionJob::completeNamespace(const QList<Symbol *> &candidates,
+                                      const LookupContext &context)
 {
     QList<Scope *> todo;
     QList<Scope *> visibleScopes = context.visibleScopes();
@@ -738,6 +944,9 @@ void CppCodeCompletion::completeNamespace(const QList<Symbol *> &candidates,
     }
 
     foreach (Scope *scope, todo) {
+        if (isCanceled())
+            return;
+
         addCompletionItem(scope->owner());
 
         for (unsigned i = 0; i < scope->symbolCount(); ++i) {
@@ -746,9 +955,9 @@ void CppCodeCompletion::completeNamespace(const QList<Symbol *> &candidates,
     }
 }
 
-void CppCodeCompletion::completeClass(const QList<Symbol *> &candidates,
-                                      const LookupContext &context,
-                                      bool staticLookup)
+void CompletionJob::completeClass(const QList<Symbol *> &candidates,
+                                  const LookupContext &context,
+                                  bool staticLookup)
 {
     if (candidates.isEmpty())
         return;
@@ -759,6 +968,9 @@ void CppCodeCompletion::completeClass(const QList<Symbol *> &candidates,
     context.expand(klass->members(), context.visibleScopes(), &todo);
 
     foreach (Scope *scope, todo) {
+        if (isCanceled())
+            return;
+
         addCompletionItem(scope->owner());
 
         for (unsigned i = 0; i < scope->symbolCount(); ++i) {
@@ -776,10 +988,10 @@ void CppCodeCompletion::completeClass(const QList<Symbol *> &candidates,
     }
 }
 
-bool CppCodeCompletion::completeQtMethod(CPlusPlus::FullySpecifiedType,
-                                         const QList<TypeOfExpression::Result> &results,
-                                         const LookupContext &context,
-                                         bool wantSignals)
+bool CompletionJob::completeQtMethod(CPlusPlus::FullySpecifiedType,
+                                     const QList<TypeOfExpression::Result> &results,
+                                     const LookupContext &context,
+                                     bool wantSignals)
 {
     if (results.isEmpty())
         return false;
@@ -792,6 +1004,9 @@ bool CppCodeCompletion::completeQtMethod(CPlusPlus::FullySpecifiedType,
 
     QSet<QString> signatures;
     foreach (TypeOfExpression::Result p, results) {
+        if (isCanceled())
+            return false;
+
         FullySpecifiedType ty = p.first;
         if (ReferenceType *refTy = ty->asReferenceType())
             ty = refTy->elementType();
@@ -818,7 +1033,9 @@ bool CppCodeCompletion::completeQtMethod(CPlusPlus::FullySpecifiedType,
         context.expand(klass->members(), visibleScopes, &todo);
 
         foreach (Scope *scope, todo) {
-            if (! scope->isClassScope())
+            if (isCanceled())
+                return false;
+            else if (! scope->isClassScope())
                 continue;
 
             for (unsigned i = 0; i < scope->symbolCount(); ++i) {
@@ -880,54 +1097,31 @@ void CppCodeCompletion::completions(QList<TextEditor::CompletionItem> *completio
     else if (length > 0) {
         const QString key = m_editor->textAt(m_startPosition, length);
 
+        if (! m_completionIndexUpToDate) {
+            QStringList texts;
+            foreach (const TextEditor::CompletionItem &item, m_completions)
+                texts.append(item.m_text);
+            m_completionIndex.setTexts(texts);
+            m_completionIndexUpToDate = true;
+        }
+
         if (m_completionOperator != T_LPAREN) {
             /*
-             * This code builds a regular expression in order to more intelligently match
-             * camel-case style. This means upper-case characters will be rewritten as follows:
-             *
-             *   A => [a-z0-9_]*A (for any but the first capital letter)
-             *
-             * Meaning it allows any sequence of lower-case characters to preceed an
-             * upper-case character. So for example gAC matches getActionController.
+             * The key is matched in camel-case style: the upper-case characters but the
+             * first may be preceded by any sequence of lower-case characters, so for
+             * example gAC matches getActionController.
              *
              * The match is case-sensitive as soon as at least one upper-case character is
              * present.
              */
-            QString keyRegExp;
-            keyRegExp += QLatin1Char('^');
-            bool first = true;
-            Qt::CaseSensitivity sensitivity = Qt::CaseInsensitive;
-            foreach (const QChar &c, key) {
-                if (c.isLower()) {
-                    keyRegExp.append(c);
-                } else if (c.isUpper()) {
-                    sensitivity = Qt::CaseSensitive;
-                    if (!first) {
-                        keyRegExp.append("[a-z0-9_]*");
-                    }
-                    keyRegExp.append(c);
-                } else {
-                    keyRegExp.append(QRegExp::escape(c));
-                }
-                first = false;
-            }
-            const QRegExp regExp(keyRegExp, sensitivity);
-
-            foreach (TextEditor::CompletionItem item, m_completions) {
-                if (regExp.indexIn(item.m_text) == 0) {
-                    item.m_relevance = (key.length() > 0 &&
-                                         item.m_text.startsWith(key, Qt::CaseInsensitive)) ? 1 : 0;
-                    (*completions) << item;
-                }
-            }
-        } else if (m_completionOperator == T_LPAREN ||
-                   m_completionOperator == T_SIGNAL ||
-                   m_completionOperator == T_SLOT) {
-            foreach (TextEditor::CompletionItem item, m_completions) {
-                if (item.m_text.startsWith(key, Qt::CaseInsensitive)) {
-                    (*completions) << item;
-                }
+            foreach (int index, m_completionIndex.match(key, CompletionIndex::CamelCaseMatch)) {
+                TextEditor::CompletionItem item = m_completions.at(index);
+                item.m_relevance = item.m_text.startsWith(key, Qt::CaseInsensitive) ? 1 : 0;
+                (*completions) << item;
             }
+        } else {
+            foreach (int index, m_completionIndex.match(key, CompletionIndex::PrefixMatch))
+                (*completions) << m_completions.at(index);
         }
     }
 }
@@ -1034,11 +1228,15 @@ bool CppCodeCompletion::partiallyComplete(const QList<TextEditor::CompletionItem
 
 void CppCodeCompletion::cleanup()
 {
+    cancelCompletionJob();
+
     m_completions.clear();
+    m_completionIndex.clear();
+    m_completionIndexUpToDate = false;
 
-    // Set empty map in order to avoid referencing old versions of the documents
+    // Release the job in order to avoid referencing old versions of the documents
     // until the next completion
-    typeOfExpression.setSnapshot(Snapshot());
+    m_completionJob.clear();
 }
 
 int CppCodeCompletion::findStartOfName(const TextEditor::ITextEditor *editor)
@@ -38,15 +38,18 @@
 #include <ASTfwd.h>
 #include <FullySpecifiedType.h>
 #include <cplusplus/Icons.h>
-#include <cplusplus/Overview.h>
-#include <cplusplus/TypeOfExpression.h>
 
 // Qt Creator
 #include <texteditor/icompletioncollector.h>
 
+#include "cppcompletionindex.h"
+
 // Qt
+#include <QtCore/QFuture>
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QObject>
 #include <QtCore/QPointer>
+#include <QtCore/QSharedPointer>
 
 namespace Core {
 class ICore;
@@ -59,6 +62,7 @@ class ITextEditor;
 namespace CppTools {
 namespace Internal {
 
+class CompletionJob;
 class CppModelManager;
 class FunctionArgumentWidget;
 
@@ -67,9 +71,11 @@ class CppCodeCompletion : public TextEditor::ICompletionCollector
     Q_OBJECT
 public:
     CppCodeCompletion(CppModelManager *manager, Core::ICore *core);
+    ~CppCodeCompletion();
 
     bool triggersCompletion(TextEditor::ITextEditable *editor);
     int startCompletion(TextEditor::ITextEditable *editor);
+    bool completionsPending() const;
     void completions(QList<TextEditor::CompletionItem> *completions);
 
     void complete(const TextEditor::CompletionItem &item);
@@ -78,50 +84,17 @@ public:
 
     QIcon iconForSymbol(CPlusPlus::Symbol *symbol) const;
 
-private:
-    void addKeywords();
-    void addMacros(const CPlusPlus::LookupContext &context);
-    void addCompletionItem(CPlusPlus::Symbol *symbol);
-
-    bool completeFunction(CPlusPlus::FullySpecifiedType exprTy,
-                          const QList<CPlusPlus::TypeOfExpression::Result> &,
-                          const CPlusPlus::LookupContext &context);
-
-    bool completeMember(CPlusPlus::FullySpecifiedType exprTy,
-                        const QList<CPlusPlus::TypeOfExpression::Result> &,
-                        const CPlusPlus::LookupContext &context);
-
-    bool completeScope(CPlusPlus::FullySpecifiedType exprTy,
-                       const QList<CPlusPlus::TypeOfExpression::Result> &,
-                       const CPlusPlus::LookupContext &context);
-
-    void completeNamespace(const QList<CPlusPlus::Symbol *> &candidates,
-                           const CPlusPlus::LookupContext &context);
-
-    void completeClass(const QList<CPlusPlus::Symbol *> &candidates,
-                       const CPlusPlus::LookupContext &context,
-                       bool staticLookup = true);
+private slots:
+    void completionJobFinished();
 
-    bool completeQtMethod(CPlusPlus::FullySpecifiedType exprTy,
-                          const QList<CPlusPlus::TypeOfExpression::Result> &,
-                          const CPlusPlus::LookupContext &context,
-                          bool wantSignals);
-
-    bool completeSignal(CPlusPlus::FullySpecifiedType exprTy,
-                        const QList<CPlusPlus::TypeOfExpression::Result> &results,
-                        const CPlusPlus::LookupContext &context)
-    { return completeQtMethod(exprTy, results, context, true); }
-
-    bool completeSlot(CPlusPlus::FullySpecifiedType exprTy,
-                      const QList<CPlusPlus::TypeOfExpression::Result> &results,
-                      const CPlusPlus::LookupContext &context)
-    { return completeQtMethod(exprTy, results, context, false); }
+private:
+    void cancelCompletionJob();
 
     static int findStartOfName(const TextEditor::ITextEditor *editor);
 
     QList<TextEditor::CompletionItem> m_completions;
 
-    TextEditor::ITextEditable *m_editor;
+    QPointer<TextEditor::ITextEditable> m_editor;
     int m_startPosition;     // Position of the cursor from which completion started
 
     Core::ICore *m_core;
@@ -130,11 +103,22 @@ private:
     bool m_forcedCompletion;
 
     CPlusPlus::Icons m_icons;
-    CPlusPlus::Overview overview;
-    CPlusPlus::TypeOfExpression typeOfExpression;
 
     unsigned m_completionOperator;
 
+    // The completion computed in a worker thread, kept alive until cleanup()
+    // since the completion items refer to the symbols of its snapshot.
+    QSharedPointer<CompletionJob> m_completionJob;
+    QFutureWatcher<void> m_completionJobWatcher;
+    bool m_completionPending;
+
+    // The canceled jobs that may still be running, waited for on destruction.
+    QList<QFuture<void> > m_canceledJobs;
+
+    // The index of m_completions, built when the first key is typed.
+    CompletionIndex m_completionIndex;
+    bool m_completionIndexUpToDate;
+
     QPointer<FunctionArgumentWidget> m_functionArgumentWidget;
 };
 
@@ -0,0 +1,220 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+#include "cppcompletionindex.h"
+
+#include <QtAlgorithms>
+
+using namespace CppTools::Internal;
+
+namespace {
+
+// The characters that may precede a hump of a camel-case key.
+inline bool isHumpPrefixChar(QChar ch)
+{
+    const ushort u = ch.unicode();
+    return (u >= 'a' && u <= 'z') || (u >= '0' && u <= '9') || u == '_';
+}
+
+class KeyLessThan
+{
+public:
+    KeyLessThan(const QVector<QString> &keys)
+        : m_keys(keys)
+    { }
+
+    bool operator()(int a, int b) const
+    {
+        const int c = QString::compare(m_keys.at(a), m_keys.at(b));
+        return c ? c < 0 : a < b;
+    }
+
+    bool operator()(int a, const QString &key) const
+    { return m_keys.at(a) < key; }
+
+private:
+    const QVector<QString> &m_keys;
+};
+
+// Returns the range of the sorted positions whose key starts with prefix.
+QVector<int> prefixRange(const QVector<int> &sorted, const QVector<QString> &keys,
+                         const QString &prefix)
+{
+    KeyLessThan lessThan(keys);
+    QString end = prefix;
+    end.append(QChar(0xffff));
+
+    QVector<int>::const_iterator first = qLowerBound(sorted.begin(), sorted.end(),
+                                                     prefix, lessThan);
+    QVector<int>::const_iterator last = qLowerBound(first, sorted.end(), end, lessThan);
+
+    QVector<int> range;
+    range.reserve(last - first);
+    for (; first != last; ++first)
+        range.append(*first);
+    return range;
+}
+
+} // anonymous namespace
+
+CompletionIndex::CompletionIndex()
+    : m_built(false),
+      m_lastMode(CamelCaseMatch)
+{ }
+
+void CompletionIndex::setTexts(const QStringList &texts)
+{
+    clear();
+    m_texts = texts;
+}
+
+void CompletionIndex::clear()
+{
+    m_texts.clear();
+    m_built = false;
+    m_lowerTexts.clear();
+    m_byLowerText.clear();
+    m_humps.clear();
+    m_byHumps.clear();
+    m_lastKey.clear();
+    m_lastMatches.clear();
+}
+
+QVector<int> CompletionIndex::match(const QString &key, MatchMode mode)
+{
+    QVector<int> result;
+
+    if (key.isEmpty()) {
+        result.reserve(m_texts.size());
+        for (int i = 0; i < m_texts.size(); ++i)
+            result.append(i);
+        return result;
+    }
+
+    // A longer key matches a subset of the texts the shorter one matched:
+    // the characters typed so far match at least as strictly as before.
+    QVector<int> candidates;
+    if (! m_lastKey.isEmpty() && mode == m_lastMode && key.startsWith(m_lastKey))
+        candidates = m_lastMatches;
+    else
+        candidates = this->candidates(key, mode);
+
+    result.reserve(candidates.size());
+    foreach (int index, candidates) {
+        if (matches(m_texts.at(index), key, mode))
+            result.append(index);
+    }
+
+    m_lastKey = key;
+    m_lastMode = mode;
+    m_lastMatches = result;
+    return result;
+}
+
+bool CompletionIndex::matches(const QString &text, const QString &key, MatchMode mode)
+{
+    if (! isCaseSensitive(key, mode))
+        return text.startsWith(key, Qt::CaseInsensitive);
+
+    int position = 0;
+    for (int i = 0; i < key.length(); ++i) {
+        const QChar ch = key.at(i);
+        if (i && ch.isUpper()) {
+            while (position < text.length() && isHumpPrefixChar(text.at(position)))
+                ++position;
+        }
+        if (position == text.length() || text.at(position) != ch)
+            return false;
+        ++position;
+    }
+    return true;
+}
+
+void CompletionIndex::build()
+{
+    m_built = true;
+
+    const int count = m_texts.size();
+    m_lowerTexts.resize(count);
+    m_byLowerText.resize(count);
+    m_humps.resize(count);
+    m_byHumps.resize(count);
+
+    for (int i = 0; i < count; ++i) {
+        const QString &text = m_texts.at(i);
+        m_lowerTexts[i] = text.toLower();
+        m_humps[i] = humps(text);
+        m_byLowerText[i] = i;
+        m_byHumps[i] = i;
+    }
+
+    qSort(m_byLowerText.begin(), m_byLowerText.end(), KeyLessThan(m_lowerTexts));
+    qSort(m_byHumps.begin(), m_byHumps.end(), KeyLessThan(m_humps));
+}
+
+QVector<int> CompletionIndex::candidates(const QString &key, MatchMode mode)
+{
+    if (! m_built)
+        build();
+
+    QVector<int> candidates;
+    if (isCaseSensitive(key, mode))
+        candidates = prefixRange(m_byHumps, m_humps, humps(key));
+    else
+        candidates = prefixRange(m_byLowerText, m_lowerTexts, key.toLower());
+
+    qSort(candidates);
+    return candidates;
+}
+
+bool CompletionIndex::isCaseSensitive(const QString &key, MatchMode mode)
+{
+    if (mode == PrefixMatch)
+        return false;
+
+    foreach (const QChar &ch, key) {
+        if (ch.isUpper())
+            return true;
+    }
+    return false;
+}
+
+QString CompletionIndex::humps(const QString &text)
+{
+    QString humps;
+    foreach (const QChar &ch, text) {
+        if (ch.isUpper())
+            humps.append(ch);
+    }
+    return humps;
+}
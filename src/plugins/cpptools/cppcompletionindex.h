@@ -0,0 +1,99 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+#ifndef CPPCOMPLETIONINDEX_H
+#define CPPCOMPLETIONINDEX_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace CppTools {
+namespace Internal {
+
+// Finds the completion candidates that match the typed key without
+// running a regular expression on each of them.
+//
+// The candidates are kept sorted by their lower-case text, for the plain
+// prefixes, and by their humps, that is their upper-case letters, for the
+// camel-case keys: gAC can only match the texts whose humps start with AC.
+// While the key grows, the matches of the previous key are narrowed down.
+class CompletionIndex
+{
+public:
+    enum MatchMode {
+        // The key matches case-insensitively as a prefix, unless it has an
+        // upper-case letter. Then the match is case-sensitive and the
+        // upper-case letters (but the first) may be preceded by any run of
+        // [a-z0-9_], so that gAC matches getActionController.
+        CamelCaseMatch,
+
+        // The key is a case-insensitive prefix of the text.
+        PrefixMatch
+    };
+
+    CompletionIndex();
+
+    void setTexts(const QStringList &texts);
+    void clear();
+
+    // Returns the positions of the texts that match key, in ascending order.
+    QVector<int> match(const QString &key, MatchMode mode = CamelCaseMatch);
+
+    static bool matches(const QString &text, const QString &key, MatchMode mode);
+
+private:
+    void build();
+    QVector<int> candidates(const QString &key, MatchMode mode);
+
+    static bool isCaseSensitive(const QString &key, MatchMode mode);
+    static QString humps(const QString &text);
+
+    QStringList m_texts;
+    bool m_built;
+
+    QVector<QString> m_lowerTexts;
+    QVector<int> m_byLowerText;
+
+    QVector<QString> m_humps;
+    QVector<int> m_byHumps;
+
+    QString m_lastKey;
+    MatchMode m_lastMode;
+    QVector<int> m_lastMatches;
+};
+
+} // namespace Internal
+} // namespace CppTools
+
+#endif // CPPCOMPLETIONINDEX_H
@@ -41,8 +41,8 @@ CppFunctionsFilter::CppFunctionsFilter(CppModelManager *manager, Core::EditorMan
     setShortcutString("m");
     setIncludedByDefault(false);
 
-    search.setSymbolsToSearchFor(SearchSymbols::Functions);
-    search.setSeparateScope(true);
+    setSymbolsToSearchFor(SearchSymbols::Functions);
+    setSeparateScope(true);
 }
 
 CppFunctionsFilter::~CppFunctionsFilter()
@@ -165,11 +165,10 @@ void CppHoverHandler::updateHelpIdAndTooltip(TextEditor::ITextEditor *editor, in
     QTextCursor tc(edit->document());
     tc.setPosition(pos);
 
-    const Snapshot documents = m_manager->snapshot();
-
     const int lineNumber = tc.block().blockNumber() + 1;
     const QString fileName = editor->file()->fileName();
-    Document::Ptr doc = documents.value(fileName);
+    Document::Ptr doc = m_manager->documentWithFunctionBodies(fileName, lineNumber);
+    const Snapshot documents = m_manager->snapshot();
     if (doc) {
         foreach (Document::DiagnosticMessage m, doc->diagnosticMessages()) {
             if (m.line() == lineNumber) {
@@ -215,6 +214,7 @@ void CppHoverHandler::updateHelpIdAndTooltip(TextEditor::ITextEditor *editor, in
 
             TypeOfExpression typeOfExpression;
             typeOfExpression.setSnapshot(documents);
+            typeOfExpression.setVisibleScopesCache(m_manager->visibleScopesCache());
             QList<TypeOfExpression::Result> types = typeOfExpression(expression, doc, lastSymbol);
 
             if (!types.isEmpty()) {
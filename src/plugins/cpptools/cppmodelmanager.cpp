@@ -32,9 +32,13 @@
 ***************************************************************************/
 
 #include <cplusplus/pp.h>
+#include <cplusplus/DocumentCache.h>
+#include <cplusplus/FindUsages.h>
+#include <cplusplus/BlockRecycler.h>
 
 #include "cppmodelmanager.h"
 #include "cpphoverhandler.h"
+#include "cppsourcefile.h"
 #include "cpptoolsconstants.h"
 #include "cpptoolseditorsupport.h"
 
@@ -55,6 +59,7 @@
 #include <utils/qtcassert.h>
 
 #include <TranslationUnit.h>
+#include <MemoryPool.h>
 #include <Semantic.h>
 #include <AST.h>
 #include <Scope.h>
@@ -68,6 +73,8 @@
 
 #include <QtCore/QDebug>
 #include <QtCore/QMutexLocker>
+#include <QtCore/QSettings>
+#include <QtCore/QThreadPool>
 #include <QtCore/QTime>
 
 //#include <QtGui/QPlainTextEdit>
@@ -78,6 +85,14 @@ using namespace CPlusPlus;
 
 static const char pp_configuration_file[] = "<configuration>";
 
+static const char *indexerThreadCountKeyC = "CppTools/IndexerThreadCount";
+static const char *documentCacheSizeKeyC = "CppTools/DocumentCacheSize";
+static const char *skipFunctionBodiesKeyC = "CppTools/SkipFunctionBodies";
+
+// Reindex everything into a new name table once the identifiers left behind
+// by the reparsed documents outnumber the live ones this many times.
+enum { NameTableGrowthFactor = 3 };
+
 static const char pp_configuration[] =
     "# 1 \"<configuration>\"\n"
     "#define __GNUC_MINOR__ 0\n"
@@ -110,6 +125,134 @@ static const char pp_configuration[] =
 namespace CppTools {
 namespace Internal {
 
+// The files processed during an indexing run and their documents, shared
+// by all the preprocessors working on it in parallel. A file processed by
+// one preprocessor isn't processed again by the others, they merge its
+// macros into the translation unit that includes it instead.
+class IncludedFiles
+{
+public:
+    // Returns false if the file was already claimed by a preprocessor.
+    bool claim(const QString &fileName)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_files.contains(fileName))
+            return false;
+
+        m_files.insert(fileName);
+        return true;
+    }
+
+    Document::Ptr document(const QString &fileName) const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_documents.value(fileName);
+    }
+
+    void insertDocument(Document::Ptr doc)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_documents.insert(doc->fileName(), doc);
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QSet<QString> m_files;
+    QHash<QString, Document::Ptr> m_documents;
+};
+
+// Resolves the file names of the #include directives during an indexing
+// run, shared by all the preprocessors working on it in parallel. Whether a
+// file exists is looked up in cached directory listings, instead of asking
+// the file system again for every include path and every #include.
+class IncludePathCache
+{
+public:
+    IncludePathCache()
+        : m_projectFilesIndexed(false)
+    { }
+
+    bool findResolvedPaths(const QString &directory, const QString &fileName,
+                           QStringList *paths) const
+    {
+        QMutexLocker locker(&m_mutex);
+        QHash<QPair<QString, QString>, QStringList>::const_iterator it =
+                m_resolvedPaths.constFind(qMakePair(directory, fileName));
+        if (it == m_resolvedPaths.constEnd())
+            return false;
+
+        *paths = it.value();
+        return true;
+    }
+
+    void insertResolvedPaths(const QString &directory, const QString &fileName,
+                             const QStringList &paths)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_resolvedPaths.insert(qMakePair(directory, fileName), paths);
+    }
+
+    bool isFile(const QString &path)
+    {
+        const int slashIndex = path.lastIndexOf(QLatin1Char('/'));
+        const QString directory = path.left(slashIndex);
+        const QString name = fileNameKey(path.mid(slashIndex + 1));
+
+        QMutexLocker locker(&m_mutex);
+        QHash<QString, QSet<QString> >::const_iterator it = m_directoryEntries.constFind(directory);
+        if (it == m_directoryEntries.constEnd()) {
+            locker.unlock();
+            QSet<QString> entries;
+            const QDir::Filters filters = QDir::Files | QDir::Hidden | QDir::System;
+            foreach (const QString &entry, QDir(directory).entryList(filters))
+                entries.insert(fileNameKey(entry));
+            locker.relock();
+            it = m_directoryEntries.insert(directory, entries);
+        }
+        return it->contains(name);
+    }
+
+    // Returns the first project file whose path ends with fileName.
+    QString findProjectFile(const QStringList &projectFiles, const QString &fileName)
+    {
+        QString path = fileName;
+        if (path.at(0) != QLatin1Char('/'))
+            path.prepend(QLatin1Char('/'));
+
+        QMutexLocker locker(&m_mutex);
+        if (! m_projectFilesIndexed) {
+            foreach (const QString &projectFile, projectFiles) {
+                const QString name = projectFile.mid(projectFile.lastIndexOf(QLatin1Char('/')) + 1);
+                m_projectFilesByName[name].append(projectFile);
+            }
+            m_projectFilesIndexed = true;
+        }
+
+        const QString name = path.mid(path.lastIndexOf(QLatin1Char('/')) + 1);
+        foreach (const QString &projectFile, m_projectFilesByName.value(name)) {
+            if (projectFile.endsWith(path))
+                return projectFile;
+        }
+        return QString();
+    }
+
+private:
+    static QString fileNameKey(const QString &name)
+    {
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC)
+        return name.toLower(); // the file systems are case insensitive
+#else
+        return name;
+#endif
+    }
+
+    mutable QMutex m_mutex;
+    QHash<QPair<QString, QString>, QStringList> m_resolvedPaths;
+    QHash<QString, QSet<QString> > m_directoryEntries;
+    QHash<QString, QStringList> m_projectFilesByName;
+    bool m_projectFilesIndexed;
+};
+
 class CppPreprocessor: public CPlusPlus::Client
 {
 public:
@@ -119,17 +262,44 @@ public:
     void setIncludePaths(const QStringList &includePaths);
     void setFrameworkPaths(const QStringList &frameworkPaths);
     void setProjectFiles(const QStringList &files);
+    void setSharedIncludedFiles(IncludedFiles *includedFiles);
+    void setSharedIncludePathCache(IncludePathCache *includePathCache);
+    void setDocumentCache(QSharedPointer<CPlusPlus::DocumentCache> documentCache);
+    void setNameTable(CPlusPlus::SharedNameTable::Ptr nameTable);
+    void setSkipFunctionBodies(bool skipFunctionBodies);
+    void setSnapshot(const Snapshot &snapshot);
+    void setOutdatedFiles(const QStringList &fileNames);
+    void setEditedLines(CPlusPlus::Document::Ptr previousDoc,
+                        unsigned firstLine, unsigned lastLine, int lineDelta);
+    void setEditorRevision(const QString &fileName, unsigned editorRevision);
     void run(QString &fileName);
     void operator()(QString &fileName);
 
+    CPlusPlus::Document::Ptr document(const QString &fileName) const;
+
 protected:
     CPlusPlus::Document::Ptr switchDocument(CPlusPlus::Document::Ptr doc);
 
-    bool includeFile(const QString &absoluteFilePath, QByteArray *result);
-    QByteArray tryIncludeFile(QString &fileName, IncludeType type);
+    bool isIncluded(const QString &fileName) const;
+    void markAsIncluded(const QString &fileName);
+    bool isGuarded(CPlusPlus::Document::Ptr doc) const;
+    bool includeFile(const QString &absoluteFilePath, CppSourceFile *source);
+    void tryIncludeFile(QString &fileName, IncludeType type, CppSourceFile *source);
+    QStringList resolveIncludeFile(const QString &directory, const QString &fileName);
+    bool fileExists(const QString &path);
+    IncludePathCache *includePathCache();
 
     void mergeEnvironment(CPlusPlus::Document::Ptr doc);
-    void mergeEnvironment(CPlusPlus::Document::Ptr doc, QSet<QString> *processed);
+    bool mergeProcessedFile(const QString &fileName);
+    CPlusPlus::Document::Ptr processedDocument(const QString &fileName) const;
+    QStringList includeClosure(CPlusPlus::Document::Ptr doc) const;
+    CPlusPlus::MacroTable macroTable(const QString &fileName) const;
+    void updateMacroTable(CPlusPlus::Document::Ptr doc);
+
+    void processFile(const QString &fileName, const QByteArray &contents);
+    void copyDiagnosticMessagesOfSkippedBodies(CPlusPlus::Document::Ptr doc) const;
+    CPlusPlus::Document::Ptr loadStoredDocument(const QString &fileName);
+    bool containsWorkingCopyFile(const QStringList &fileNames) const;
 
     virtual void macroAdded(const Macro &macro);
     virtual void startExpandingMacro(unsigned offset,
@@ -138,6 +308,8 @@ protected:
     virtual void stopExpandingMacro(unsigned offset, const Macro &macro);
     virtual void startSkippingBlocks(unsigned offset);
     virtual void stopSkippingBlocks(unsigned offset);
+    virtual void includeGuardDetected(const QByteArray &macroName);
+    virtual void pragmaOnceDetected();
     virtual void sourceNeeded(QString &fileName, IncludeType type,
                               unsigned line);
 
@@ -152,7 +324,167 @@ private:
     QStringList m_projectFiles;
     QStringList m_frameworkPaths;
     QSet<QString> m_included;
+    QSet<QString> m_pragmaOnceFiles;
+    QHash<QString, CPlusPlus::Document::Ptr> m_processedDocuments;
+    IncludedFiles *m_sharedIncluded;
+    IncludePathCache m_includePathCache;
+    IncludePathCache *m_sharedIncludePathCache;
+    QSharedPointer<CPlusPlus::DocumentCache> m_documentCache;
+    CPlusPlus::SharedNameTable::Ptr m_nameTable;
     CPlusPlus::Document::Ptr m_currentDoc;
+    bool m_skipFunctionBodies;
+    CPlusPlus::Document::Ptr m_previousDoc;
+    QString m_editorFileName;
+    unsigned m_editorRevision;
+    unsigned m_firstEditedLine;
+    unsigned m_lastEditedLine;
+    int m_editedLineDelta;
+};
+
+// The order in which the indexer should process the files. The model
+// manager changes it as the user works with the editors, the running
+// indexing tasks pick up the changes when they take their next file.
+class IndexerPriorities
+{
+public:
+    enum Priority {
+        CurrentEditorPriority,
+        OpenedEditorPriority,
+        IncludedByEditorPriority,
+        DefaultPriority
+    };
+
+    IndexerPriorities()
+        : m_revision(0)
+    { }
+
+    void setPriorities(const QHash<QString, int> &priorities)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_priorities = priorities;
+        ++m_revision;
+    }
+
+    int revision() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_revision;
+    }
+
+    QHash<QString, int> priorities(int *revision) const
+    {
+        QMutexLocker locker(&m_mutex);
+        *revision = m_revision;
+        return m_priorities;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QHash<QString, int> m_priorities;
+    int m_revision;
+};
+
+// Hands out the files of an indexing run to the workers, most important
+// files first, and keeps the progress of the run up to date. The priorities
+// only reorder the files of the same dependency level, so that a file still
+// comes after the files it includes; see CppModelManager::dependentFiles().
+class IndexerQueue
+{
+    class PriorityLessThan
+    {
+    public:
+        PriorityLessThan(const QHash<QString, int> &priorities,
+                         const QHash<QString, int> &levels)
+            : m_priorities(priorities),
+              m_levels(levels)
+        { }
+
+        bool operator()(const QString &a, const QString &b) const
+        {
+            const int levelA = m_levels.value(a);
+            const int levelB = m_levels.value(b);
+            if (levelA != levelB)
+                return levelA < levelB;
+
+            return m_priorities.value(a, IndexerPriorities::DefaultPriority)
+                    < m_priorities.value(b, IndexerPriorities::DefaultPriority);
+        }
+
+    private:
+        const QHash<QString, int> &m_priorities;
+        const QHash<QString, int> &m_levels;
+    };
+
+public:
+    IndexerQueue(QFutureInterface<void> &future, const QStringList &files,
+                 const QHash<QString, int> &levels,
+                 QSharedPointer<IndexerPriorities> priorities)
+        : m_future(future),
+          m_files(files),
+          m_levels(levels),
+          m_priorities(priorities),
+          m_revision(-1),
+          m_next(0),
+          m_done(0)
+    { }
+
+    bool takeFile(QString *fileName)
+    {
+        if (m_future.isPaused())
+            m_future.waitForResume();
+
+        if (m_future.isCanceled())
+            return false;
+
+        QMutexLocker locker(&m_mutex);
+        if (m_next == m_files.size())
+            return false;
+
+        if (m_priorities && m_priorities->revision() != m_revision) {
+            // Sort the files left, keeping the given order among files of
+            // the same level and priority.
+            const QHash<QString, int> priorities = m_priorities->priorities(&m_revision);
+            qStableSort(m_files.begin() + m_next, m_files.end(),
+                        PriorityLessThan(priorities, m_levels));
+        }
+
+        *fileName = m_files.at(m_next++);
+        return true;
+    }
+
+    void fileDone()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_future.setProgressValue(++m_done);
+    }
+
+private:
+    QFutureInterface<void> &m_future;
+    QStringList m_files;
+    QHash<QString, int> m_levels;
+    QSharedPointer<IndexerPriorities> m_priorities;
+    int m_revision;
+    QMutex m_mutex;
+    int m_next;
+    int m_done;
+};
+
+class IndexerWorker: public QRunnable
+{
+public:
+    IndexerWorker(IndexerQueue *queue, CppPreprocessor *preproc)
+        : m_queue(queue),
+          m_preproc(preproc)
+    { }
+
+    virtual void run()
+    { indexFiles(m_queue, m_preproc); }
+
+    static void indexFiles(IndexerQueue *queue, CppPreprocessor *preproc);
+
+private:
+    IndexerQueue *m_queue;
+    CppPreprocessor *m_preproc;
 };
 
 } // namespace Internal
@@ -160,8 +492,15 @@ private:
 
 CppPreprocessor::CppPreprocessor(QPointer<CppModelManager> modelManager)
     : m_modelManager(modelManager),
-    m_snapshot(modelManager->snapshot()),
-    m_proc(this, env)
+    m_snapshot(modelManager ? modelManager->snapshot() : Snapshot()),
+    m_proc(this, env),
+    m_sharedIncluded(0),
+    m_sharedIncludePathCache(0),
+    m_skipFunctionBodies(false),
+    m_editorRevision(0),
+    m_firstEditedLine(0),
+    m_lastEditedLine(0),
+    m_editedLineDelta(0)
 { }
 
 void CppPreprocessor::setWorkingCopy(const QMap<QString, QByteArray> &workingCopy)
@@ -176,21 +515,116 @@ void CppPreprocessor::setFrameworkPaths(const QStringList &frameworkPaths)
 void CppPreprocessor::setProjectFiles(const QStringList &files)
 { m_projectFiles = files; }
 
+void CppPreprocessor::setSharedIncludedFiles(IncludedFiles *includedFiles)
+{ m_sharedIncluded = includedFiles; }
+
+void CppPreprocessor::setSharedIncludePathCache(IncludePathCache *includePathCache)
+{ m_sharedIncludePathCache = includePathCache; }
+
+void CppPreprocessor::setDocumentCache(QSharedPointer<DocumentCache> documentCache)
+{ m_documentCache = documentCache; }
+
+void CppPreprocessor::setNameTable(SharedNameTable::Ptr nameTable)
+{ m_nameTable = nameTable; }
+
+void CppPreprocessor::setSkipFunctionBodies(bool skipFunctionBodies)
+{ m_skipFunctionBodies = skipFunctionBodies; }
+
+void CppPreprocessor::setSnapshot(const Snapshot &snapshot)
+{ m_snapshot = snapshot; }
+
+// The documents of outdated files are dropped from the snapshot, so that
+// they are processed again instead of merging their old macros.
+void CppPreprocessor::setOutdatedFiles(const QStringList &fileNames)
+{
+    foreach (const QString &fileName, fileNames)
+        m_snapshot.remove(fileName);
+}
+
+// Only the function bodies that overlap the lines [firstLine, lastLine] of
+// previousDoc's file are parsed; the diagnostics of the other bodies are
+// copied from previousDoc, shifted by lineDelta if they follow the edit.
+void CppPreprocessor::setEditedLines(Document::Ptr previousDoc,
+                                     unsigned firstLine, unsigned lastLine,
+                                     int lineDelta)
+{
+    m_previousDoc = previousDoc;
+    m_firstEditedLine = firstLine;
+    m_lastEditedLine = lastLine;
+    m_editedLineDelta = lineDelta;
+}
+
+// The document of fileName is tagged with the revision of the editor
+// contents it is parsed from, see CppModelManager::refreshEditedFile().
+void CppPreprocessor::setEditorRevision(const QString &fileName, unsigned editorRevision)
+{
+    m_editorFileName = fileName;
+    m_editorRevision = editorRevision;
+}
+
+// The set of included files is kept per translation unit; the files
+// included by a previous one have their macros merged again.
 void CppPreprocessor::run(QString &fileName)
-{ sourceNeeded(fileName, IncludeGlobal, /*line = */ 0); }
+{
+    m_included.clear();
+    sourceNeeded(fileName, IncludeGlobal, /*line = */ 0);
+}
 
 void CppPreprocessor::operator()(QString &fileName)
 { run(fileName); }
 
-bool CppPreprocessor::includeFile(const QString &absoluteFilePath, QByteArray *result)
+// Returns the document of fileName if this preprocessor processed it.
+Document::Ptr CppPreprocessor::document(const QString &fileName) const
+{ return m_processedDocuments.value(fileName); }
+
+bool CppPreprocessor::isIncluded(const QString &fileName) const
+{ return m_included.contains(fileName); }
+
+void CppPreprocessor::markAsIncluded(const QString &fileName)
+{
+    m_included.insert(fileName);
+
+    if (m_sharedIncluded)
+        (void) m_sharedIncluded->claim(fileName);
+}
+
+// Returns true if including the already processed document again can't
+// change anything, because its include guard is still defined or because
+// it's protected by #pragma once.
+bool CppPreprocessor::isGuarded(Document::Ptr doc) const
+{
+    if (! doc)
+        return false;
+
+    if (doc->hasPragmaOnce())
+        return m_pragmaOnceFiles.contains(doc->fileName());
+
+    const QByteArray guard = doc->includeGuard();
+    return ! guard.isEmpty() && env.resolve(guard) != 0;
+}
+
+bool CppPreprocessor::includeFile(const QString &absoluteFilePath, CppSourceFile *source)
 {
-    if (absoluteFilePath.isEmpty() || m_included.contains(absoluteFilePath)) {
+    if (absoluteFilePath.isEmpty() || isIncluded(absoluteFilePath)) {
         return true;
     }
 
+    if (m_currentDoc && isGuarded(m_snapshot.value(absoluteFilePath)))
+        return true;
+
+    if (m_currentDoc && mergeProcessedFile(absoluteFilePath))
+        return true;
+
+    // Every preprocessor needs its own copy of the configuration file, the
+    // other translation units are processed by only one of them.
+    if (! m_currentDoc && m_sharedIncluded
+            && absoluteFilePath != QLatin1String(pp_configuration_file)
+            && ! m_sharedIncluded->claim(absoluteFilePath))
+        return true;
+
     if (m_workingCopy.contains(absoluteFilePath)) {
-        m_included.insert(absoluteFilePath);
-        *result = m_workingCopy.value(absoluteFilePath);
+        markAsIncluded(absoluteFilePath);
+        source->setContents(m_workingCopy.value(absoluteFilePath));
         return true;
     }
 
@@ -198,39 +632,58 @@ bool CppPreprocessor::includeFile(const QString &absoluteFilePath, QByteArray *r
     if (! fileInfo.isFile())
         return false;
 
-    QFile file(absoluteFilePath);
-    if (file.open(QFile::ReadOnly)) {
-        m_included.insert(absoluteFilePath);
-        QTextStream stream(&file);
-        const QString contents = stream.readAll();
-        *result = contents.toUtf8();
-        file.close();
+    if (source->open(absoluteFilePath)) {
+        markAsIncluded(absoluteFilePath);
         return true;
     }
 
     return false;
 }
 
-QByteArray CppPreprocessor::tryIncludeFile(QString &fileName, IncludeType type)
+void CppPreprocessor::tryIncludeFile(QString &fileName, IncludeType type, CppSourceFile *source)
 {
     QFileInfo fileInfo(fileName);
     if (fileName == QLatin1String(pp_configuration_file) || fileInfo.isAbsolute()) {
-        QByteArray contents;
-        includeFile(fileName, &contents);
-        return contents;
+        includeFile(fileName, source);
+        return;
+    }
+
+    QString directory;
+    if (type == IncludeLocal && m_currentDoc)
+        directory = QFileInfo(m_currentDoc->fileName()).absolutePath();
+
+    IncludePathCache *cache = includePathCache();
+    QStringList paths;
+    if (! cache->findResolvedPaths(directory, fileName, &paths)) {
+        paths = resolveIncludeFile(directory, fileName);
+        cache->insertResolvedPaths(directory, fileName, paths);
     }
 
-    if (type == IncludeLocal && m_currentDoc) {
-        QFileInfo currentFileInfo(m_currentDoc->fileName());
-        QString path = currentFileInfo.absolutePath();
+    // a listed file may still fail to open, try the next include path then
+    foreach (const QString &path, paths) {
+        if (includeFile(path, source)) {
+            fileName = path;
+            return;
+        }
+    }
+
+    //qDebug() << "**** file" << fileName << "not found!";
+}
+
+// Returns the absolute paths the file included as fileName may have, in the
+// order they are searched, looking first in the directory of the including
+// file if it is not empty.
+QStringList CppPreprocessor::resolveIncludeFile(const QString &directory, const QString &fileName)
+{
+    QStringList paths;
+
+    if (! directory.isEmpty()) {
+        QString path = directory;
         path += QLatin1Char('/');
         path += fileName;
         path = QDir::cleanPath(path);
-        QByteArray contents;
-        if (includeFile(path, &contents)) {
-            fileName = path;
-            return contents;
-        }
+        if (fileExists(path))
+            paths.append(path);
     }
 
     foreach (const QString &includePath, m_includePaths) {
@@ -238,11 +691,8 @@ QByteArray CppPreprocessor::tryIncludeFile(QString &fileName, IncludeType type)
         path += QLatin1Char('/');
         path += fileName;
         path = QDir::cleanPath(path);
-        QByteArray contents;
-        if (includeFile(path, &contents)) {
-            fileName = path;
-            return contents;
-        }
+        if (fileExists(path))
+            paths.append(path);
     }
 
     // look in the system include paths
@@ -251,11 +701,8 @@ QByteArray CppPreprocessor::tryIncludeFile(QString &fileName, IncludeType type)
         path += QLatin1Char('/');
         path += fileName;
         path = QDir::cleanPath(path);
-        QByteArray contents;
-        if (includeFile(path, &contents)) {
-            fileName = path;
-            return contents;
-        }
+        if (fileExists(path))
+            paths.append(path);
     }
 
     int index = fileName.indexOf(QLatin1Char('/'));
@@ -269,29 +716,32 @@ QByteArray CppPreprocessor::tryIncludeFile(QString &fileName, IncludeType type)
             path += frameworkName;
             path += QLatin1String(".framework/Headers/");
             path += name;
-            QByteArray contents;
-            if (includeFile(path, &contents)) {
-                fileName = path;
-                return contents;
-            }
+            if (fileExists(path))
+                paths.append(path);
         }
     }
 
-    QString path = fileName;
-    if (path.at(0) != QLatin1Char('/'))
-        path.prepend(QLatin1Char('/'));
+    const QString projectFile = includePathCache()->findProjectFile(m_projectFiles, fileName);
+    if (! projectFile.isEmpty())
+        paths.append(projectFile);
 
-    foreach (const QString &projectFile, m_projectFiles) {
-        if (projectFile.endsWith(path)) {
-            fileName = projectFile;
-            QByteArray contents;
-            includeFile(fileName, &contents);
-            return contents;
-        }
-    }
+    return paths;
+}
 
-    //qDebug() << "**** file" << fileName << "not found!";
-    return QByteArray();
+IncludePathCache *CppPreprocessor::includePathCache()
+{
+    if (m_sharedIncludePathCache)
+        return m_sharedIncludePathCache;
+
+    return &m_includePathCache;
+}
+
+bool CppPreprocessor::fileExists(const QString &path)
+{
+    if (m_workingCopy.contains(path))
+        return true;
+
+    return includePathCache()->isFile(path);
 }
 
 void CppPreprocessor::macroAdded(const Macro &macro)
@@ -323,29 +773,100 @@ void CppPreprocessor::stopExpandingMacro(unsigned, const Macro &)
 
 void CppPreprocessor::mergeEnvironment(Document::Ptr doc)
 {
-    QSet<QString> processed;
-    mergeEnvironment(doc, &processed);
+    if (! doc || isGuarded(doc))
+        return;
+
+    if (doc->hasPragmaOnce())
+        m_pragmaOnceFiles.insert(doc->fileName());
+
+    env.merge(doc->macroTable());
 }
 
-void CppPreprocessor::mergeEnvironment(Document::Ptr doc, QSet<QString> *processed)
+// Merges the macros of a file already processed by this preprocessor or,
+// during an indexing run, by another one, instead of processing it again.
+// A file still being processed by another preprocessor is processed here
+// too, so the result doesn't depend on the order of the workers.
+bool CppPreprocessor::mergeProcessedFile(const QString &fileName)
 {
+    Document::Ptr doc = processedDocument(fileName);
     if (! doc)
-        return;
+        return false;
 
-    const QString fn = doc->fileName();
+    m_included.insert(fileName);
+    env.merge(doc->macroTable());
+    return true;
+}
 
-    if (processed->contains(fn))
-        return;
+Document::Ptr CppPreprocessor::processedDocument(const QString &fileName) const
+{
+    if (Document::Ptr doc = m_processedDocuments.value(fileName))
+        return doc;
 
-    processed->insert(fn);
+    if (m_sharedIncluded)
+        return m_sharedIncluded->document(fileName);
 
-    foreach (QString includedFile, doc->includedFiles()) {
-        mergeEnvironment(m_snapshot.value(includedFile), processed);
-    }
+    return Document::Ptr();
+}
+
+MacroTable CppPreprocessor::macroTable(const QString &fileName) const
+{
+    if (Document::Ptr doc = processedDocument(fileName))
+        return doc->macroTable();
+
+    if (Document::Ptr doc = m_snapshot.value(fileName))
+        return doc->macroTable();
+
+    return MacroTable();
+}
+
+// Returns the files included by doc, directly or through other files; the
+// stored document is only valid as long as none of them changes.
+QStringList CppPreprocessor::includeClosure(Document::Ptr doc) const
+{
+    QStringList closure;
+    QSet<QString> visited;
+    visited.insert(doc->fileName());
+
+    QList<Document::Ptr> todo;
+    todo.append(doc);
+    while (! todo.isEmpty()) {
+        Document::Ptr current = todo.takeLast();
+        foreach (const QString &includedFile, current->includedFiles()) {
+            if (visited.contains(includedFile))
+                continue;
+
+            visited.insert(includedFile);
+            closure.append(includedFile);
 
-    foreach (const Macro macro, doc->definedMacros()) {
-        env.bind(macro);
+            Document::Ptr includedDoc = processedDocument(includedFile);
+            if (! includedDoc)
+                includedDoc = m_snapshot.value(includedFile);
+            if (includedDoc)
+                todo.append(includedDoc);
+        }
     }
+
+    return closure;
+}
+
+// The macro table of a document holds the macros of the files it includes
+// followed by its own ones, so it can be merged in one step when the
+// document is included again.
+void CppPreprocessor::updateMacroTable(Document::Ptr doc)
+{
+    MacroTable table;
+
+    foreach (const QString &includedFile, doc->includedFiles())
+        table.unite(macroTable(includedFile));
+
+    foreach (const Macro &macro, doc->definedMacros())
+        table.insert(macro);
+
+    doc->setMacroTable(table);
+    m_processedDocuments.insert(doc->fileName(), doc);
+
+    if (m_sharedIncluded)
+        m_sharedIncluded->insertDocument(doc);
 }
 
 void CppPreprocessor::startSkippingBlocks(unsigned offset)
@@ -362,13 +883,31 @@ void CppPreprocessor::stopSkippingBlocks(unsigned offset)
         m_currentDoc->stopSkippingBlocks(offset);
 }
 
+void CppPreprocessor::includeGuardDetected(const QByteArray &macroName)
+{
+    if (m_currentDoc)
+        m_currentDoc->setIncludeGuard(macroName);
+}
+
+void CppPreprocessor::pragmaOnceDetected()
+{
+    if (! m_currentDoc)
+        return;
+
+    m_currentDoc->setPragmaOnce(true);
+    m_pragmaOnceFiles.insert(m_currentDoc->fileName());
+}
+
 void CppPreprocessor::sourceNeeded(QString &fileName, IncludeType type,
                                    unsigned line)
 {
     if (fileName.isEmpty())
         return;
 
-    QByteArray contents = tryIncludeFile(fileName, type);
+    // the contents of a mapped file are valid as long as source lives
+    CppSourceFile source;
+    tryIncludeFile(fileName, type, &source);
+    const QByteArray contents = source.contents();
 
     if (m_currentDoc) {
         m_currentDoc->addIncludeFile(fileName, line);
@@ -385,38 +924,136 @@ void CppPreprocessor::sourceNeeded(QString &fileName, IncludeType type,
         }
     }
 
-    if (! contents.isEmpty()) {
-        Document::Ptr cachedDoc = m_snapshot.value(fileName);
-        if (cachedDoc && m_currentDoc) {
-            mergeEnvironment(cachedDoc);
-        } else {
-            Document::Ptr previousDoc = switchDocument(Document::create(fileName));
+    if (! contents.isEmpty())
+        processFile(fileName, contents);
+}
+
+void CppPreprocessor::processFile(const QString &fileName, const QByteArray &contents)
+{
+    Document::Ptr cachedDoc = m_snapshot.value(fileName);
+    if (cachedDoc && m_currentDoc) {
+        mergeEnvironment(cachedDoc);
+    } else if (! loadStoredDocument(fileName)) {
+        Document::Ptr previousDoc = switchDocument(Document::create(fileName, m_nameTable));
+
+        const QByteArray previousFile = env.currentFile;
+        const unsigned previousLine = env.currentLine;
+
+        env.currentFile = QByteArray(m_currentDoc->translationUnit()->fileName(),
+                                     m_currentDoc->translationUnit()->fileNameLength());
+
+        QByteArray preprocessedCode;
+        m_proc(contents, &preprocessedCode);
+        //qDebug() << preprocessedCode;
+
+        env.currentFile = previousFile;
+        env.currentLine = previousLine;
+
+        updateMacroTable(m_currentDoc);
+
+        if (fileName == m_editorFileName)
+            m_currentDoc->setEditorRevision(m_editorRevision);
+
+        // The bodies of the functions are parsed only for the files opened in
+        // an editor; see CppModelManager::documentWithFunctionBodies().
+        const bool edited = ! previousDoc && m_previousDoc && m_previousDoc->fileName() == fileName;
+        if (edited) {
+            m_currentDoc->setSkipFunctionBody(true);
+            m_currentDoc->setParsedFunctionBodyLines(m_firstEditedLine, m_lastEditedLine);
+        } else if (m_skipFunctionBodies && ! m_workingCopy.contains(fileName)) {
+            m_currentDoc->setSkipFunctionBody(true);
+        }
 
-            const QByteArray previousFile = env.currentFile;
-            const unsigned previousLine = env.currentLine;
+        m_currentDoc->setSource(preprocessedCode);
+        m_currentDoc->parse();
+        m_currentDoc->check();
+        m_currentDoc->recordIdentifierUses(); // for findUsages(), needs the token stream.
+        m_currentDoc->releaseTranslationUnit(); // release the AST and the token stream.
 
-            env.currentFile = QByteArray(m_currentDoc->translationUnit()->fileName(),
-                                         m_currentDoc->translationUnit()->fileNameLength());
+        if (edited)
+            copyDiagnosticMessagesOfSkippedBodies(m_currentDoc);
+
+        if (m_documentCache && ! m_workingCopy.contains(fileName)) {
+            const QStringList dependencies = includeClosure(m_currentDoc);
+            if (! containsWorkingCopyFile(dependencies))
+                m_documentCache->store(m_currentDoc, dependencies);
+        }
+
+        if (m_modelManager)
+            m_modelManager->emitDocumentUpdated(m_currentDoc);
+        (void) switchDocument(previousDoc);
+    }
+}
 
-            QByteArray preprocessedCode;
-            m_proc(contents, &preprocessedCode);
-            //qDebug() << preprocessedCode;
+void CppPreprocessor::copyDiagnosticMessagesOfSkippedBodies(Document::Ptr doc) const
+{
+    const int firstLine = m_firstEditedLine;
+    const int lastPreviousLine = m_lastEditedLine - m_editedLineDelta;
 
-            env.currentFile = previousFile;
-            env.currentLine = previousLine;
+    foreach (const Document::DiagnosticMessage &m, m_previousDoc->diagnosticMessages()) {
+        if (m.fileName() != doc->fileName())
+            continue;
 
-            m_currentDoc->setSource(preprocessedCode);
-            m_currentDoc->parse();
-            m_currentDoc->check();
-            m_currentDoc->releaseTranslationUnit(); // release the AST and the token stream.
+        int line = m.line();
+        if (line >= firstLine) {
+            if (line <= lastPreviousLine)
+                continue; // the message was in the edited lines.
+            line += m_editedLineDelta;
+        }
 
-            if (m_modelManager)
-                m_modelManager->emitDocumentUpdated(m_currentDoc);
-            (void) switchDocument(previousDoc);
+        if (doc->isFunctionBodySkippedAt(line)) {
+            doc->addDiagnosticMessage(Document::DiagnosticMessage(m.level(), m.fileName(),
+                                                                  line, m.column(),
+                                                                  m.text()));
         }
     }
 }
 
+Document::Ptr CppPreprocessor::loadStoredDocument(const QString &fileName)
+{
+    if (! m_documentCache || m_workingCopy.contains(fileName))
+        return Document::Ptr();
+
+    QStringList dependencies;
+    Document::Ptr doc = m_documentCache->load(fileName, m_nameTable, &dependencies);
+    if (! doc || (doc->skipFunctionBody() && ! m_skipFunctionBodies)
+            || containsWorkingCopyFile(dependencies))
+        return Document::Ptr();
+
+    if (doc->hasPragmaOnce())
+        m_pragmaOnceFiles.insert(fileName);
+
+    // The stored document doesn't carry the macros of the files it includes,
+    // so process them as if the document had been preprocessed again.
+    Document::Ptr previousDoc = switchDocument(doc);
+    foreach (const QString &includedFile, doc->includedFiles()) {
+        QString fn = includedFile;
+        CppSourceFile source;
+        includeFile(fn, &source);
+        const QByteArray includedContents = source.contents();
+        if (! includedContents.isEmpty())
+            processFile(fn, includedContents);
+    }
+    (void) switchDocument(previousDoc);
+
+    updateMacroTable(doc);
+    env.merge(doc->macroTable());
+
+    if (m_modelManager)
+        m_modelManager->emitDocumentUpdated(doc);
+
+    return doc;
+}
+
+bool CppPreprocessor::containsWorkingCopyFile(const QStringList &fileNames) const
+{
+    foreach (const QString &fileName, fileNames) {
+        if (m_workingCopy.contains(fileName))
+            return true;
+    }
+    return false;
+}
+
 Document::Ptr CppPreprocessor::switchDocument(Document::Ptr doc)
 {
     Document::Ptr previousDoc = m_currentDoc;
@@ -424,6 +1061,38 @@ Document::Ptr CppPreprocessor::switchDocument(Document::Ptr doc)
     return previousDoc;
 }
 
+void IndexerWorker::indexFiles(IndexerQueue *queue, CppPreprocessor *preproc)
+{
+    // Change the priority of the background parser thread to idle.
+    QThread::currentThread()->setPriority(QThread::IdlePriority);
+
+    QString conf = QLatin1String(pp_configuration_file);
+    (void) preproc->run(conf);
+
+    const int STEP = 10;
+
+    QString fileName;
+    for (int i = 0; queue->takeFile(&fileName); ++i) {
+#ifdef CPPTOOLS_DEBUG_PARSING_TIME
+        QTime tm;
+        tm.start();
+#endif
+
+        preproc->run(fileName);
+        queue->fileDone();
+
+        if (! (i % STEP)) // Yields execution of the current thread.
+            QThread::yieldCurrentThread();
+
+#ifdef CPPTOOLS_DEBUG_PARSING_TIME
+        qDebug() << fileName << "parsed in:" << tm.elapsed();
+#endif
+    }
+
+    // Restore the previous thread priority.
+    QThread::currentThread()->setPriority(QThread::NormalPriority);
+}
+
 
 
 /*!
@@ -441,6 +1110,34 @@ CppModelManager::CppModelManager(QObject *parent) :
 {
     m_dirty = true;
 
+    m_nameTable = SharedNameTable::Ptr(new SharedNameTable);
+    m_liveIdentifierCount = 0;
+
+    // The indexer creates and destroys the memory pools of thousands of
+    // documents, keep their blocks around instead of going through malloc().
+    if (! MemoryPool::blockAllocator())
+        MemoryPool::setBlockAllocator(BlockRecycler::instance());
+
+    m_indexerPriorities = QSharedPointer<IndexerPriorities>(new IndexerPriorities);
+
+    m_indexerThreadCount = 0;
+    m_skipFunctionBodies = true;
+    int documentCacheSize = 256; // MB
+    if (const QSettings *settings = m_core->settings()) {
+        m_indexerThreadCount = settings->value(QLatin1String(indexerThreadCountKeyC), 0).toInt();
+        m_skipFunctionBodies = settings->value(QLatin1String(skipFunctionBodiesKeyC),
+                                               m_skipFunctionBodies).toBool();
+        documentCacheSize = settings->value(QLatin1String(documentCacheSizeKeyC),
+                                            documentCacheSize).toInt();
+
+        if (documentCacheSize > 0) {
+            const QFileInfo fi(settings->fileName());
+            m_documentCache = QSharedPointer<DocumentCache>(
+                    new DocumentCache(fi.absolutePath() + QLatin1String("/codemodel")));
+            m_documentCache->setMaximumSize(qint64(documentCacheSize) * 1024 * 1024);
+        }
+    }
+
     m_projectExplorer = ExtensionSystem::PluginManager::instance()
                         ->getObject<ProjectExplorer::ProjectExplorerPlugin>();
 
@@ -472,6 +1169,12 @@ CppModelManager::CppModelManager(QObject *parent) :
 
     connect(m_core->editorManager(), SIGNAL(editorAboutToClose(Core::IEditor *)),
         this, SLOT(editorAboutToClose(Core::IEditor *)));
+
+    connect(m_core->editorManager(), SIGNAL(currentEditorChanged(Core::IEditor *)),
+        this, SLOT(updateIndexerPriorities()));
+
+    connect(&m_fullReindexWatcher, SIGNAL(finished()),
+            this, SLOT(onFullReindexFinished()));
 }
 
 CppModelManager::~CppModelManager()
@@ -480,6 +1183,140 @@ CppModelManager::~CppModelManager()
 Snapshot CppModelManager::snapshot() const
 { return m_snapshot; }
 
+/*!
+    \fn    Document::Ptr CppModelManager::documentWithFunctionBodies(const QString &fileName, unsigned line)
+    \brief Returns the document of \a fileName with the function body at \a line.
+
+    The indexer doesn't parse the function bodies of the files that are not
+    opened in an editor. The files opened in an editor keep all their bodies,
+    except for a short while after an edit, when only the bodies touched by
+    the edit are parsed. If the body at \a line has been skipped, the editor
+    of the file is asked to parse it again with all its bodies in the
+    background, and the document is returned without the body; the new
+    document comes with documentUpdated(). Must be called from the GUI thread,
+    use functionBodyParser() in the other threads.
+ */
+Document::Ptr CppModelManager::documentWithFunctionBodies(const QString &fileName,
+                                                          unsigned line)
+{
+    Document::Ptr doc = m_snapshot.value(fileName);
+    if (! doc || ! doc->isFunctionBodySkippedAt(line))
+        return doc;
+
+    QMapIterator<TextEditor::ITextEditor *, CppEditorSupport *> it(m_editorSupport);
+    while (it.hasNext()) {
+        it.next();
+        if (it.key()->file()->fileName() == fileName) {
+            it.value()->parseFunctionBodies();
+            break;
+        }
+    }
+
+    return doc;
+}
+
+CPlusPlus::VisibleScopesCache *CppModelManager::visibleScopesCache()
+{ return &m_visibleScopesCache; }
+
+namespace {
+
+class CppFindUsages: public FindUsages
+{
+public:
+    CppFindUsages(const Snapshot &snapshot, const FunctionBodyParser &parseFunctionBodies)
+        : FindUsages(snapshot),
+          m_parseFunctionBodies(parseFunctionBodies)
+    { }
+
+protected:
+    virtual Document::Ptr documentWithFunctionBodies(Document::Ptr doc)
+    { return m_parseFunctionBodies(doc->fileName()); }
+
+private:
+    FunctionBodyParser m_parseFunctionBodies;
+};
+
+} // anonymous namespace
+
+static void findUsagesInThread(QFutureInterface<Usage> &future, CppFindUsages findUsages,
+                               Document::Ptr doc, Symbol *symbol)
+{
+    Q_UNUSED(doc) // keeps the symbol alive
+    (void) findUsages(symbol, &future);
+}
+
+QFuture<Usage> CppModelManager::findUsages(Document::Ptr doc, Symbol *symbol)
+{
+    CppFindUsages findUsages(snapshot(), functionBodyParser());
+    findUsages.setWorkingCopy(buildWorkingCopyList());
+    findUsages.setVisibleScopesCache(&m_visibleScopesCache);
+    return QtConcurrent::run(&findUsagesInThread, findUsages, doc, symbol);
+}
+
+QList<CppModelManagerInterface::SymbolLocation>
+CppModelManager::findSymbols(const QString &qualifiedName)
+{
+    QList<SymbolLocation> locations;
+    foreach (const ModelItemInfo &info, m_symbolIndex.symbols(qualifiedName)) {
+        SymbolLocation location;
+        location.fileName = info.fileName;
+        location.line = info.line;
+        switch (info.type) {
+        case ModelItemInfo::Enum:
+            location.kind = SymbolLocation::Enum;
+            break;
+        case ModelItemInfo::Class:
+            location.kind = SymbolLocation::Class;
+            break;
+        case ModelItemInfo::Method:
+            location.kind = SymbolLocation::Function;
+            break;
+        }
+        locations.append(location);
+    }
+    return locations;
+}
+
+SymbolIndex *CppModelManager::symbolIndex()
+{ return &m_symbolIndex; }
+
+/*!
+    \fn    FunctionBodyParser CppModelManager::functionBodyParser()
+    \brief Returns a parser for documents with all their function bodies,
+           configured with the current snapshot, working copy and project
+           settings. Must be called from the GUI thread.
+ */
+FunctionBodyParser CppModelManager::functionBodyParser()
+{
+    FunctionBodyParser parser;
+    parser.m_snapshot = m_snapshot;
+    parser.m_workingCopy = buildWorkingCopyList();
+    parser.m_projectFiles = projectFiles();
+    parser.m_includePaths = includePaths();
+    parser.m_frameworkPaths = frameworkPaths();
+    parser.m_nameTable = m_nameTable;
+    return parser;
+}
+
+Document::Ptr FunctionBodyParser::operator()(const QString &fileName) const
+{
+    CppPreprocessor preproc(0);
+    preproc.setSnapshot(m_snapshot);
+    preproc.setProjectFiles(m_projectFiles);
+    preproc.setIncludePaths(m_includePaths);
+    preproc.setFrameworkPaths(m_frameworkPaths);
+    preproc.setWorkingCopy(m_workingCopy);
+    preproc.setNameTable(m_nameTable);
+
+    QString conf = QLatin1String(pp_configuration_file);
+    preproc.run(conf);
+
+    QString fn = fileName;
+    preproc.run(fn);
+
+    return preproc.document(fileName);
+}
+
 void CppModelManager::ensureUpdated()
 {
     QMutexLocker locker(&mutex);
@@ -565,7 +1402,11 @@ QMap<QString, QByteArray> CppModelManager::buildWorkingCopyList()
 }
 
 void CppModelManager::updateSourceFiles(const QStringList &sourceFiles)
-{ (void) refreshSourceFiles(sourceFiles); }
+{
+    QHash<QString, int> levels;
+    const QStringList files = dependentFiles(sourceFiles, &levels);
+    (void) refreshSourceFiles(files, levels);
+}
 
 QList<CppModelManager::ProjectInfo> CppModelManager::projectInfos() const
 {
@@ -592,19 +1433,39 @@ void CppModelManager::updateProjectInfo(const ProjectInfo &pinfo)
     m_dirty = true;
 }
 
-QFuture<void> CppModelManager::refreshSourceFiles(const QStringList &sourceFiles)
+QFuture<void> CppModelManager::refreshSourceFiles(const QStringList &sourceFiles,
+                                                  const QHash<QString, int> &levels)
 {
     if (! sourceFiles.isEmpty() && qgetenv("QTCREATOR_NO_CODE_INDEXER").isNull()) {
+        // Nothing refers to the identifiers of the current name table once
+        // every document has been parsed again, so drop those that are not
+        // used anymore along with it.
+        const bool fullReindex = isFullReindex(sourceFiles);
+        if (fullReindex)
+            m_nameTable = SharedNameTable::Ptr(new SharedNameTable);
+
         const QMap<QString, QByteArray> workingCopy = buildWorkingCopyList();
 
-        CppPreprocessor *preproc = new CppPreprocessor(this);
-        preproc->setProjectFiles(projectFiles());
-        preproc->setIncludePaths(includePaths());
-        preproc->setFrameworkPaths(frameworkPaths());
-        preproc->setWorkingCopy(workingCopy);
+        if (m_documentCache) {
+            m_documentCache->setConfiguration(workingCopy.value(QLatin1String(pp_configuration_file)),
+                                              includePaths(), frameworkPaths());
+        }
+
+        const int workerCount = qMin(indexerThreadCount(), sourceFiles.count());
+
+        QList<CppPreprocessor *> workers;
+        for (int i = 0; i < workerCount; ++i) {
+            CppPreprocessor *preproc = createPreprocessor(workingCopy);
+            preproc->setOutdatedFiles(sourceFiles);
+            workers.append(preproc);
+        }
 
         QFuture<void> result = QtConcurrent::run(&CppModelManager::parse,
-                                                 preproc, sourceFiles);
+                                                 workers, sourceFiles, levels,
+                                                 m_indexerPriorities);
+
+        if (fullReindex)
+            m_fullReindexWatcher.setFuture(result);
 
         if (sourceFiles.count() > 1) {
             m_core->progressManager()->addTask(result, tr("Indexing"),
@@ -616,6 +1477,242 @@ QFuture<void> CppModelManager::refreshSourceFiles(const QStringList &sourceFiles
     return QFuture<void>();
 }
 
+/*!
+    \fn    QFuture<void> CppModelManager::refreshEditedFile(const QString &fileName, unsigned editorRevision, unsigned previousEditorRevision, unsigned firstLine, unsigned lastLine, int lineDelta)
+    \brief Updates the document of \a fileName from revision \a editorRevision of
+           the contents of its editor, after the lines [\a firstLine, \a lastLine] of
+           revision \a previousEditorRevision have been edited, adding \a lineDelta
+           lines to the document.
+
+    Only the function bodies that overlap the edited lines are parsed again;
+    the diagnostics of the other bodies are taken from the previous document.
+    The whole file is parsed if the document of the snapshot is not the one
+    parsed from \a previousEditorRevision, or if \a previousEditorRevision is 0.
+ */
+QFuture<void> CppModelManager::refreshEditedFile(const QString &fileName,
+                                                 unsigned editorRevision,
+                                                 unsigned previousEditorRevision,
+                                                 unsigned firstLine, unsigned lastLine,
+                                                 int lineDelta)
+{
+    if (! qgetenv("QTCREATOR_NO_CODE_INDEXER").isNull())
+        return QFuture<void>();
+
+    reindexIfNameTableGrew();
+
+    Document::Ptr previousDoc = m_snapshot.value(fileName);
+    const bool reusePreviousDoc = m_skipFunctionBodies && previousDoc
+            && previousEditorRevision != 0
+            && previousDoc->editorRevision() == previousEditorRevision
+            && ! previousDoc->skipsAllFunctionBodies();
+
+    const QMap<QString, QByteArray> workingCopy = buildWorkingCopyList();
+
+    if (m_documentCache) {
+        m_documentCache->setConfiguration(workingCopy.value(QLatin1String(pp_configuration_file)),
+                                          includePaths(), frameworkPaths());
+    }
+
+    CppPreprocessor *preproc = createPreprocessor(workingCopy);
+    preproc->setEditorRevision(fileName, editorRevision);
+    if (reusePreviousDoc)
+        preproc->setEditedLines(previousDoc, firstLine, lastLine, lineDelta);
+
+    QList<CppPreprocessor *> workers;
+    workers.append(preproc);
+    return QtConcurrent::run(&CppModelManager::parse, workers, QStringList(fileName),
+                             QHash<QString, int>(), m_indexerPriorities);
+}
+
+bool CppModelManager::isFullReindex(const QStringList &sourceFiles) const
+{
+    if (m_snapshot.isEmpty())
+        return true;
+
+    const QSet<QString> files = sourceFiles.toSet();
+    foreach (const QString &fileName, m_snapshot.keys()) {
+        if (fileName != QLatin1String(pp_configuration_file) && ! files.contains(fileName))
+            return false;
+    }
+    return true;
+}
+
+void CppModelManager::reindexIfNameTableGrew()
+{
+    if (! m_liveIdentifierCount || m_fullReindexWatcher.isRunning())
+        return;
+    else if (m_nameTable->identifierCount() <= NameTableGrowthFactor * m_liveIdentifierCount)
+        return;
+
+    m_liveIdentifierCount = 0;
+
+    QStringList files = m_snapshot.keys();
+    files.removeAll(QLatin1String(pp_configuration_file));
+    QHash<QString, int> levels;
+    files = dependentFiles(files, &levels);
+    (void) refreshSourceFiles(files, levels);
+}
+
+void CppModelManager::onFullReindexFinished()
+{
+    if (! m_fullReindexWatcher.isCanceled())
+        m_liveIdentifierCount = m_nameTable->identifierCount();
+}
+
+CppPreprocessor *CppModelManager::createPreprocessor(const QMap<QString, QByteArray> &workingCopy)
+{
+    CppPreprocessor *preproc = new CppPreprocessor(this);
+    preproc->setProjectFiles(projectFiles());
+    preproc->setIncludePaths(includePaths());
+    preproc->setFrameworkPaths(frameworkPaths());
+    preproc->setWorkingCopy(workingCopy);
+    preproc->setDocumentCache(m_documentCache);
+    preproc->setNameTable(m_nameTable);
+    preproc->setSkipFunctionBodies(m_skipFunctionBodies);
+    return preproc;
+}
+
+/*!
+    \fn    QStringList CppModelManager::dependentFiles(const QStringList &changedFiles, QHash<QString, int> *levels) const
+    \brief Returns the files that have to be parsed again after \a changedFiles
+           changed: the changed files and all the files including them, directly
+           or indirectly.
+
+    The files are sorted so that a file comes after the files it includes.
+    Among the files that are ready to be parsed, the ones opened in an editor
+    come first. If \a levels is not null, it receives the dependency level of
+    every file: a file has a higher level than the files it includes.
+ */
+QStringList CppModelManager::dependentFiles(const QStringList &changedFiles,
+                                            QHash<QString, int> *levels) const
+{
+    // collect the changed files and the files including them
+    QSet<QString> affected;
+    QStringList todo = changedFiles;
+    while (! todo.isEmpty()) {
+        const QString fileName = todo.takeLast();
+        if (affected.contains(fileName))
+            continue;
+
+        affected.insert(fileName);
+        todo += m_includingFiles.value(fileName).toList();
+    }
+
+    if (affected.size() == changedFiles.size())
+        return changedFiles;
+
+    // count the affected files each affected file includes
+    QHash<QString, int> pendingIncludes;
+    foreach (const QString &fileName, affected) {
+        int count = 0;
+        if (Document::Ptr doc = m_snapshot.value(fileName)) {
+            foreach (const QString &includedFile, doc->includedFiles().toSet()) {
+                if (includedFile != fileName && affected.contains(includedFile))
+                    ++count;
+            }
+        }
+        pendingIncludes.insert(fileName, count);
+    }
+
+    const QSet<QString> openedFiles = this->openedFiles();
+    const QSet<QString> changed = changedFiles.toSet();
+    QStringList readyOpenedFiles, readyFiles;
+    foreach (const QString &fileName, changedFiles) {
+        if (pendingIncludes.value(fileName) == 0)
+            readyOpenedFiles.append(fileName); // parse the changed files first
+    }
+    foreach (const QString &fileName, affected) {
+        if (pendingIncludes.value(fileName) == 0 && ! changed.contains(fileName)) {
+            if (openedFiles.contains(fileName))
+                readyOpenedFiles.append(fileName);
+            else
+                readyFiles.append(fileName);
+        }
+    }
+
+    QStringList sortedFiles;
+    QSet<QString> sorted;
+    QHash<QString, int> fileLevels;
+    int maximumLevel = 0;
+    while (! readyOpenedFiles.isEmpty() || ! readyFiles.isEmpty()) {
+        const QString fileName = readyOpenedFiles.isEmpty() ? readyFiles.takeFirst()
+                                                            : readyOpenedFiles.takeFirst();
+        if (sorted.contains(fileName))
+            continue;
+
+        sorted.insert(fileName);
+        sortedFiles.append(fileName);
+
+        const int level = fileLevels.value(fileName);
+        maximumLevel = qMax(maximumLevel, level);
+
+        foreach (const QString &includingFile, m_includingFiles.value(fileName)) {
+            if (includingFile == fileName || ! affected.contains(includingFile))
+                continue;
+
+            int &includingLevel = fileLevels[includingFile];
+            includingLevel = qMax(includingLevel, level + 1);
+
+            if (--pendingIncludes[includingFile] != 0)
+                continue;
+            else if (openedFiles.contains(includingFile))
+                readyOpenedFiles.append(includingFile);
+            else
+                readyFiles.append(includingFile);
+        }
+    }
+
+    // files including each other end up last
+    foreach (const QString &fileName, affected) {
+        if (! sorted.contains(fileName)) {
+            sortedFiles.append(fileName);
+            fileLevels.insert(fileName, maximumLevel + 1);
+        }
+    }
+
+    if (levels)
+        *levels = fileLevels;
+
+    return sortedFiles;
+}
+
+/*!
+    \fn    int CppModelManager::indexerThreadCount() const
+    \brief Returns the number of preprocessors used in parallel to index
+           the project files. Defaults to QThread::idealThreadCount().
+ */
+int CppModelManager::indexerThreadCount() const
+{
+    if (m_indexerThreadCount > 0)
+        return m_indexerThreadCount;
+
+    return qMax(1, QThread::idealThreadCount());
+}
+
+void CppModelManager::setIndexerThreadCount(int count)
+{
+    m_indexerThreadCount = qMax(0, count);
+
+    if (QSettings *settings = m_core->settings())
+        settings->setValue(QLatin1String(indexerThreadCountKeyC), m_indexerThreadCount);
+}
+
+/*!
+    \fn    bool CppModelManager::skipFunctionBodies() const
+    \brief Returns true if the indexer skips the function bodies of the
+           files that are not opened in an editor. Defaults to true.
+ */
+bool CppModelManager::skipFunctionBodies() const
+{ return m_skipFunctionBodies; }
+
+void CppModelManager::setSkipFunctionBodies(bool skipFunctionBodies)
+{
+    m_skipFunctionBodies = skipFunctionBodies;
+
+    if (QSettings *settings = m_core->settings())
+        settings->setValue(QLatin1String(skipFunctionBodiesKeyC), m_skipFunctionBodies);
+}
+
 /*!
     \fn    void CppModelManager::editorOpened(Core::IEditor *editor)
     \brief If a C++ editor is opened, the model manager listens to content changes
@@ -641,6 +1738,8 @@ void CppModelManager::editorOpened(Core::IEditor *editor)
         // ### move in CppEditorSupport
         connect(editor, SIGNAL(contextHelpIdRequested(TextEditor::ITextEditor*, int)),
                 m_hoverHandler, SLOT(updateContextHelpId(TextEditor::ITextEditor*, int)));
+
+        updateIndexerPriorities();
     }
 }
 
@@ -653,6 +1752,8 @@ void CppModelManager::editorAboutToClose(Core::IEditor *editor)
         CppEditorSupport *editorSupport = m_editorSupport.value(textEditor);
         m_editorSupport.remove(textEditor);
         delete editorSupport;
+
+        updateIndexerPriorities();
     }
 }
 
@@ -669,7 +1770,16 @@ void CppModelManager::emitDocumentUpdated(Document::Ptr doc)
 void CppModelManager::onDocumentUpdated(Document::Ptr doc)
 {
     const QString fileName = doc->fileName();
+    removeDependencies(m_snapshot.value(fileName));
+    addDependencies(doc);
     m_snapshot[fileName] = doc;
+    m_visibleScopesCache.remove(fileName);
+    m_symbolIndex.updateDocument(doc);
+
+    // the includes of an opened file come next to the opened files
+    if (openedFiles().contains(fileName))
+        updateIndexerPriorities();
+
     QList<Core::IEditor *> openedEditors = m_core->editorManager()->openedEditors();
     foreach (Core::IEditor *editor, openedEditors) {
         if (editor->file()->fileName() == fileName) {
@@ -757,6 +1867,72 @@ void CppModelManager::onProjectAdded(ProjectExplorer::Project *)
     m_dirty = true;
 }
 
+QSet<QString> CppModelManager::openedFiles() const
+{
+    QSet<QString> files;
+    QMapIterator<TextEditor::ITextEditor *, CppEditorSupport *> it(m_editorSupport);
+    while (it.hasNext()) {
+        it.next();
+        files.insert(it.key()->file()->fileName());
+    }
+    return files;
+}
+
+/*!
+    \fn    void CppModelManager::updateIndexerPriorities()
+    \brief Lets the indexer process the file of the current editor first, then
+           the files of the other editors, then the files they include.
+
+    The indexing tasks already running pick up the new order with the next
+    file they process.
+ */
+void CppModelManager::updateIndexerPriorities()
+{
+    QHash<QString, int> priorities;
+
+    const QSet<QString> openedFiles = this->openedFiles();
+    foreach (const QString &fileName, openedFiles) {
+        if (Document::Ptr doc = m_snapshot.value(fileName)) {
+            foreach (const QString &includedFile, doc->includedFiles())
+                priorities.insert(includedFile, IndexerPriorities::IncludedByEditorPriority);
+        }
+    }
+
+    foreach (const QString &fileName, openedFiles)
+        priorities.insert(fileName, IndexerPriorities::OpenedEditorPriority);
+
+    if (Core::IEditor *editor = m_core->editorManager()->currentEditor()) {
+        if (isCppEditor(editor))
+            priorities.insert(editor->file()->fileName(), IndexerPriorities::CurrentEditorPriority);
+    }
+
+    m_indexerPriorities->setPriorities(priorities);
+}
+
+void CppModelManager::addDependencies(Document::Ptr doc)
+{
+    const QString fileName = doc->fileName();
+    foreach (const QString &includedFile, doc->includedFiles())
+        m_includingFiles[includedFile].insert(fileName);
+}
+
+void CppModelManager::removeDependencies(Document::Ptr doc)
+{
+    if (! doc)
+        return;
+
+    const QString fileName = doc->fileName();
+    foreach (const QString &includedFile, doc->includedFiles()) {
+        QHash<QString, QSet<QString> >::iterator it = m_includingFiles.find(includedFile);
+        if (it == m_includingFiles.end())
+            continue;
+
+        it->remove(fileName);
+        if (it->isEmpty())
+            m_includingFiles.erase(it);
+    }
+}
+
 void CppModelManager::onAboutToRemoveProject(ProjectExplorer::Project *project)
 {
     do {
@@ -784,52 +1960,38 @@ void CppModelManager::onSessionUnloaded()
 }
 
 void CppModelManager::parse(QFutureInterface<void> &future,
-                            CppPreprocessor *preproc,
-                            QStringList files)
+                            QList<CppPreprocessor *> workers,
+                            QStringList files,
+                            QHash<QString, int> levels,
+                            QSharedPointer<IndexerPriorities> priorities)
 {
     QTC_ASSERT(!files.isEmpty(), return);
-
-    // Change the priority of the background parser thread to idle.
-    QThread::currentThread()->setPriority(QThread::IdlePriority);
+    QTC_ASSERT(!workers.isEmpty(), return);
 
     future.setProgressRange(0, files.size());
 
-    QString conf = QLatin1String(pp_configuration_file);
-    (void) preproc->run(conf);
-
-    const int STEP = 10;
-
-    for (int i = 0; i < files.size(); ++i) {
-        if (future.isPaused())
-            future.waitForResume();
-
-        if (future.isCanceled())
-            break;
+    IndexerQueue queue(future, files, levels, priorities);
+    IncludedFiles includedFiles;
+    IncludePathCache includePathCache;
 
-        future.setProgressValue(i);
-
-#ifdef CPPTOOLS_DEBUG_PARSING_TIME
-        QTime tm;
-        tm.start();
-#endif
-
-        QString fileName = files.at(i);
-        preproc->run(fileName);
+    foreach (CppPreprocessor *preproc, workers) {
+        preproc->setSharedIncludedFiles(&includedFiles);
+        preproc->setSharedIncludePathCache(&includePathCache);
+    }
 
-        if (! (i % STEP)) // Yields execution of the current thread.
-            QThread::yieldCurrentThread();
+    // The first worker runs in the current thread, the others get their
+    // own pool so that they can't starve the global thread pool.
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, workers.size() - 1));
+    for (int i = 1; i < workers.size(); ++i)
+        pool.start(new IndexerWorker(&queue, workers.at(i)));
 
-#ifdef CPPTOOLS_DEBUG_PARSING_TIME
-        qDebug() << fileName << "parsed in:" << tm.elapsed();
-#endif
-    }
+    IndexerWorker::indexFiles(&queue, workers.first());
+    pool.waitForDone();
 
     future.setProgressValue(files.size());
 
-    // Restore the previous thread priority.
-    QThread::currentThread()->setPriority(QThread::NormalPriority);
-
-    delete preproc;
+    qDeleteAll(workers);
 }
 
 void CppModelManager::GC()
@@ -865,7 +2027,20 @@ void CppModelManager::GC()
     }
 
     emit aboutToRemoveFiles(removedFiles);
+    m_symbolIndex.removeFiles(removedFiles);
+
+    foreach (const QString &fn, removedFiles) {
+        removeDependencies(m_snapshot.value(fn));
+        m_includingFiles.remove(fn);
+        m_visibleScopesCache.remove(fn);
+    }
     m_snapshot = documents;
+
+    // The identifiers of the removed documents stay in the name table for
+    // as long as it lives, so start over with a new one. The old table is
+    // released together with the last document that uses it.
+    if (! removedFiles.isEmpty())
+        m_nameTable = SharedNameTable::Ptr(new SharedNameTable);
 }
 
 
@@ -37,10 +37,21 @@
 #include <cpptools/cppmodelmanagerinterface.h>
 #include <projectexplorer/project.h>
 #include <cplusplus/CppDocument.h>
+#include <cplusplus/VisibleScopesCache.h>
 
+#include "cppsymbolindex.h"
+
+#include <QHash>
 #include <QMap>
+#include <QSet>
 #include <QFutureInterface>
+#include <QFutureWatcher>
 #include <QMutex>
+#include <QSharedPointer>
+
+namespace CPlusPlus {
+class DocumentCache;
+}
 
 namespace Core {
 class ICore;
@@ -60,8 +71,29 @@ namespace Internal {
 
 class CppEditorSupport;
 class CppPreprocessor;
+class IndexerPriorities;
 class CppHoverHandler;
 
+// Parses files again with all their function bodies, using the snapshot
+// for the included files. Unlike CppModelManager::documentWithFunctionBodies()
+// it doesn't update the snapshot, and can be used from any thread once it
+// has been created by CppModelManager::functionBodyParser().
+class FunctionBodyParser
+{
+public:
+    CPlusPlus::Document::Ptr operator()(const QString &fileName) const;
+
+private:
+    friend class CppModelManager;
+
+    CPlusPlus::Snapshot m_snapshot;
+    QMap<QString, QByteArray> m_workingCopy;
+    QStringList m_projectFiles;
+    QStringList m_includePaths;
+    QStringList m_frameworkPaths;
+    CPlusPlus::SharedNameTable::Ptr m_nameTable;
+};
+
 class CppModelManager : public CppModelManagerInterface
 {
     Q_OBJECT
@@ -77,12 +109,36 @@ public:
     virtual void updateProjectInfo(const ProjectInfo &pinfo);
 
     virtual CPlusPlus::Snapshot snapshot() const;
+    virtual CPlusPlus::Document::Ptr documentWithFunctionBodies(const QString &fileName,
+                                                                unsigned line);
+    virtual CPlusPlus::VisibleScopesCache *visibleScopesCache();
+    virtual QFuture<CPlusPlus::Usage> findUsages(CPlusPlus::Document::Ptr doc,
+                                                 CPlusPlus::Symbol *symbol);
+    virtual QList<SymbolLocation> findSymbols(const QString &qualifiedName);
     virtual void GC();
 
-    QFuture<void> refreshSourceFiles(const QStringList &sourceFiles);
+    QFuture<void> refreshSourceFiles(const QStringList &sourceFiles,
+                                     const QHash<QString, int> &levels = QHash<QString, int>());
+    QFuture<void> refreshEditedFile(const QString &fileName, unsigned editorRevision,
+                                    unsigned previousEditorRevision,
+                                    unsigned firstLine, unsigned lastLine,
+                                    int lineDelta);
+
+    QStringList dependentFiles(const QStringList &changedFiles,
+                               QHash<QString, int> *levels = 0) const;
+
+    int indexerThreadCount() const;
+    void setIndexerThreadCount(int count);
+
+    bool skipFunctionBodies() const;
+    void setSkipFunctionBodies(bool skipFunctionBodies);
 
     inline Core::ICore *core() const { return m_core; }
 
+    SymbolIndex *symbolIndex();
+
+    FunctionBodyParser functionBodyParser();
+
     bool isCppEditor(Core::IEditor *editor) const; // ### private
 
     void emitDocumentUpdated(CPlusPlus::Document::Ptr doc);
@@ -100,12 +156,20 @@ public Q_SLOTS:
 private Q_SLOTS:
     // this should be executed in the GUI thread.
     void onDocumentUpdated(CPlusPlus::Document::Ptr doc);
+    void updateIndexerPriorities();
     void onAboutToRemoveProject(ProjectExplorer::Project *project);
     void onSessionUnloaded();
     void onProjectAdded(ProjectExplorer::Project *project);
+    void onFullReindexFinished();
 
 private:
     QMap<QString, QByteArray> buildWorkingCopyList();
+    CppPreprocessor *createPreprocessor(const QMap<QString, QByteArray> &workingCopy);
+    void addDependencies(CPlusPlus::Document::Ptr doc);
+    void removeDependencies(CPlusPlus::Document::Ptr doc);
+    QSet<QString> openedFiles() const;
+    bool isFullReindex(const QStringList &sourceFiles) const;
+    void reindexIfNameTableGrew();
 
     QStringList projectFiles()
     {
@@ -138,8 +202,10 @@ private:
     QByteArray internalDefinedMacros() const;
 
     static void parse(QFutureInterface<void> &future,
-                      CppPreprocessor *preproc,
-                      QStringList files);
+                      QList<CppPreprocessor *> workers,
+                      QStringList files,
+                      QHash<QString, int> levels,
+                      QSharedPointer<IndexerPriorities> priorities);
 
 private:
     Core::ICore *m_core;
@@ -147,6 +213,9 @@ private:
     CppHoverHandler *m_hoverHandler;
     CPlusPlus::Snapshot m_snapshot;
 
+    // the files including each file of the snapshot
+    QHash<QString, QSet<QString> > m_includingFiles;
+
     // cache
     bool m_dirty;
     QStringList m_projectFiles;
@@ -154,6 +223,20 @@ private:
     QStringList m_frameworkPaths;
     QByteArray m_definedMacros;
 
+    // indexer
+    int m_indexerThreadCount;
+    bool m_skipFunctionBodies;
+    QSharedPointer<CPlusPlus::DocumentCache> m_documentCache;
+    CPlusPlus::SharedNameTable::Ptr m_nameTable;
+    // the identifiers of the name table right after the last full reindex
+    unsigned m_liveIdentifierCount;
+    QFutureWatcher<void> m_fullReindexWatcher;
+    QSharedPointer<IndexerPriorities> m_indexerPriorities;
+
+    // lookup
+    CPlusPlus::VisibleScopesCache m_visibleScopesCache;
+    SymbolIndex m_symbolIndex;
+
     // editor integration
     QMap<TextEditor::ITextEditor *, CppEditorSupport *> m_editorSupport;
 
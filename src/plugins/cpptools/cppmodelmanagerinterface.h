@@ -36,10 +36,16 @@
 
 #include <cpptools/cpptools_global.h>
 #include <cplusplus/CppDocument.h>
+#include <QtCore/QFuture>
 #include <QtCore/QObject>
 #include <QtCore/QMap>
 #include <QtCore/QPointer>
 
+namespace CPlusPlus {
+    class Usage;
+    class VisibleScopesCache;
+}
+
 namespace ProjectExplorer {
     class Project;
 }
@@ -79,6 +85,21 @@ public:
         QStringList frameworkPaths;
     };
 
+    class SymbolLocation
+    {
+    public:
+        enum Kind { Enum, Class, Function };
+
+        SymbolLocation()
+            : line(0), kind(Class)
+        { }
+
+    public: // attributes
+        QString fileName;
+        int line;
+        Kind kind;
+    };
+
 public:
     CppModelManagerInterface(QObject *parent = 0) : QObject(parent) {}
     virtual ~CppModelManagerInterface() {}
@@ -88,6 +109,26 @@ public:
 
     virtual CPlusPlus::Snapshot snapshot() const = 0;
 
+    // Returns the document of fileName. If the function body at line was
+    // skipped, the file is parsed again in the background with all its
+    // bodies, and documentUpdated() delivers the new document.
+    virtual CPlusPlus::Document::Ptr documentWithFunctionBodies(const QString &fileName,
+                                                                unsigned line) = 0;
+
+    // The visible scopes shared by the lookup contexts created for the
+    // documents of the snapshot.
+    virtual CPlusPlus::VisibleScopesCache *visibleScopesCache() = 0;
+
+    // Starts looking for the places where the symbol is used in the
+    // documents of the snapshot, in a separate thread; doc is the document
+    // the symbol was found from, it's kept alive until the search is done.
+    virtual QFuture<CPlusPlus::Usage> findUsages(CPlusPlus::Document::Ptr doc,
+                                                 CPlusPlus::Symbol *symbol) = 0;
+
+    // Returns where the classes, the enums and the function definitions
+    // named qualifiedName, e.g. Foo::Bar::baz, are in the snapshot.
+    virtual QList<SymbolLocation> findSymbols(const QString &qualifiedName) = 0;
+
     virtual QList<ProjectInfo> projectInfos() const = 0;
     virtual ProjectInfo projectInfo(ProjectExplorer::Project *project) const = 0;
     virtual void updateProjectInfo(const ProjectInfo &pinfo) = 0;
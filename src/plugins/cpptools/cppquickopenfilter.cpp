@@ -33,6 +33,7 @@
 
 #include "cppquickopenfilter.h"
 #include "cppmodelmanager.h"
+#include "cppsymbolindex.h"
 
 #include <coreplugin/editormanager/editormanager.h>
 #include <coreplugin/editormanager/ieditor.h>
@@ -44,30 +45,24 @@ using namespace CppTools::Internal;
 CppQuickOpenFilter::CppQuickOpenFilter(CppModelManager *manager, Core::EditorManager *editorManager)
     : m_manager(manager),
     m_editorManager(editorManager),
-    m_forceNewSearchList(true)
+    m_symbolsToSearchFor(SearchSymbols::Classes | SearchSymbols::Functions | SearchSymbols::Enums),
+    m_separateScope(false)
 {
     setShortcutString(":");
     setIncludedByDefault(false);
-
-    connect(manager, SIGNAL(documentUpdated(CPlusPlus::Document::Ptr)),
-            this, SLOT(onDocumentUpdated(CPlusPlus::Document::Ptr)));
-
-    connect(manager, SIGNAL(aboutToRemoveFiles(QStringList)),
-            this, SLOT(onAboutToRemoveFiles(QStringList)));
 }
 
 CppQuickOpenFilter::~CppQuickOpenFilter()
 { }
 
-void CppQuickOpenFilter::onDocumentUpdated(CPlusPlus::Document::Ptr doc)
+void CppQuickOpenFilter::setSymbolsToSearchFor(SearchSymbols::SymbolTypes types)
 {
-    m_searchList[doc->fileName()] = Info(doc);
+    m_symbolsToSearchFor = types;
 }
 
-void CppQuickOpenFilter::onAboutToRemoveFiles(const QStringList &files)
+void CppQuickOpenFilter::setSeparateScope(bool separateScope)
 {
-    foreach (const QString &file, files)
-        m_searchList.remove(file);
+    m_separateScope = separateScope;
 }
 
 void CppQuickOpenFilter::refresh(QFutureInterface<void> &future)
@@ -81,38 +76,23 @@ static bool compareLexigraphically(const QuickOpen::FilterEntry &a,
     return a.displayName < b.displayName;
 }
 
-QList<QuickOpen::FilterEntry> CppQuickOpenFilter::matchesFor(const QString &origEntry)
+QList<QuickOpen::FilterEntry> CppQuickOpenFilter::matchesFor(QFutureInterface<QuickOpen::FilterEntry> &future, const QString &origEntry)
 {
     QString entry = trimWildcards(origEntry);
     QList<QuickOpen::FilterEntry> entries;
-    QStringMatcher matcher(entry, Qt::CaseInsensitive);
-    const QRegExp regexp("*"+entry+"*", Qt::CaseInsensitive, QRegExp::Wildcard);
-    if (!regexp.isValid())
-        return entries;
-    bool hasWildcard = (entry.contains('*') || entry.contains('?'));
-
-    QMutableMapIterator<QString, Info> it(m_searchList);
-    while (it.hasNext()) {
-        it.next();
-
-        Info info = it.value();
-        if (info.dirty) {
-            info.dirty = false;
-            info.items = search(info.doc);
-            it.setValue(info);
-        }
-
-        QList<ModelItemInfo> items = info.items;
-
-        foreach (ModelItemInfo info, items) {
-            if ((hasWildcard && regexp.exactMatch(info.symbolName))
-                    || (!hasWildcard && matcher.indexIn(info.symbolName) != -1)) {
-                QVariant id = qVariantFromValue(info);
-                QuickOpen::FilterEntry filterEntry(this, info.symbolName, id, info.icon);
-                filterEntry.extraInfo = info.symbolType;
-                entries.append(filterEntry);
-            }
-        }
+    const SymbolIndex::NameField field = m_separateScope ? SymbolIndex::SymbolName
+                                                         : SymbolIndex::QualifiedName;
+
+    const QList<ModelItemInfo> matches =
+            m_manager->symbolIndex()->matches(entry, m_symbolsToSearchFor, field, &future);
+    foreach (const ModelItemInfo &info, matches) {
+        if (future.isCanceled())
+            break;
+        const QString &name = m_separateScope ? info.symbolName : info.qualifiedName;
+        QVariant id = qVariantFromValue(info);
+        QuickOpen::FilterEntry filterEntry(this, name, id, info.icon);
+        filterEntry.extraInfo = m_separateScope ? info.symbolScope : info.symbolType;
+        entries.append(filterEntry);
     }
 
     if (entries.size() < 1000)
@@ -57,34 +57,21 @@ public:
     QString trName() const { return tr("Classes and Methods"); }
     QString name() const { return QLatin1String("Classes and Methods"); }
     Priority priority() const { return Medium; }
-    QList<QuickOpen::FilterEntry> matchesFor(const QString &entry);
+    QList<QuickOpen::FilterEntry> matchesFor(QFutureInterface<QuickOpen::FilterEntry> &future, const QString &entry);
     void accept(QuickOpen::FilterEntry selection) const;
     void refresh(QFutureInterface<void> &future);
 
 protected:
-    SearchSymbols search;
+    void setSymbolsToSearchFor(SearchSymbols::SymbolTypes types);
 
-private slots:
-    void onDocumentUpdated(CPlusPlus::Document::Ptr doc);
-    void onAboutToRemoveFiles(const QStringList &files);
+    // Shows the names without their scope, which goes to the extra info.
+    void setSeparateScope(bool separateScope);
 
 private:
     CppModelManager *m_manager;
     Core::EditorManager *m_editorManager;
-
-    struct Info {
-        Info(): dirty(true) {}
-        Info(CPlusPlus::Document::Ptr doc): doc(doc), dirty(true) {}
-
-        CPlusPlus::Document::Ptr doc;
-        QList<ModelItemInfo> items;
-        bool dirty;
-    };
-
-    QMap<QString, Info> m_searchList;
-    QList<ModelItemInfo> m_previousResults;
-    bool m_forceNewSearchList;
-    QString m_previousEntry;
+    SearchSymbols::SymbolTypes m_symbolsToSearchFor;
+    bool m_separateScope;
 };
 
 } // namespace Internal
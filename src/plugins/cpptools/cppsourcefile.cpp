@@ -0,0 +1,152 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#include "cppsourcefile.h"
+
+#include <QtCore/QTextCodec>
+#include <QtCore/QTextStream>
+
+using namespace CppTools::Internal;
+
+enum { Utf8Mib = 106 };
+
+CppSourceFile::CppSourceFile()
+    : m_mappedData(0)
+{ }
+
+CppSourceFile::~CppSourceFile()
+{ close(); }
+
+/*!
+    \fn    bool CppSourceFile::open(const QString &fileName)
+    \brief Reads the contents of \a fileName.
+
+    ASCII and UTF-8 files are mapped in memory. Files in another encoding are
+    decoded with the codec of the locale, like QTextStream does, and converted
+    to UTF-8.
+ */
+bool CppSourceFile::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (! m_file.open(QFile::ReadOnly))
+        return false;
+
+    const qint64 size = m_file.size();
+    if (size <= 0)
+        return true;
+
+    QByteArray buffer;
+    const char *data = 0;
+
+    m_mappedData = m_file.map(0, size);
+    if (m_mappedData) {
+        data = reinterpret_cast<const char *>(m_mappedData);
+    } else {
+        buffer = m_file.readAll();
+        data = buffer.constData();
+    }
+
+    const qint64 dataSize = m_mappedData ? size : buffer.size();
+
+    if (needsDecoding(data, dataSize)) {
+        QTextStream stream(QByteArray::fromRawData(data, dataSize));
+        m_contents = stream.readAll().toUtf8();
+        close();
+        return true;
+    }
+
+    // skip the byte order mark
+    int start = 0;
+    if (dataSize >= 3 && data[0] == '\xef' && data[1] == '\xbb' && data[2] == '\xbf')
+        start = 3;
+
+    if (m_mappedData)
+        m_contents = QByteArray::fromRawData(data + start, dataSize - start);
+    else
+        m_contents = buffer.mid(start);
+
+    return true;
+}
+
+void CppSourceFile::close()
+{
+    m_contents.clear();
+
+    if (m_mappedData) {
+        m_file.unmap(m_mappedData);
+        m_mappedData = 0;
+    }
+
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+void CppSourceFile::setContents(const QByteArray &contents)
+{
+    close();
+    m_contents = contents;
+}
+
+QByteArray CppSourceFile::contents() const
+{ return m_contents; }
+
+bool CppSourceFile::isMapped() const
+{ return m_mappedData != 0; }
+
+bool CppSourceFile::needsDecoding(const char *data, qint64 size) const
+{
+    if (size >= 2) {
+        const uchar b0 = data[0], b1 = data[1];
+        if (size >= 3 && b0 == 0xef && b1 == 0xbb && uchar(data[2]) == 0xbf)
+            return false; // UTF-8 byte order mark
+        else if ((b0 == 0xff && b1 == 0xfe) || (b0 == 0xfe && b1 == 0xff))
+            return true; // UTF-16 and UTF-32 (LE) byte order marks
+        else if (size >= 4 && b0 == 0 && b1 == 0 && uchar(data[2]) == 0xfe && uchar(data[3]) == 0xff)
+            return true; // UTF-32 (BE) byte order mark
+    }
+
+    if (QTextCodec::codecForLocale()->mibEnum() == Utf8Mib)
+        return false;
+
+    // plain ASCII reads the same in every codec of the locale
+    const char *end = data + size;
+    for (const char *it = data; it != end; ++it) {
+        if (*it & 0x80)
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#ifndef CPPSOURCEFILE_H
+#define CPPSOURCEFILE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+
+namespace CppTools {
+namespace Internal {
+
+// The UTF-8 contents of a source file. Files that don't need to be decoded
+// are memory mapped and handed out without copying them, so the contents
+// are valid only as long as the CppSourceFile exists.
+class CppSourceFile
+{
+    Q_DISABLE_COPY(CppSourceFile)
+
+public:
+    CppSourceFile();
+    ~CppSourceFile();
+
+    bool open(const QString &fileName);
+    void close();
+
+    void setContents(const QByteArray &contents);
+    QByteArray contents() const;
+
+    bool isMapped() const;
+
+private:
+    bool needsDecoding(const char *data, qint64 size) const;
+
+    QFile m_file;
+    uchar *m_mappedData;
+    QByteArray m_contents;
+};
+
+} // namespace Internal
+} // namespace CppTools
+
+#endif // CPPSOURCEFILE_H
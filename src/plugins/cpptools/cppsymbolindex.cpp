@@ -0,0 +1,263 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#include "cppsymbolindex.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QReadLocker>
+#include <QtCore/QRegExp>
+#include <QtCore/QSet>
+#include <QtCore/QStringMatcher>
+#include <QtCore/QWriteLocker>
+
+using namespace CPlusPlus;
+using namespace CppTools::Internal;
+
+SymbolIndex::SymbolIndex()
+{ }
+
+void SymbolIndex::updateDocument(Document::Ptr doc)
+{
+    QMutexLocker locker(&m_pendingMutex);
+    m_pendingDocuments.insert(doc->fileName(), doc);
+}
+
+void SymbolIndex::removeFiles(const QStringList &fileNames)
+{
+    QWriteLocker locker(&m_lock);
+    QMutexLocker pendingLocker(&m_pendingMutex);
+    foreach (const QString &fileName, fileNames) {
+        m_pendingDocuments.remove(fileName);
+        remove(fileName);
+    }
+}
+
+void SymbolIndex::clear()
+{
+    QWriteLocker locker(&m_lock);
+    QMutexLocker pendingLocker(&m_pendingMutex);
+    m_pendingDocuments.clear();
+    m_strings.clear();
+    m_stringIds.clear();
+    m_icons.clear();
+    m_iconIds.clear();
+    m_tables.clear();
+    m_filesByName.clear();
+}
+
+QList<ModelItemInfo> SymbolIndex::matches(const QString &pattern,
+                                          SearchSymbols::SymbolTypes types,
+                                          NameField field,
+                                          QFutureInterfaceBase *future)
+{
+    flush();
+
+    QList<ModelItemInfo> result;
+    const bool hasWildcard = pattern.contains(QLatin1Char('*')) || pattern.contains(QLatin1Char('?'));
+    const QStringMatcher matcher(pattern, Qt::CaseInsensitive);
+    const QRegExp regexp(QLatin1Char('*') + pattern + QLatin1Char('*'),
+                         Qt::CaseInsensitive, QRegExp::Wildcard);
+    if (!regexp.isValid())
+        return result;
+
+    QReadLocker locker(&m_lock);
+
+    // 0: not tested yet, 1: matches, 2: doesn't match
+    QVector<uchar> verdicts(m_strings.size(), 0);
+    uchar *verdict = verdicts.data();
+
+    foreach (const SymbolTable &table, m_tables) {
+        if (future && future->isCanceled())
+            break;
+
+        const int *names = (field == QualifiedName ? table.qualifiedNames : table.names).constData();
+        const uchar *kinds = table.kinds.constData();
+        const int rowCount = table.kinds.size();
+
+        for (int row = 0; row < rowCount; ++row) {
+            if (!isSearchedFor(kinds[row], types))
+                continue;
+
+            const int name = names[row];
+            if (!verdict[name]) {
+                const QString &text = m_strings.at(name);
+                const bool matches = hasWildcard ? regexp.exactMatch(text)
+                                                 : matcher.indexIn(text) != -1;
+                verdict[name] = matches ? 1 : 2;
+            }
+
+            if (verdict[name] == 1)
+                result.append(itemAt(table, row));
+        }
+    }
+
+    return result;
+}
+
+QList<ModelItemInfo> SymbolIndex::symbols(const QString &qualifiedName)
+{
+    flush();
+
+    QReadLocker locker(&m_lock);
+    QList<ModelItemInfo> result;
+    const int name = m_stringIds.value(qualifiedName, -1);
+    if (name == -1)
+        return result;
+
+    QSet<QString> processed;
+    foreach (const QString &fileName, m_filesByName.values(name)) {
+        if (processed.contains(fileName))
+            continue;
+        processed.insert(fileName);
+
+        const SymbolTable table = m_tables.value(fileName);
+        for (int row = 0; row < table.qualifiedNames.size(); ++row) {
+            if (table.qualifiedNames.at(row) == name)
+                result.append(itemAt(table, row));
+        }
+    }
+    return result;
+}
+
+void SymbolIndex::flush()
+{
+    do {
+        QMutexLocker locker(&m_pendingMutex);
+        if (m_pendingDocuments.isEmpty())
+            return;
+    } while (0);
+
+    // the documents are taken under the write lock, so that the versions
+    // of a file are indexed in order.
+    QWriteLocker locker(&m_lock);
+    QHash<QString, Document::Ptr> documents;
+    do {
+        QMutexLocker pendingLocker(&m_pendingMutex);
+        documents = m_pendingDocuments;
+        m_pendingDocuments.clear();
+    } while (0);
+
+    QHashIterator<QString, Document::Ptr> it(documents);
+    while (it.hasNext()) {
+        it.next();
+        remove(it.key());
+        insert(it.key(), m_search(it.value()));
+    }
+}
+
+void SymbolIndex::insert(const QString &fileName, const QList<ModelItemInfo> &items)
+{
+    if (items.isEmpty())
+        return;
+
+    SymbolTable table;
+    table.fileName = stringId(fileName);
+    table.qualifiedNames.reserve(items.size());
+    table.names.reserve(items.size());
+    table.scopes.reserve(items.size());
+    table.types.reserve(items.size());
+    table.lines.reserve(items.size());
+    table.kinds.reserve(items.size());
+    table.icons.reserve(items.size());
+
+    foreach (const ModelItemInfo &info, items) {
+        const int qualifiedName = stringId(info.qualifiedName);
+        table.qualifiedNames.append(qualifiedName);
+        table.names.append(stringId(info.symbolName));
+        table.scopes.append(stringId(info.symbolScope));
+        table.types.append(stringId(info.symbolType));
+        table.lines.append(info.line);
+        table.kinds.append(info.type);
+        table.icons.append(iconId(info.icon));
+        m_filesByName.insert(qualifiedName, fileName);
+    }
+
+    m_tables.insert(fileName, table);
+}
+
+void SymbolIndex::remove(const QString &fileName)
+{
+    const SymbolTable table = m_tables.take(fileName);
+    foreach (int qualifiedName, table.qualifiedNames)
+        m_filesByName.remove(qualifiedName, fileName);
+}
+
+ModelItemInfo SymbolIndex::itemAt(const SymbolTable &table, int row) const
+{
+    return ModelItemInfo(m_strings.at(table.qualifiedNames.at(row)),
+                         m_strings.at(table.names.at(row)),
+                         m_strings.at(table.scopes.at(row)),
+                         m_strings.at(table.types.at(row)),
+                         ModelItemInfo::ItemType(table.kinds.at(row)),
+                         m_strings.at(table.fileName),
+                         table.lines.at(row),
+                         m_icons.at(table.icons.at(row)));
+}
+
+int SymbolIndex::stringId(const QString &s)
+{
+    QHash<QString, int>::const_iterator it = m_stringIds.constFind(s);
+    if (it != m_stringIds.constEnd())
+        return it.value();
+
+    const int id = m_strings.size();
+    m_strings.append(s);
+    m_stringIds.insert(s, id);
+    return id;
+}
+
+int SymbolIndex::iconId(const QIcon &icon)
+{
+    QHash<qint64, int>::const_iterator it = m_iconIds.constFind(icon.cacheKey());
+    if (it != m_iconIds.constEnd())
+        return it.value();
+
+    const int id = m_icons.size();
+    m_icons.append(icon);
+    m_iconIds.insert(icon.cacheKey(), id);
+    return id;
+}
+
+bool SymbolIndex::isSearchedFor(uchar kind, SearchSymbols::SymbolTypes types)
+{
+    switch (kind) {
+    case ModelItemInfo::Enum:
+        return types & SearchSymbols::Enums;
+    case ModelItemInfo::Class:
+        return types & SearchSymbols::Classes;
+    case ModelItemInfo::Method:
+        return types & SearchSymbols::Functions;
+    }
+    return false;
+}
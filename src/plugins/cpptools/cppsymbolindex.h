@@ -0,0 +1,132 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#ifndef CPPSYMBOLINDEX_H
+#define CPPSYMBOLINDEX_H
+
+#include "searchsymbols.h"
+
+#include <QtCore/QFutureInterface>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace CppTools {
+namespace Internal {
+
+// The classes, methods and enums of the documents of the snapshot, by file
+// and by fully qualified name.
+//
+// The model manager passes the updated and the removed documents on; the
+// symbols of an updated document are searched for the next time the index
+// is queried, so that the documents indexed in a row are searched once.
+//
+// The symbols are packed: the names, scopes and types are interned, so
+// a symbol is a row of string ids in the arrays of its file, and its icon
+// is an index into the few icons in use. The strings of the removed files
+// stay in the index for as long as it lives; most of them come back with
+// the next version of the file anyway.
+//
+// The index can be used from any thread.
+class SymbolIndex
+{
+public:
+    enum NameField {
+        QualifiedName, // Foo::Bar::baz
+        SymbolName     // baz, or baz(int) for the methods
+    };
+
+    SymbolIndex();
+
+    void updateDocument(CPlusPlus::Document::Ptr doc);
+    void removeFiles(const QStringList &fileNames);
+    void clear();
+
+    // The symbols of the given types whose name contains pattern, ignoring
+    // the case. A pattern with a * or a ? is a wildcard expression. Each
+    // distinct name is tested once, however many symbols share it. Stops
+    // when future is canceled.
+    QList<ModelItemInfo> matches(const QString &pattern,
+                                 SearchSymbols::SymbolTypes types,
+                                 NameField field,
+                                 QFutureInterfaceBase *future = 0);
+
+    // The symbols named qualifiedName, e.g. Foo::Bar::baz.
+    QList<ModelItemInfo> symbols(const QString &qualifiedName);
+
+private:
+    // The symbols of a file, one row per symbol.
+    struct SymbolTable
+    {
+        int fileName;
+        QVector<int> qualifiedNames;
+        QVector<int> names;
+        QVector<int> scopes;
+        QVector<int> types;
+        QVector<int> lines;
+        QVector<uchar> kinds;
+        QVector<uchar> icons;
+    };
+
+    void flush();
+    void insert(const QString &fileName, const QList<ModelItemInfo> &items);
+    void remove(const QString &fileName);
+    ModelItemInfo itemAt(const SymbolTable &table, int row) const;
+
+    int stringId(const QString &s);
+    int iconId(const QIcon &icon);
+
+    static bool isSearchedFor(uchar kind, SearchSymbols::SymbolTypes types);
+
+    QMutex m_pendingMutex;
+    QHash<QString, CPlusPlus::Document::Ptr> m_pendingDocuments;
+
+    QReadWriteLock m_lock;
+    SearchSymbols m_search;
+    QVector<QString> m_strings;
+    QHash<QString, int> m_stringIds;
+    QVector<QIcon> m_icons;
+    QHash<qint64, int> m_iconIds;
+    QHash<QString, SymbolTable> m_tables;
+    QMultiHash<int, QString> m_filesByName;
+};
+
+} // namespace Internal
+} // namespace CppTools
+
+#endif // CPPSYMBOLINDEX_H
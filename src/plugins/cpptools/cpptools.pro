@@ -13,22 +13,28 @@ HEADERS += cpptools_global.h \
     cppquickopenfilter.h \
     cppclassesfilter.h \
     searchsymbols.h \
+    cppsymbolindex.h \
     cppfunctionsfilter.h
 SOURCES += cppquickopenfilter.cpp \
     cpptoolseditorsupport.cpp \
     cppclassesfilter.cpp \
     searchsymbols.cpp \
+    cppsymbolindex.cpp \
     cppfunctionsfilter.cpp
 
 # Input
 SOURCES += cpptools.cpp \
     cppmodelmanager.cpp \
     cppcodecompletion.cpp \
-    cpphoverhandler.cpp
+    cppcompletionindex.cpp \
+    cpphoverhandler.cpp \
+    cppsourcefile.cpp
 HEADERS += cpptools.h \
     cppmodelmanager.h \
     cppcodecompletion.h \
+    cppcompletionindex.h \
     cpphoverhandler.h \
+    cppsourcefile.h \
     cppmodelmanagerinterface.h \
     cpptoolseditorsupport.h \
     cpptoolsconstants.h
@@ -40,15 +40,28 @@
 
 using namespace CppTools::Internal;
 
+// The revisions of the contents of all the editors, so that the editors of
+// the same file don't reuse each other's documents; only used in the GUI
+// thread.
+static unsigned lastEditorRevision = 0;
+
 CppEditorSupport::CppEditorSupport(CppModelManager *modelManager)
     : QObject(modelManager),
       _modelManager(modelManager),
-      _updateDocumentInterval(UPDATE_DOCUMENT_DEFAULT_INTERVAL)
+      _updateDocumentInterval(UPDATE_DOCUMENT_DEFAULT_INTERVAL),
+      _parsedRevision(0)
 {
     _updateDocumentTimer = new QTimer(this);
     _updateDocumentTimer->setSingleShot(true);
     _updateDocumentTimer->setInterval(_updateDocumentInterval);
     connect(_updateDocumentTimer, SIGNAL(timeout()), this, SLOT(updateDocumentNow()));
+
+    // The edits only get the bodies they touch parsed, the other ones are
+    // parsed again once the user stops typing.
+    _parseFunctionBodiesTimer = new QTimer(this);
+    _parseFunctionBodiesTimer->setSingleShot(true);
+    _parseFunctionBodiesTimer->setInterval(PARSE_FUNCTION_BODIES_INTERVAL);
+    connect(_parseFunctionBodiesTimer, SIGNAL(timeout()), this, SLOT(parseFunctionBodiesNow()));
 }
 
 CppEditorSupport::~CppEditorSupport()
@@ -85,14 +98,94 @@ void CppEditorSupport::setUpdateDocumentInterval(int updateDocumentInterval)
 void CppEditorSupport::updateDocument()
 { _updateDocumentTimer->start(_updateDocumentInterval); }
 
+static int countNewlines(const QChar *chars, int size)
+{
+    int count = 0;
+    for (int i = 0; i < size; ++i) {
+        if (chars[i] == QLatin1Char('\n'))
+            ++count;
+    }
+    return count;
+}
+
+// Computes the lines of newContents that differ from oldContents, and the
+// number of lines added by the change.
+static void findEditedLines(const QString &oldContents, const QString &newContents,
+                            unsigned *firstLine, unsigned *lastLine, int *lineDelta)
+{
+    const int oldSize = oldContents.size();
+    const int newSize = newContents.size();
+    const QChar *oldChars = oldContents.constData();
+    const QChar *newChars = newContents.constData();
+
+    int prefix = 0;
+    while (prefix < oldSize && prefix < newSize && oldChars[prefix] == newChars[prefix])
+        ++prefix;
+
+    int suffix = 0;
+    while (suffix < oldSize - prefix && suffix < newSize - prefix
+           && oldChars[oldSize - suffix - 1] == newChars[newSize - suffix - 1])
+        ++suffix;
+
+    const int first = countNewlines(newChars, prefix) + 1;
+    const int removedLines = countNewlines(oldChars + prefix, oldSize - prefix - suffix);
+    const int addedLines = countNewlines(newChars + prefix, newSize - prefix - suffix);
+
+    *firstLine = first;
+    *lastLine = first + addedLines;
+    *lineDelta = addedLines - removedLines;
+}
+
 void CppEditorSupport::updateDocumentNow()
 {
     if (_documentParser.isRunning()) {
         _updateDocumentTimer->start(_updateDocumentInterval);
     } else {
         _updateDocumentTimer->stop();
-        QStringList sourceFiles(_textEditor->file()->fileName());
-        _documentParser = _modelManager->refreshSourceFiles(sourceFiles);
+        parseDocument(/*allFunctionBodies = */ false);
     }
 }
 
+void CppEditorSupport::parseFunctionBodies()
+{ _parseFunctionBodiesTimer->start(0); }
+
+void CppEditorSupport::parseFunctionBodiesNow()
+{
+    if (! _textEditor)
+        return;
+
+    if (_documentParser.isRunning()) {
+        _parseFunctionBodiesTimer->start(PARSE_FUNCTION_BODIES_INTERVAL);
+    } else {
+        _updateDocumentTimer->stop(); // the pending edits are parsed too.
+        parseDocument(/*allFunctionBodies = */ true);
+    }
+}
+
+void CppEditorSupport::parseDocument(bool allFunctionBodies)
+{
+    const QString fileName = _textEditor->file()->fileName();
+    const QString contents = _textEditor->contents();
+
+    // The model manager reuses the document of the previous revision only
+    // if it's the one in the snapshot.
+    const unsigned previousRevision = allFunctionBodies ? 0 : _parsedRevision;
+    const unsigned revision = ++lastEditorRevision;
+
+    unsigned firstLine = 0, lastLine = 0;
+    int lineDelta = 0;
+    if (previousRevision)
+        findEditedLines(_parsedContents, contents, &firstLine, &lastLine, &lineDelta);
+
+    _documentParser = _modelManager->refreshEditedFile(fileName, revision, previousRevision,
+                                                       firstLine, lastLine, lineDelta);
+
+    _parsedContents = contents;
+    _parsedRevision = revision;
+
+    if (previousRevision)
+        _parseFunctionBodiesTimer->start(PARSE_FUNCTION_BODIES_INTERVAL);
+    else
+        _parseFunctionBodiesTimer->stop();
+}
+
@@ -68,18 +68,29 @@ public:
 
     QString contents() const;
 
+    // Parses the document again with all its function bodies as soon as
+    // possible.
+    void parseFunctionBodies();
+
 private Q_SLOTS:
     void updateDocument();
     void updateDocumentNow();
+    void parseFunctionBodiesNow();
 
 private:
+    void parseDocument(bool allFunctionBodies);
+
     enum { UPDATE_DOCUMENT_DEFAULT_INTERVAL = 150 };
+    enum { PARSE_FUNCTION_BODIES_INTERVAL = 1000 };
 
     CppModelManager *_modelManager;
     QPointer<TextEditor::ITextEditor> _textEditor;
     QTimer *_updateDocumentTimer;
+    QTimer *_parseFunctionBodiesTimer;
     int _updateDocumentInterval;
     QFuture<void> _documentParser;
+    QString _parsedContents;
+    unsigned _parsedRevision;
 };
 
 } // namespace Internal
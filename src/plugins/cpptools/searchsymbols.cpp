@@ -41,8 +41,7 @@ using namespace CPlusPlus;
 using namespace CppTools::Internal;
 
 SearchSymbols::SearchSymbols():
-    symbolsToSearchFor(Classes | Functions | Enums),
-    separateScope(false)
+    symbolsToSearchFor(Classes | Functions | Enums)
 {
 }
 
@@ -51,11 +50,6 @@ void SearchSymbols::setSymbolsToSearchFor(SymbolTypes types)
     symbolsToSearchFor = types;
 }
 
-void SearchSymbols::setSeparateScope(bool separateScope)
-{
-    this->separateScope = separateScope;
-}
-
 QList<ModelItemInfo> SearchSymbols::operator()(Document::Ptr doc, const QString &scope)
 {
     QString previousScope = switchScope(scope);
@@ -82,8 +76,7 @@ bool SearchSymbols::visit(Enum *symbol)
     QString name = symbolName(symbol);
     QString scopedName = scopedSymbolName(name);
     QString previousScope = switchScope(scopedName);
-    appendItem(separateScope ? name : scopedName,
-               separateScope ? previousScope : QString(),
+    appendItem(scopedName, name, previousScope, QString(),
                ModelItemInfo::Enum, symbol);
     Scope *members = symbol->members();
     for (unsigned i = 0; i < members->symbolCount(); ++i) {
@@ -98,24 +91,21 @@ bool SearchSymbols::visit(Function *symbol)
     if (!(symbolsToSearchFor & Functions))
         return false;
 
-    QString extraScope;
+    // the qualifiers of an out-of-line definition are part of its scope
+    QString fullScope = _scope;
     if (Name *name = symbol->name()) {
         if (QualifiedNameId *nameId = name->asQualifiedNameId()) {
-            if (nameId->nameCount() > 1) {
-                extraScope = overview.prettyName(nameId->nameAt(nameId->nameCount() - 2));
+            for (unsigned i = 0; i + 1 < nameId->nameCount(); ++i) {
+                if (!fullScope.isEmpty())
+                    fullScope += QLatin1String("::");
+                fullScope += overview.prettyName(nameId->nameAt(i));
             }
         }
     }
-    QString fullScope = _scope;
-    if (!_scope.isEmpty() && !extraScope.isEmpty())
-        fullScope += QLatin1String("::");
-    fullScope += extraScope;
-    QString name = symbolName(symbol);
-    QString scopedName = scopedSymbolName(name);
-    QString type = overview.prettyType(symbol->type(),
-                                       separateScope ? symbol->identity() : 0);
-    appendItem(separateScope ? type : scopedName,
-               separateScope ? fullScope : type,
+    QString scopedName = scopedSymbolName(symbol);
+    QString signature = overview.prettyType(symbol->type(), symbol->identity());
+    QString type = overview.prettyType(symbol->type());
+    appendItem(scopedName, signature, fullScope, type,
                ModelItemInfo::Method, symbol);
     return false;
 }
@@ -152,8 +142,7 @@ bool SearchSymbols::visit(Class *symbol)
     QString name = symbolName(symbol);
     QString scopedName = scopedSymbolName(name);
     QString previousScope = switchScope(scopedName);
-    appendItem(separateScope ? name : scopedName,
-               separateScope ? previousScope : QString(),
+    appendItem(scopedName, name, previousScope, QString(),
                ModelItemInfo::Class, symbol);
     Scope *members = symbol->members();
     for (unsigned i = 0; i < members->symbolCount(); ++i) {
@@ -204,16 +193,18 @@ QString SearchSymbols::symbolName(const Symbol *symbol) const
     return symbolName;
 }
 
-void SearchSymbols::appendItem(const QString &name,
-                               const QString &info,
-                               ModelItemInfo::ItemType type,
+void SearchSymbols::appendItem(const QString &qualifiedName,
+                               const QString &name,
+                               const QString &scope,
+                               const QString &type,
+                               ModelItemInfo::ItemType itemType,
                                const Symbol *symbol)
 {
     if (!symbol->name())
         return;
 
     const QIcon icon = icons.iconForSymbol(symbol);
-    items.append(ModelItemInfo(name, info, type,
+    items.append(ModelItemInfo(qualifiedName, name, scope, type, itemType,
                                QString::fromUtf8(symbol->fileName(), symbol->fileNameLength()),
                                symbol->line(),
                                icon));
@@ -55,15 +55,20 @@ struct ModelItemInfo
     enum ItemType { Enum, Class, Method };
 
     ModelItemInfo()
+        : type(Class), line(0)
     { }
 
-    ModelItemInfo(const QString &symbolName,
+    ModelItemInfo(const QString &qualifiedName,
+                  const QString &symbolName,
+                  const QString &symbolScope,
                   const QString &symbolType,
                   ItemType type,
                   const QString &fileName,
                   int line,
                   const QIcon &icon)
-        : symbolName(symbolName),
+        : qualifiedName(qualifiedName),
+          symbolName(symbolName),
+          symbolScope(symbolScope),
           symbolType(symbolType),
           type(type),
           fileName(fileName),
@@ -71,8 +76,10 @@ struct ModelItemInfo
           icon(icon)
     { }
 
-    QString symbolName;
-    QString symbolType;
+    QString qualifiedName; // Foo::Bar::baz
+    QString symbolName;    // baz, or baz(int) for the methods
+    QString symbolScope;   // Foo::Bar
+    QString symbolType;    // the type of the methods, void (int)
     ItemType type;
     QString fileName;
     int line;
@@ -93,7 +100,6 @@ public:
     SearchSymbols();
 
     void setSymbolsToSearchFor(SymbolTypes types);
-    void setSeparateScope(bool separateScope);
 
     QList<ModelItemInfo> operator()(CPlusPlus::Document::Ptr doc)
     { return operator()(doc, QString()); }
@@ -119,9 +125,11 @@ protected:
     QString scopedSymbolName(const QString &symbolName) const;
     QString scopedSymbolName(const CPlusPlus::Symbol *symbol) const;
     QString symbolName(const CPlusPlus::Symbol *symbol) const;
-    void appendItem(const QString &name,
-                    const QString &info,
-                    ModelItemInfo::ItemType type,
+    void appendItem(const QString &qualifiedName,
+                    const QString &name,
+                    const QString &scope,
+                    const QString &type,
+                    ModelItemInfo::ItemType itemType,
                     const CPlusPlus::Symbol *symbol);
 
 private:
@@ -135,7 +143,6 @@ private:
     CPlusPlus::Icons icons;
     QList<ModelItemInfo> items;
     SymbolTypes symbolsToSearchFor;
-    bool separateScope;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(SearchSymbols::SymbolTypes)
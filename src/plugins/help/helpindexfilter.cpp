@@ -41,6 +41,8 @@
 #include <QtHelp/QHelpEngine>
 #include <QtHelp/QHelpIndexModel>
 
+#include <QtCore/QMutexLocker>
+
 using namespace QuickOpen;
 using namespace Help;
 using namespace Help::Internal;
@@ -65,7 +67,11 @@ void HelpIndexFilter::updateIndices()
     if (!currentFilter.isEmpty())
         m_plugin->setIndexFilter(QString());
 
-    m_helpIndex = m_helpEngine->indexModel()->stringList();
+    const QStringList helpIndex = m_helpEngine->indexModel()->stringList();
+    do {
+        QMutexLocker locker(&m_mutex);
+        m_helpIndex = helpIndex;
+    } while (0);
 
     if (!currentFilter.isEmpty())
         m_plugin->setIndexFilter(currentFilter);
@@ -86,10 +92,18 @@ IQuickOpenFilter::Priority HelpIndexFilter::priority() const
     return Medium;
 }
 
-QList<FilterEntry> HelpIndexFilter::matchesFor(const QString &entry)
+QList<FilterEntry> HelpIndexFilter::matchesFor(QFutureInterface<FilterEntry> &future, const QString &entry)
 {
+    QStringList helpIndex;
+    do {
+        QMutexLocker locker(&m_mutex);
+        helpIndex = m_helpIndex;
+    } while (0);
+
     QList<FilterEntry> entries;
-    foreach (const QString &string, m_helpIndex) {
+    foreach (const QString &string, helpIndex) {
+        if (future.isCanceled())
+            break;
         if (string.contains(entry, Qt::CaseInsensitive)) {
             FilterEntry entry(this, string, QVariant(), m_icon);
             entries.append(entry);
@@ -36,6 +36,7 @@
 
 #include <quickopen/iquickopenfilter.h>
 
+#include <QtCore/QMutex>
 #include <QtGui/QIcon>
 
 QT_BEGIN_NAMESPACE
@@ -59,7 +60,7 @@ public:
     QString trName() const;
     QString name() const;
     Priority priority() const;
-    QList<QuickOpen::FilterEntry> matchesFor(const QString &entry);
+    QList<QuickOpen::FilterEntry> matchesFor(QFutureInterface<QuickOpen::FilterEntry> &future, const QString &entry);
     void accept(QuickOpen::FilterEntry selection) const;
     void refresh(QFutureInterface<void> &future);
 
@@ -73,6 +74,7 @@ private slots:
 private:
     HelpPlugin *m_plugin;
     QHelpEngine *m_helpEngine;
+    QMutex m_mutex; // matchesFor() runs in a worker thread
     QStringList m_helpIndex;
     QIcon m_icon;
 };
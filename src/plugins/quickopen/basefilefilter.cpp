@@ -35,7 +35,7 @@
 
 #include <coreplugin/editormanager/editormanager.h>
 
-#include <QtCore/QDir>
+#include <QtCore/QMutexLocker>
 
 using namespace Core;
 using namespace QuickOpen;
@@ -43,48 +43,47 @@ using namespace QuickOpen;
 BaseFileFilter::BaseFileFilter(ICore *core)
         : m_core(core),
           m_files(QStringList()),
-          m_fileNames(QStringList()),
           m_forceNewSearchList(false)
 {
 }
 
-QList<FilterEntry> BaseFileFilter::matchesFor(const QString &origEntry)
+QList<FilterEntry> BaseFileFilter::matchesFor(QFutureInterface<FilterEntry> &future, const QString &origEntry)
 {
+    QMutexLocker locker(&m_mutex);
     QList<FilterEntry> value;
     QString entry = trimWildcards(origEntry);
-    QStringMatcher matcher(entry, Qt::CaseInsensitive);
-    const QRegExp regexp("*"+entry+"*", Qt::CaseInsensitive, QRegExp::Wildcard);
-    if (!regexp.isValid())
-        return value;
     bool hasWildcard = (entry.contains('*') || entry.contains('?'));
-    QStringList searchListPaths;
-    QStringList searchListNames;
-    if (!m_previousEntry.isEmpty() && !m_forceNewSearchList && entry.contains(m_previousEntry)) {
-        searchListPaths = m_previousResultPaths;
-        searchListNames = m_previousResultNames;
+
+    QVector<int> matches;
+    if (hasWildcard) {
+        matches = m_index.wildcardMatches(entry, &future);
+        m_forceNewSearchList = true;
+    } else {
+        // the names matching the entry are among the ones that matched the previous entry
+        const bool narrow = !m_previousEntry.isEmpty() && !m_forceNewSearchList
+                            && FileNameIndex::narrows(entry, m_previousEntry);
+        matches = m_index.fuzzyMatches(entry, narrow ? &m_previousMatches : 0, &future);
+        m_forceNewSearchList = future.isCanceled();
+        m_previousMatches = matches;
+        m_previousEntry = entry;
+    }
+    if (future.isCanceled())
+        return value;
+
+    QVector<int> best;
+    if (hasWildcard) {
+        best = matches;
+        if (best.size() > MaxMatches)
+            best.resize(MaxMatches);
     } else {
-        searchListPaths = m_files;
-        searchListNames = m_fileNames;
+        best = m_index.best(matches, entry, MaxMatches);
     }
-    m_previousResultPaths.clear();
-    m_previousResultNames.clear();
-    m_forceNewSearchList = false;
-    m_previousEntry = entry;
-    QStringListIterator paths(searchListPaths);
-    QStringListIterator names(searchListNames);
-    while (paths.hasNext() && names.hasNext()) {
-        QString path = paths.next();
-        QString name = names.next();
-        if ((hasWildcard && regexp.exactMatch(name))
-                || (!hasWildcard && matcher.indexIn(name) != -1)) {
-            QFileInfo fi(path);
-            FilterEntry entry(this, fi.fileName(), path);
-            entry.extraInfo = QDir::toNativeSeparators(fi.path());
-            entry.resolveFileIcon = true;
-            value.append(entry);
-            m_previousResultPaths.append(path);
-            m_previousResultNames.append(name);
-        }
+
+    foreach (int id, best) {
+        FilterEntry filterEntry(this, m_index.fileName(id), m_index.filePath(id));
+        filterEntry.extraInfo = m_index.directory(id);
+        filterEntry.resolveFileIcon = true;
+        value.append(filterEntry);
     }
     return value;
 }
@@ -97,10 +96,7 @@ void BaseFileFilter::accept(QuickOpen::FilterEntry selection) const
 
 void BaseFileFilter::generateFileNames()
 {
-    m_fileNames.clear();
-    foreach (const QString &fileName, m_files) {
-        QFileInfo fi(fileName);
-        m_fileNames.append(fi.fileName());
-    }
+    QMutexLocker locker(&m_mutex);
+    m_index.setFiles(m_files);
     m_forceNewSearchList = true;
 }
@@ -36,11 +36,13 @@
 
 #include "quickopen_global.h"
 #include "iquickopenfilter.h"
+#include "filenameindex.h"
 
 #include <coreplugin/icore.h>
 
 #include <QtCore/QString>
 #include <QtCore/QList>
+#include <QtCore/QMutex>
 #include <QtCore/QByteArray>
 #include <QtGui/QWidget>
 
@@ -52,17 +54,24 @@ class QUICKOPEN_EXPORT BaseFileFilter : public QuickOpen::IQuickOpenFilter
 
 public:
     BaseFileFilter(Core::ICore *core);
-    QList<QuickOpen::FilterEntry> matchesFor(const QString &entry);
+    QList<QuickOpen::FilterEntry> matchesFor(QFutureInterface<QuickOpen::FilterEntry> &future, const QString &entry);
     void accept(QuickOpen::FilterEntry selection) const;
 
 protected:
+    // Makes the files searched the current m_files.
     void generateFileNames();
 
     Core::ICore *m_core;
     QStringList m_files;
-    QStringList m_fileNames;
-    QStringList m_previousResultPaths;
-    QStringList m_previousResultNames;
+
+private:
+    enum { MaxMatches = 1000 };
+
+    // matchesFor() runs in a worker thread; it searches the files of the
+    // last generateFileNames() while m_files is being refreshed.
+    QMutex m_mutex;
+    FileNameIndex m_index;
+    QVector<int> m_previousMatches;
     bool m_forceNewSearchList;
     QString m_previousEntry;
 };
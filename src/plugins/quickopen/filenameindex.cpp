@@ -0,0 +1,339 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#include "filenameindex.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QPair>
+#include <QtCore/QRegExp>
+
+#include <algorithm>
+
+using namespace QuickOpen;
+
+FileNameIndex::FileNameIndex()
+    : m_removedCount(0)
+{
+}
+
+void FileNameIndex::setFiles(const QStringList &files)
+{
+    const int previousCount = m_paths.size();
+    QBitArray kept(previousCount);
+
+    foreach (const QString &file, files) {
+        QHash<QString, int>::const_iterator it = m_ids.constFind(file);
+        if (it == m_ids.constEnd()) {
+            add(file);
+            continue;
+        }
+
+        const int id = it.value();
+        if (id < previousCount)
+            kept.setBit(id);
+        if (m_removed.testBit(id)) {
+            m_removed.clearBit(id);
+            --m_removedCount;
+        }
+    }
+
+    for (int id = 0; id < previousCount; ++id) {
+        if (!kept.testBit(id) && !m_removed.testBit(id)) {
+            m_removed.setBit(id);
+            ++m_removedCount;
+        }
+    }
+
+    if (m_removedCount > m_paths.size() / 2)
+        compact();
+}
+
+int FileNameIndex::count() const
+{
+    return m_paths.size();
+}
+
+bool FileNameIndex::isRemoved(int id) const
+{
+    return m_removed.testBit(id);
+}
+
+QString FileNameIndex::filePath(int id) const
+{
+    return m_paths.at(id);
+}
+
+QString FileNameIndex::fileName(int id) const
+{
+    return m_names.at(id);
+}
+
+QString FileNameIndex::directory(int id) const
+{
+    const QString &path = m_paths.at(id);
+    const int slash = path.lastIndexOf(QLatin1Char('/'));
+    if (slash == -1)
+        return QString(QLatin1Char('.'));
+    return QDir::toNativeSeparators(path.left(qMax(slash, 1)));
+}
+
+QVector<int> FileNameIndex::fuzzyMatches(const QString &key,
+                                         const QVector<int> *candidates,
+                                         QFutureInterfaceBase *future) const
+{
+    const QString lowerKey = key.toLower();
+    const quint64 mask = characterMask(lowerKey);
+    const quint64 *masks = m_masks.constData();
+    const int candidateCount = candidates ? candidates->size() : m_paths.size();
+
+    QVector<int> matches;
+    for (int i = 0; i < candidateCount; ++i) {
+        if (future && !(i & 0xfff) && future->isCanceled())
+            break;
+
+        const int id = candidates ? candidates->at(i) : i;
+        if ((masks[id] & mask) != mask || m_removed.testBit(id))
+            continue;
+        if (isSubsequence(lowerKey, m_lowerNames.at(id)))
+            matches.append(id);
+    }
+    return matches;
+}
+
+QVector<int> FileNameIndex::wildcardMatches(const QString &pattern,
+                                            QFutureInterfaceBase *future) const
+{
+    QVector<int> matches;
+    const QRegExp regexp(QLatin1Char('*') + pattern + QLatin1Char('*'),
+                         Qt::CaseInsensitive, QRegExp::Wildcard);
+    if (!regexp.isValid())
+        return matches;
+
+    // the names must contain the characters that aren't wildcards
+    const quint64 mask = characterMask(wildcardLiterals(pattern.toLower()));
+
+    for (int id = 0; id < m_paths.size(); ++id) {
+        if (future && !(id & 0xfff) && future->isCanceled())
+            break;
+
+        if ((m_masks.at(id) & mask) != mask || m_removed.testBit(id))
+            continue;
+        if (regexp.exactMatch(m_names.at(id)))
+            matches.append(id);
+    }
+    return matches;
+}
+
+int FileNameIndex::score(int id, const QString &key) const
+{
+    return lowerKeyScore(id, key.toLower());
+}
+
+QVector<int> FileNameIndex::best(const QVector<int> &matches, const QString &key, int maxCount) const
+{
+    const QString lowerKey = key.toLower();
+
+    // sorted by ascending (-score, id): the best first, then in the order of the files
+    QVector<QPair<int, int> > scored;
+    scored.reserve(matches.size());
+    foreach (int id, matches)
+        scored.append(qMakePair(-lowerKeyScore(id, lowerKey), id));
+
+    const int count = qMin(maxCount, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + count, scored.end());
+
+    QVector<int> result(count);
+    for (int i = 0; i < count; ++i)
+        result[i] = scored.at(i).second;
+    return result;
+}
+
+bool FileNameIndex::narrows(const QString &key, const QString &previousKey)
+{
+    return isSubsequence(previousKey.toLower(), key.toLower());
+}
+
+void FileNameIndex::add(const QString &filePath)
+{
+    const int id = m_paths.size();
+    const QString name = filePath.mid(filePath.lastIndexOf(QLatin1Char('/')) + 1);
+    const QString lowerName = name.toLower();
+
+    m_paths.append(filePath);
+    m_names.append(name);
+    m_lowerNames.append(lowerName);
+    m_masks.append(characterMask(lowerName));
+    m_removed.resize(id + 1);
+    m_ids.insert(filePath, id);
+}
+
+void FileNameIndex::compact()
+{
+    const QVector<QString> paths = m_paths;
+    const QBitArray removed = m_removed;
+
+    m_paths.clear();
+    m_names.clear();
+    m_lowerNames.clear();
+    m_masks.clear();
+    m_removed.clear();
+    m_removedCount = 0;
+    m_ids.clear();
+
+    for (int id = 0; id < paths.size(); ++id) {
+        if (!removed.testBit(id))
+            add(paths.at(id));
+    }
+}
+
+int FileNameIndex::lowerKeyScore(int id, const QString &lowerKey) const
+{
+    if (lowerKey.isEmpty())
+        return 0;
+
+    const QString &name = m_names.at(id);
+    const QString &lowerName = m_lowerNames.at(id);
+
+    // the shorter names are the closer matches
+    int score = -lowerName.size();
+
+    const int position = lowerName.indexOf(lowerKey);
+    if (position != -1) {
+        score += 10000 - position;
+        if (position == 0)
+            score += lowerName.size() == lowerKey.size() ? 4000 : 2000;
+        else if (isWordStart(name, position))
+            score += 1000;
+        return score;
+    }
+
+    int from = 0;
+    int previous = -2;
+    int run = 0;
+    for (int i = 0; i < lowerKey.size(); ++i) {
+        const int position = lowerName.indexOf(lowerKey.at(i), from);
+        if (position == -1)
+            return score - 10000;
+
+        if (position == previous + 1) {
+            ++run;
+            score += 10 * run;
+        } else {
+            run = 0;
+            score -= qMin(position - from, 10);
+        }
+        if (isWordStart(name, position))
+            score += 50;
+
+        previous = position;
+        from = position + 1;
+    }
+    return score;
+}
+
+quint64 FileNameIndex::characterMask(const QString &lowerText)
+{
+    quint64 mask = 0;
+    const QChar *c = lowerText.constData();
+    const QChar *end = c + lowerText.size();
+    for (; c != end; ++c) {
+        const ushort u = c->unicode();
+        int bit;
+        if (u >= 'a' && u <= 'z')
+            bit = u - 'a';
+        else if (u >= '0' && u <= '9')
+            bit = 26 + u - '0';
+        else if (u == '_')
+            bit = 36;
+        else if (u == '.')
+            bit = 37;
+        else if (u == '-')
+            bit = 38;
+        else
+            bit = 39 + u % 25;
+        mask |= Q_UINT64_C(1) << bit;
+    }
+    return mask;
+}
+
+// Returns the characters of the pattern that every matching name contains:
+// the ones outside of the wildcards and the [...] sets.
+QString FileNameIndex::wildcardLiterals(const QString &pattern)
+{
+    QString literals;
+    for (int i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('*') || c == QLatin1Char('?'))
+            continue;
+        if (c != QLatin1Char('[')) {
+            literals.append(c);
+            continue;
+        }
+
+        // a ']' right after the opening bracket belongs to the set
+        int end = i + 1;
+        if (end < pattern.size() && (pattern.at(end) == QLatin1Char('!')
+                                     || pattern.at(end) == QLatin1Char('^')))
+            ++end;
+        if (end < pattern.size() && pattern.at(end) == QLatin1Char(']'))
+            ++end;
+        end = pattern.indexOf(QLatin1Char(']'), end);
+        if (end == -1)
+            break;
+        i = end;
+    }
+    return literals;
+}
+
+bool FileNameIndex::isSubsequence(const QString &lowerKey, const QString &lowerText)
+{
+    int from = 0;
+    for (int i = 0; i < lowerKey.size(); ++i) {
+        from = lowerText.indexOf(lowerKey.at(i), from);
+        if (from == -1)
+            return false;
+        ++from;
+    }
+    return true;
+}
+
+bool FileNameIndex::isWordStart(const QString &text, int position)
+{
+    if (position == 0)
+        return true;
+    const QChar previous = text.at(position - 1);
+    if (!previous.isLetterOrNumber())
+        return true;
+    return text.at(position).isUpper() && previous.isLower();
+}
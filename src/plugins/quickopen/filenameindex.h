@@ -0,0 +1,118 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+#ifndef FILENAMEINDEX_H
+#define FILENAMEINDEX_H
+
+#include "quickopen_global.h"
+
+#include <QtCore/QBitArray>
+#include <QtCore/QFutureInterface>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace QuickOpen {
+
+/*
+    The names of a list of files, prepared for the searches of the file filters.
+
+    Each name comes with the set of the characters it contains, packed in a
+    64-bit mask, so that the names missing a character of the key are skipped
+    with a single test. The key matches a name when its characters appear in
+    the name in the same order, ignoring the case; the matches are ranked by
+    score(), which prefers the names containing the key as a whole, at the
+    start of a word, and otherwise the characters that start words or follow
+    each other.
+
+    setFiles() only indexes the new files. The removed ones are marked until
+    they are many enough to compact the index, which changes the ids.
+*/
+class QUICKOPEN_EXPORT FileNameIndex
+{
+public:
+    FileNameIndex();
+
+    void setFiles(const QStringList &files);
+
+    int count() const;
+    bool isRemoved(int id) const;
+    QString filePath(int id) const;
+    QString fileName(int id) const;
+    QString directory(int id) const; // with native separators
+
+    // The files whose name contains the characters of key in order,
+    // ignoring the case, in id order. Only the files of candidates are
+    // looked at when it's given.
+    QVector<int> fuzzyMatches(const QString &key,
+                              const QVector<int> *candidates = 0,
+                              QFutureInterfaceBase *future = 0) const;
+
+    // The files whose name matches the wildcard pattern, in id order.
+    QVector<int> wildcardMatches(const QString &pattern,
+                                 QFutureInterfaceBase *future = 0) const;
+
+    // How well the key matches the name of the file, the higher the better.
+    int score(int id, const QString &key) const;
+
+    // The maxCount files of matches with the best score, best first.
+    QVector<int> best(const QVector<int> &matches, const QString &key, int maxCount) const;
+
+    // Whether the names matching key are a subset of the ones matching previousKey.
+    static bool narrows(const QString &key, const QString &previousKey);
+
+private:
+    void add(const QString &filePath);
+    void compact();
+
+    int lowerKeyScore(int id, const QString &lowerKey) const;
+
+    static quint64 characterMask(const QString &lowerText);
+    static QString wildcardLiterals(const QString &pattern);
+    static bool isSubsequence(const QString &lowerKey, const QString &lowerText);
+    static bool isWordStart(const QString &text, int position);
+
+    QVector<QString> m_paths;
+    QVector<QString> m_names;
+    QVector<QString> m_lowerNames;
+    QVector<quint64> m_masks;
+    QBitArray m_removed;
+    int m_removedCount;
+    QHash<QString, int> m_ids;
+};
+
+} // namespace QuickOpen
+
+#endif // FILENAMEINDEX_H
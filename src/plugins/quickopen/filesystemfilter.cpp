@@ -35,6 +35,7 @@
 #include "quickopentoolwindow.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QMutexLocker>
 
 using namespace Core;
 using namespace QuickOpen;
@@ -43,12 +44,26 @@ using namespace QuickOpen::Internal;
 FileSystemFilter::FileSystemFilter(EditorManager *editorManager, QuickOpenToolWindow *toolWindow)
         : m_editorManager(editorManager), m_toolWindow(toolWindow), m_includeHidden(true)
 {
+    connect(m_editorManager, SIGNAL(currentEditorChanged(Core::IEditor*)),
+            this, SLOT(updateCurrentDirectory(Core::IEditor*)));
+    updateCurrentDirectory(m_editorManager->currentEditor());
     setShortcutString("f");
     setIncludedByDefault(false);
 }
 
-QList<FilterEntry> FileSystemFilter::matchesFor(const QString &entry)
+void FileSystemFilter::updateCurrentDirectory(Core::IEditor *editor)
 {
+    QString currentDirectory;
+    if (editor && !editor->file()->fileName().isEmpty())
+        currentDirectory = QFileInfo(editor->file()->fileName()).absolutePath();
+
+    QMutexLocker locker(&m_mutex);
+    m_currentDirectory = currentDirectory;
+}
+
+QList<FilterEntry> FileSystemFilter::matchesFor(QFutureInterface<FilterEntry> &future, const QString &entry)
+{
+    Q_UNUSED(future);
     QList<FilterEntry> value;
     QFileInfo entryInfo(entry);
     QString name = entryInfo.fileName();
@@ -58,11 +73,13 @@ QList<FilterEntry> FileSystemFilter::matchesFor(const QString &entry)
         if (filePath.startsWith("~/")) {
             directory.replace(0, 1, QDir::homePath());
         } else {
-            IEditor *editor = m_editorManager->currentEditor();
-            if (editor && !editor->file()->fileName().isEmpty()) {
-                QFileInfo info(editor->file()->fileName());
-                directory.prepend(info.absolutePath()+"/");
-            }
+            QString currentDirectory;
+            do {
+                QMutexLocker locker(&m_mutex);
+                currentDirectory = m_currentDirectory;
+            } while (0);
+            if (!currentDirectory.isEmpty())
+                directory.prepend(currentDirectory+"/");
         }
     }
     QDir dirInfo(directory);
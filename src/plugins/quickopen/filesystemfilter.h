@@ -44,6 +44,7 @@
 #include <QtCore/QList>
 #include <QtCore/QByteArray>
 #include <QtCore/QFutureInterface>
+#include <QtCore/QMutex>
 
 namespace QuickOpen {
 namespace Internal {
@@ -59,17 +60,22 @@ public:
     QString trName() const { return tr("Files in file system"); }
     QString name() const { return "Files in file system"; }
     QuickOpen::IQuickOpenFilter::Priority priority() const { return QuickOpen::IQuickOpenFilter::Medium; }
-    QList<QuickOpen::FilterEntry> matchesFor(const QString &entry);
+    QList<QuickOpen::FilterEntry> matchesFor(QFutureInterface<QuickOpen::FilterEntry> &future, const QString &entry);
     void accept(QuickOpen::FilterEntry selection) const;
     QByteArray saveState() const;
     bool restoreState(const QByteArray &state);
     bool openConfigDialog(QWidget *parent, bool &needsRefresh);
     void refresh(QFutureInterface<void> &) {}
 
+private slots:
+    void updateCurrentDirectory(Core::IEditor *editor);
+
 private:
     Core::EditorManager *m_editorManager;
     QuickOpenToolWindow *m_toolWindow;
     bool m_includeHidden;
+    QMutex m_mutex;
+    QString m_currentDirectory;
 };
 
 } // namespace Internal
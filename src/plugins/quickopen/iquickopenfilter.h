@@ -99,8 +99,10 @@ public:
     /* String to type to use this filter exclusively. */
     QString shortcutString() const;
 
-    /* List of matches for the given user entry. */
-    virtual QList<FilterEntry> matchesFor(const QString &entry) = 0;
+    /* List of matches for the given user entry. Called in a worker thread, concurrently
+     * with the other filters and with the previous requests that are still running;
+     * return early when the future is canceled, the entry has changed then. */
+    virtual QList<FilterEntry> matchesFor(QFutureInterface<FilterEntry> &future, const QString &entry) = 0;
 
     /* User has selected the given entry that belongs to this filter. */
     virtual void accept(FilterEntry selection) const = 0;
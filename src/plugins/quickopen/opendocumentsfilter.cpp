@@ -33,6 +33,8 @@
 
 #include "opendocumentsfilter.h"
 
+#include <QtCore/QMutexLocker>
+
 Q_DECLARE_METATYPE(Core::IEditor*);
 
 using namespace Core;
@@ -50,7 +52,7 @@ OpenDocumentsFilter::OpenDocumentsFilter(EditorManager *editorManager) :
     setIncludedByDefault(true);
 }
 
-QList<FilterEntry> OpenDocumentsFilter::matchesFor(const QString &entry)
+QList<FilterEntry> OpenDocumentsFilter::matchesFor(QFutureInterface<FilterEntry> &future, const QString &entry)
 {
     QList<FilterEntry> value;
     const QChar asterisk = QLatin1Char('*');
@@ -60,13 +62,19 @@ QList<FilterEntry> OpenDocumentsFilter::matchesFor(const QString &entry)
     const QRegExp regexp(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
     if (!regexp.isValid())
         return value;
-    foreach (IEditor *editor, m_editors) {
-        QString fileName = editor->file()->fileName();
-        if (regexp.exactMatch(editor->displayName())) {
-            QString visibleName;
-            QVariant data;
+    QList<Entry> editors;
+    do {
+        QMutexLocker locker(&m_mutex);
+        editors = m_editors;
+    } while (0);
+
+    foreach (const Entry &editorEntry, editors) {
+        if (future.isCanceled())
+            break;
+        const QString fileName = editorEntry.fileName;
+        if (regexp.exactMatch(editorEntry.displayName)) {
             if (fileName.isEmpty()) {
-                value.append(FilterEntry(this, editor->displayName(), qVariantFromValue(editor)));
+                value.append(FilterEntry(this, editorEntry.displayName, qVariantFromValue(editorEntry.editor)));
             } else {
                 QFileInfo fi(fileName);
                 FilterEntry entry(this, fi.fileName(), fileName);
@@ -81,7 +89,17 @@ QList<FilterEntry> OpenDocumentsFilter::matchesFor(const QString &entry)
 
 void OpenDocumentsFilter::refreshInternally()
 {
-    m_editors = m_editorManager->openedEditors();
+    QList<Entry> editors;
+    foreach (IEditor *editor, m_editorManager->openedEditors()) {
+        Entry entry;
+        entry.editor = editor;
+        entry.displayName = editor->displayName();
+        entry.fileName = editor->file()->fileName();
+        editors.append(entry);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_editors = editors;
 }
 
 void OpenDocumentsFilter::refresh(QFutureInterface<void> &future)
@@ -40,6 +40,7 @@
 #include <QtCore/QList>
 #include <QtCore/QByteArray>
 #include <QtCore/QFutureInterface>
+#include <QtCore/QMutex>
 #include <QtGui/QWidget>
 
 #include <coreplugin/editormanager/editormanager.h>
@@ -57,7 +58,7 @@ public:
     QString trName() const { return tr("Open documents"); }
     QString name() const { return "Open documents"; }
     QuickOpen::IQuickOpenFilter::Priority priority() const { return QuickOpen::IQuickOpenFilter::Medium; }
-    QList<QuickOpen::FilterEntry> matchesFor(const QString &entry);
+    QList<QuickOpen::FilterEntry> matchesFor(QFutureInterface<QuickOpen::FilterEntry> &future, const QString &entry);
     void accept(QuickOpen::FilterEntry selection) const;
     void refresh(QFutureInterface<void> &future);
 
@@ -68,7 +69,16 @@ signals:
 private:
     Core::EditorManager *m_editorManager;
 
-    QList<Core::IEditor *> m_editors;
+    // what matchesFor() needs of the opened editors, it runs in a worker thread.
+    struct Entry
+    {
+        Core::IEditor *editor;
+        QString displayName;
+        QString fileName;
+    };
+
+    QMutex m_mutex;
+    QList<Entry> m_editors;
 };
 
 } // namespace Internal
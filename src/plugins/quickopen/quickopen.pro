@@ -14,6 +14,7 @@ HEADERS += quickopenplugin.h \
     directoryfilter.h \
     quickopenmanager.h \
     basefilefilter.h \
+    filenameindex.h \
     quickopen_global.h
 SOURCES += quickopenplugin.cpp \
     quickopentoolwindow.cpp \
@@ -24,6 +25,7 @@ SOURCES += quickopenplugin.cpp \
     directoryfilter.cpp \
     quickopenmanager.cpp \
     basefilefilter.cpp \
+    filenameindex.cpp \
     iquickopenfilter.cpp
 FORMS += settingspage.ui \
     filesystemfilter.ui \
@@ -58,7 +58,7 @@ public:
     QString trName() const;
     QString name() const;
     Priority priority() const;
-    QList<FilterEntry> matchesFor(const QString &entry);
+    QList<FilterEntry> matchesFor(QFutureInterface<FilterEntry> &future, const QString &entry);
     void accept(FilterEntry selection) const;
     void refresh(QFutureInterface<void> &future);
     bool isConfigurable() const;
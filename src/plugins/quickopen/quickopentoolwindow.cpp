@@ -53,11 +53,14 @@ QT_END_NAMESPACE
 #include <utils/fancylineedit.h>
 #include <utils/qtcassert.h>
 
+#include <qtconcurrent/runextensions.h>
+
 #include <QtCore/QFileInfo>
 #include <QtCore/QFile>
 #include <QtCore/QTimer>
 #include <QtCore/QRegExp>
 #include <QtCore/QSettings>
+#include <QtCore/QVector>
 #include <QtCore/QDebug>
 #include <QtGui/QAction>
 #include <QtGui/QApplication>
@@ -92,11 +95,15 @@ public:
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
 
-    void setEntries(const QList<FilterEntry> &entries);
+    // Starts over with a section per filter; the sections are shown in order.
+    void clear(int sectionCount);
+    void addEntries(int section, const QList<FilterEntry> &entries);
+    void removeEntries(int section, const QSet<FilterEntry> &entries);
     //void setDisplayCount(int count);
 
 private:
     mutable QList<FilterEntry> mEntries;
+    QVector<int> mSectionEnds;
     //int mDisplayCount;
 };
 
@@ -174,11 +181,42 @@ QVariant QuickOpenModel::data(const QModelIndex &index, int role) const
     return QVariant();
 }
 
-void QuickOpenModel::setEntries(const QList<FilterEntry> &entries)
+void QuickOpenModel::clear(int sectionCount)
 {
-    mEntries = entries;
+    mEntries.clear();
+    mSectionEnds.fill(0, sectionCount);
     reset();
 }
+
+void QuickOpenModel::addEntries(int section, const QList<FilterEntry> &entries)
+{
+    if (entries.isEmpty())
+        return;
+
+    const int position = mSectionEnds.at(section);
+    beginInsertRows(QModelIndex(), position, position + entries.size() - 1);
+    mEntries = mEntries.mid(0, position) + entries + mEntries.mid(position);
+    for (int i = section; i < mSectionEnds.size(); ++i)
+        mSectionEnds[i] += entries.size();
+    endInsertRows();
+}
+
+void QuickOpenModel::removeEntries(int section, const QSet<FilterEntry> &entries)
+{
+    if (entries.isEmpty())
+        return;
+
+    const int sectionBegin = section > 0 ? mSectionEnds.at(section - 1) : 0;
+    for (int row = mSectionEnds.at(section) - 1; row >= sectionBegin; --row) {
+        if (!entries.contains(mEntries.at(row)))
+            continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        mEntries.removeAt(row);
+        for (int i = section; i < mSectionEnds.size(); ++i)
+            --mSectionEnds[i];
+        endRemoveRows();
+    }
+}
 #if 0
 void QuickOpenModel::setDisplayCount(int count)
 {
@@ -259,7 +297,8 @@ QuickOpenToolWindow::QuickOpenToolWindow(QuickOpenPlugin *qop) :
      m_filterMenu(new QMenu(this)),
      m_refreshAction(new QAction(tr("Refresh"), this)),
      m_configureAction(new QAction(tr("Configure..."), this)),
-     m_fileLineEdit(new Core::Utils::FancyLineEdit)
+     m_fileLineEdit(new Core::Utils::FancyLineEdit),
+     m_checkDuplicates(false)
 {
     // Explcitly hide the completion list popup.
     m_completionList->hide();
@@ -305,6 +344,14 @@ QuickOpenToolWindow::QuickOpenToolWindow(QuickOpenPlugin *qop) :
             this, SLOT(acceptCurrentEntry()));
 }
 
+QuickOpenToolWindow::~QuickOpenToolWindow()
+{
+    // The filters may be deleted along with their plugins once we are gone
+    cancelFilters();
+    foreach (QFuture<FilterEntry> future, m_canceledFilters)
+        future.waitForFinished();
+}
+
 bool QuickOpenToolWindow::isShowingTypeHereMessage() const
 {
     return m_fileLineEdit->isShowingHintText();
@@ -377,6 +424,13 @@ void QuickOpenToolWindow::textEdited(const QString &text)
     showCompletionList();
 }
 
+static void runFilter(QFutureInterface<FilterEntry> &future, IQuickOpenFilter *filter, QString searchText)
+{
+    const QList<FilterEntry> entries = filter->matchesFor(future, searchText);
+    if (!future.isCanceled())
+        future.reportResults(entries.toVector());
+}
+
 QList<IQuickOpenFilter*> QuickOpenToolWindow::filtersFor(const QString &text, QString &searchText)
 {
     QList<IQuickOpenFilter*> filters = m_quickOpenPlugin->filter();
@@ -403,29 +457,88 @@ QList<IQuickOpenFilter*> QuickOpenToolWindow::filtersFor(const QString &text, QS
 
 void QuickOpenToolWindow::updateCompletionList(const QString &text)
 {
+    cancelFilters();
+
     QString searchText;
     const QList<IQuickOpenFilter*> filters = filtersFor(text, searchText);
-    QSet<FilterEntry> alreadyAdded;
-    const bool checkDuplicates = (filters.size() > 1);
-    QList<FilterEntry> entries;
+    m_addedEntries.fill(QSet<FilterEntry>(), filters.size());
+    m_checkDuplicates = (filters.size() > 1);
+    m_quickOpenModel->clear(filters.size());
+
+    // each filter runs in the thread pool, its matches are shown as soon as it's done.
     foreach (IQuickOpenFilter *filter, filters) {
-        foreach (const FilterEntry &entry, filter->matchesFor(searchText)) {
-            if (checkDuplicates && alreadyAdded.contains(entry))
-                continue;
-            entries.append(entry);
-            if (checkDuplicates)
-                alreadyAdded.insert(entry);
-        }
-    }
-    m_quickOpenModel->setEntries(entries);
-    if (m_quickOpenModel->rowCount() > 0) {
-        m_completionList->setCurrentIndex(m_quickOpenModel->index(0, 0));
+        QFutureWatcher<FilterEntry> *watcher = new QFutureWatcher<FilterEntry>(this);
+        connect(watcher, SIGNAL(resultsReadyAt(int,int)), this, SLOT(filterResultsReady(int,int)));
+        watcher->setFuture(QtConcurrent::run(&runFilter, filter, searchText));
+        m_filterWatchers.append(watcher);
     }
 #if 0
     m_completionList->updatePreferredSize();
 #endif
 }
 
+void QuickOpenToolWindow::cancelFilters()
+{
+    // The canceled filters return early; what they have found by then is
+    // dropped along with their watchers.
+    foreach (QFutureWatcher<FilterEntry> *watcher, m_filterWatchers) {
+        QFuture<FilterEntry> future = watcher->future();
+        if (future.isRunning()) {
+            future.cancel();
+            m_canceledFilters.append(future);
+        }
+        delete watcher;
+    }
+    m_filterWatchers.clear();
+
+    QMutableListIterator<QFuture<FilterEntry> > it(m_canceledFilters);
+    while (it.hasNext()) {
+        if (it.next().isFinished())
+            it.remove();
+    }
+}
+
+void QuickOpenToolWindow::filterResultsReady(int begin, int end)
+{
+    QFutureWatcher<FilterEntry> *watcher = static_cast<QFutureWatcher<FilterEntry> *>(sender());
+    const int section = m_filterWatchers.indexOf(watcher);
+    if (section == -1)
+        return;
+
+    // An entry is shown in the first section that has it, no matter in
+    // which order the filters report their matches.
+    QList<FilterEntry> entries;
+    QSet<FilterEntry> added;
+    for (int i = begin; i < end; ++i) {
+        const FilterEntry entry = watcher->resultAt(i);
+        if (m_checkDuplicates) {
+            bool duplicate = false;
+            for (int s = 0; s <= section && !duplicate; ++s)
+                duplicate = m_addedEntries.at(s).contains(entry);
+            if (duplicate || added.contains(entry))
+                continue;
+            added.insert(entry);
+        }
+        entries.append(entry);
+    }
+
+    // keep the first entry current, unless another one was selected
+    const QModelIndex current = m_completionList->currentIndex();
+    const bool selectFirst = !current.isValid() || current.row() == 0;
+    if (m_checkDuplicates) {
+        m_addedEntries[section] += added;
+        for (int s = section + 1; s < m_addedEntries.size(); ++s) {
+            QSet<FilterEntry> duplicates = m_addedEntries.at(s);
+            duplicates.intersect(added);
+            m_addedEntries[s].subtract(duplicates);
+            m_quickOpenModel->removeEntries(s, duplicates);
+        }
+    }
+    m_quickOpenModel->addEntries(section, entries);
+    if (selectFirst && m_quickOpenModel->rowCount() > 0)
+        m_completionList->setCurrentIndex(m_quickOpenModel->index(0, 0));
+}
+
 void QuickOpenToolWindow::acceptCurrentEntry()
 {
     if (!m_completionList->isVisible())
@@ -37,6 +37,10 @@
 #include "quickopenplugin.h"
 
 #include <QtCore/QEvent>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
 #include <QtGui/QWidget>
 
 QT_BEGIN_NAMESPACE
@@ -65,6 +69,7 @@ class QuickOpenToolWindow
 
 public:
     QuickOpenToolWindow(QuickOpenPlugin *qop);
+    ~QuickOpenToolWindow();
 
     void updateFilterList();
 
@@ -75,6 +80,7 @@ private slots:
     void acceptCurrentEntry();
     void filterSelected();
     void showConfigureDialog();
+    void filterResultsReady(int begin, int end);
 
 private:
     bool eventFilter(QObject *obj, QEvent *event);
@@ -85,6 +91,7 @@ private:
     bool isShowingTypeHereMessage() const;
     void showCompletionList();
     void updateCompletionList(const QString &text);
+    void cancelFilters();
     QList<IQuickOpenFilter*> filtersFor(const QString &text, QString &searchText);
 
     QuickOpenPlugin *m_quickOpenPlugin;
@@ -95,6 +102,13 @@ private:
     QAction *m_refreshAction;
     QAction *m_configureAction;
     Core::Utils::FancyLineEdit *m_fileLineEdit;
+
+    QList<QFutureWatcher<FilterEntry> *> m_filterWatchers;
+    // The canceled filters that may still be running, waited for on destruction.
+    QList<QFuture<FilterEntry> > m_canceledFilters;
+    // The entries shown per section, to drop the duplicates of earlier sections.
+    QVector<QSet<FilterEntry> > m_addedEntries;
+    bool m_checkDuplicates;
 };
 
 } // namespace Internal
@@ -60,9 +60,14 @@ CompletionSupport::CompletionSupport(Core::ICore *core)
       m_completionList(0),
       m_startPosition(0),
       m_checkCompletionTrigger(false),
-      m_editor(0)
+      m_completionPending(false),
+      m_pendingForced(false)
 {
     m_completionCollector = core->pluginManager()->getObject<ICompletionCollector>();
+
+    if (m_completionCollector)
+        connect(m_completionCollector, SIGNAL(completionsReady(int)),
+                this, SLOT(completionsReady(int)));
 }
 
 void CompletionSupport::performCompletion(const CompletionItem &item)
@@ -84,7 +89,7 @@ void CompletionSupport::cleanupCompletions()
         m_checkCompletionTrigger = false;
 
         // Only check for completion trigger when some text was entered
-        if (m_editor->position() > m_startPosition)
+        if (m_editor && m_editor->position() > m_startPosition)
             autoComplete(m_editor, false);
     }
 }
@@ -94,24 +99,82 @@ void CompletionSupport::autoComplete(ITextEditable *editor, bool forced)
     if (!m_completionCollector)
         return;
 
+    bool checkTrigger = !forced;
+
+    if (m_completionPending) {
+        // The user kept typing while the completions were computed. Cancel the
+        // request, and start over when the name being completed was extended.
+        m_completionPending = false;
+        m_completionCollector->cleanup();
+
+        if (editor == m_editor && isCompletingName()) {
+            forced = m_pendingForced;
+            checkTrigger = false;
+        }
+    }
+
     m_editor = editor;
     QList<CompletionItem> completionItems;
 
     if (!m_completionList) {
-        if (!forced && !m_completionCollector->triggersCompletion(editor))
+        if (checkTrigger && !m_completionCollector->triggersCompletion(editor))
             return;
 
         m_startPosition = m_completionCollector->startCompletion(editor);
+
+        if (m_startPosition != -1 && m_completionCollector->completionsPending()) {
+            m_completionPending = true;
+            m_pendingForced = forced;
+            return;
+        }
+
         completionItems = getCompletions();
 
         QTC_ASSERT(m_startPosition != -1 || completionItems.size() == 0, return);
+    } else {
+        completionItems = getCompletions();
 
+        if (completionItems.isEmpty()) {
+            m_completionList->closeList();
+            return;
+        }
+    }
+
+    showCompletions(completionItems, forced);
+}
+
+void CompletionSupport::completionsReady(int startPosition)
+{
+    if (!m_completionPending)
+        return;
+
+    m_completionPending = false;
+
+    if (!m_editor || m_completionList) {
+        m_completionCollector->cleanup();
+        return;
+    }
+
+    m_startPosition = startPosition;
+
+    // The cursor may have been moved away while the completions were computed
+    if (!isCompletingName()) {
+        m_completionCollector->cleanup();
+        return;
+    }
+
+    showCompletions(getCompletions(), m_pendingForced);
+}
+
+void CompletionSupport::showCompletions(const QList<CompletionItem> &completionItems, bool forced)
+{
+    if (!m_completionList) {
         if (completionItems.isEmpty()) {
             cleanupCompletions();
             return;
         }
 
-        m_completionList = new CompletionWidget(this, editor);
+        m_completionList = new CompletionWidget(this, m_editor);
 
         connect(m_completionList, SIGNAL(itemSelected(TextEditor::CompletionItem)),
                 this, SLOT(performCompletion(TextEditor::CompletionItem)));
@@ -123,13 +186,6 @@ void CompletionSupport::autoComplete(ITextEditable *editor, bool forced)
         // for example when switching applications on the Mac)
         connect(m_completionList, SIGNAL(destroyed(QObject*)),
                 this, SLOT(cleanupCompletions()));
-    } else {
-        completionItems = getCompletions();
-
-        if (completionItems.isEmpty()) {
-            m_completionList->closeList();
-            return;
-        }
     }
 
     m_completionList->setCompletionItems(completionItems);
@@ -143,6 +199,22 @@ void CompletionSupport::autoComplete(ITextEditable *editor, bool forced)
     }
 }
 
+// Returns whether only the characters of a name were typed since the start of the completion
+bool CompletionSupport::isCompletingName() const
+{
+    const int position = m_editor->position();
+    if (m_startPosition == -1 || position < m_startPosition)
+        return false;
+
+    for (int i = m_startPosition; i < position; ++i) {
+        const QChar ch = m_editor->characterAt(i);
+        if (!ch.isLetterOrNumber() && ch != QLatin1Char('_'))
+            return false;
+    }
+
+    return true;
+}
+
 static bool completionItemLessThan(const CompletionItem &i1, const CompletionItem &i2)
 {
     // The order is case-insensitive in principle, but case-sensitive when this would otherwise mean equality
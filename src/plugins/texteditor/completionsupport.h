@@ -37,6 +37,7 @@
 #include <texteditor/texteditor_global.h>
 
 #include <QtCore/QObject>
+#include <QtCore/QPointer>
 
 namespace Core { class ICore; }
 
@@ -67,14 +68,19 @@ public slots:
 private slots:
     void performCompletion(const TextEditor::CompletionItem &item);
     void cleanupCompletions();
+    void completionsReady(int startPosition);
 
 private:
     QList<CompletionItem> getCompletions() const;
+    void showCompletions(const QList<CompletionItem> &completionItems, bool forced);
+    bool isCompletingName() const;
 
     CompletionWidget *m_completionList;
     int m_startPosition;
     bool m_checkCompletionTrigger;          // Whether to check for completion trigger after cleanup
-    ITextEditable *m_editor;
+    bool m_completionPending;               // Whether the collector is still computing the completions
+    bool m_pendingForced;
+    QPointer<ITextEditable> m_editor;
     ICompletionCollector *m_completionCollector;
 };
 
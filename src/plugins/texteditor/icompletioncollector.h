@@ -88,6 +88,13 @@ public:
     // returns starting position
     virtual int startCompletion(ITextEditable *editor) = 0;
 
+    /* This method should return whether the completions requested by the last
+     * call to startCompletion are still being computed. A collector computing
+     * them in the background returns true and emits completionsReady when they
+     * are available; until then, a call to cleanup cancels the request.
+     */
+    virtual bool completionsPending() const { return false; }
+
     /* This method should add all the completions it wants to show into the list,
      * based on the given cursor position.
      */
@@ -108,6 +115,13 @@ public:
     /* Called when it's safe to clean up the completion items.
      */
     virtual void cleanup() = 0;
+
+signals:
+    /* Emitted when the pending completions are available. The starting position
+     * may differ from the one returned by startCompletion, when the collector had
+     * to edit the text in front of it.
+     */
+    void completionsReady(int startPosition);
 };
 
 } // namespace TextEditor
@@ -36,6 +36,7 @@
 
 #include <coreplugin/editormanager/editormanager.h>
 
+#include <QtCore/QMutexLocker>
 #include <QtCore/QVariant>
 
 using namespace Core;
@@ -44,19 +45,37 @@ using namespace TextEditor;
 using namespace TextEditor::Internal;
 
 LineNumberFilter::LineNumberFilter(EditorManager *editorManager, QObject *parent):
-    IQuickOpenFilter(parent)
+    IQuickOpenFilter(parent),
+    m_hasCurrentTextEditor(false)
 {
     m_editorManager = editorManager;
+    connect(m_editorManager, SIGNAL(currentEditorChanged(Core::IEditor*)),
+            this, SLOT(updateCurrentTextEditor()));
+    updateCurrentTextEditor();
     setShortcutString("l");
     setIncludedByDefault(true);
 }
 
-QList<FilterEntry> LineNumberFilter::matchesFor(const QString &entry)
+void LineNumberFilter::updateCurrentTextEditor()
 {
+    const bool hasCurrentTextEditor = (currentTextEditor() != 0);
+
+    QMutexLocker locker(&m_mutex);
+    m_hasCurrentTextEditor = hasCurrentTextEditor;
+}
+
+QList<FilterEntry> LineNumberFilter::matchesFor(QFutureInterface<FilterEntry> &future, const QString &entry)
+{
+    Q_UNUSED(future);
     bool ok;
     QList<FilterEntry> value;
     int line = entry.toInt(&ok);
-    if (line > 0 && currentTextEditor())
+    bool hasCurrentTextEditor;
+    do {
+        QMutexLocker locker(&m_mutex);
+        hasCurrentTextEditor = m_hasCurrentTextEditor;
+    } while (0);
+    if (line > 0 && hasCurrentTextEditor)
         value.append(FilterEntry(this, QString("Line %1").arg(line), QVariant(line)));
     return value;
 }
@@ -40,6 +40,7 @@
 #include <QtCore/QList>
 #include <QtCore/QByteArray>
 #include <QtCore/QFutureInterface>
+#include <QtCore/QMutex>
 #include <QtGui/QWidget>
 
 namespace Core {
@@ -61,14 +62,19 @@ public:
     QString trName() const { return tr("Line in current document"); }
     QString name() const { return "Line in current document"; }
     QuickOpen::IQuickOpenFilter::Priority priority() const { return QuickOpen::IQuickOpenFilter::High; }
-    QList<QuickOpen::FilterEntry> matchesFor(const QString &entry);
+    QList<QuickOpen::FilterEntry> matchesFor(QFutureInterface<QuickOpen::FilterEntry> &future, const QString &entry);
     void accept(QuickOpen::FilterEntry selection) const;
     void refresh(QFutureInterface<void> &) {}
 
+private slots:
+    void updateCurrentTextEditor();
+
 private:
     ITextEditor *currentTextEditor() const;
 
     Core::EditorManager *m_editorManager;
+    QMutex m_mutex;
+    bool m_hasCurrentTextEditor;
 };
 
 } // namespace Internal
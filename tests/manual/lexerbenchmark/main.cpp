@@ -0,0 +1,153 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+// Measures the throughput of the Lexer and computes a checksum of the token
+// stream, e.g. over the Qt headers:
+//
+//   ./lexerbenchmark -n 10 $QTDIR/include/*/q*.h
+//
+// The checksum covers the kind, position, line and flags of every token,
+// with and without comment tokens. To make sure that the SSE2 code paths
+// produce the same tokens as the plain C++ ones, build the benchmark again
+// with qmake "DEFINES+=CPLUSPLUS_NO_SIMD" and compare the checksums.
+
+#include <Lexer.h>
+#include <Token.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+
+#include <cstdio>
+#include <cstdlib>
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-n iterations] file...\n", program);
+}
+
+static inline unsigned hashCombine(unsigned hash, unsigned value)
+{ return (hash ^ value) * 16777619u; } // FNV-1a
+
+static unsigned lex(const QByteArray &source, bool scanCommentTokens, unsigned *tokenCount)
+{
+    Lexer lexer(source.constBegin(), source.constEnd());
+    lexer.setScanKeywords(true);
+    lexer.setScanCommentTokens(scanCommentTokens);
+
+    unsigned hash = 2166136261u;
+    Token tk;
+    do {
+        lexer(&tk);
+        hash = hashCombine(hash, tk.kind);
+        hash = hashCombine(hash, tk.offset);
+        hash = hashCombine(hash, tk.length);
+        hash = hashCombine(hash, tk.lineno);
+        hash = hashCombine(hash, (tk.newline << 2) | (tk.whitespace << 1) | tk.joined);
+        ++*tokenCount;
+    } while (tk.isNot(T_EOF_SYMBOL));
+
+    return hash;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    const char *program = argv[0];
+    args.removeFirst();
+
+    int iterations = 1;
+    QStringList files;
+    while (! args.isEmpty()) {
+        const QString arg = args.takeFirst();
+        if (arg == QLatin1String("-n") && ! args.isEmpty())
+            iterations = qMax(1, args.takeFirst().toInt());
+        else if (arg.startsWith(QLatin1Char('-'))) {
+            usage(program);
+            return EXIT_FAILURE;
+        } else
+            files.append(arg);
+    }
+
+    if (files.isEmpty()) {
+        usage(program);
+        return EXIT_FAILURE;
+    }
+
+    QList<QByteArray> sources;
+    qint64 totalSize = 0;
+    foreach (const QString &fileName, files) {
+        QFile file(fileName);
+        if (! file.open(QFile::ReadOnly)) {
+            fprintf(stderr, "%s: cannot open %s\n", program, qPrintable(fileName));
+            return EXIT_FAILURE;
+        }
+        sources.append(file.readAll());
+        totalSize += sources.last().size();
+    }
+
+    unsigned checksum = 0, commentChecksum = 0, tokenCount = 0;
+    int lexTime = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        unsigned hash = 0, commentHash = 0, count = 0;
+
+        QTime timer;
+        timer.start();
+        foreach (const QByteArray &source, sources)
+            hash = hashCombine(hash, lex(source, /*scanCommentTokens = */ false, &count));
+        lexTime += timer.elapsed();
+
+        foreach (const QByteArray &source, sources) {
+            unsigned ignored = 0;
+            commentHash = hashCombine(commentHash, lex(source, /*scanCommentTokens = */ true, &ignored));
+        }
+
+        checksum = hash;
+        commentChecksum = commentHash;
+        tokenCount = count;
+    }
+
+    const double megabytes = totalSize * iterations / (1024.0 * 1024.0);
+    printf("%d file(s), %d iteration(s), %.1f MB, %u tokens per iteration\n",
+           files.size(), iterations, megabytes, tokenCount);
+    printf("lex: %6d ms (%.1f MB/s)\n", lexTime,
+           lexTime ? megabytes * 1000.0 / lexTime : 0.0);
+    printf("checksum: %08x (with comments: %08x)\n", checksum, commentChecksum);
+
+    return EXIT_SUCCESS;
+}
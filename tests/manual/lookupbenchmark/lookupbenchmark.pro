@@ -0,0 +1,12 @@
+QT = core
+macx:CONFIG -= app_bundle
+TARGET = lookupbenchmark
+
+IDE_BUILD_TREE = $$OUT_PWD/../../..
+include(../../../src/qworkbench.pri)
+include(../../../src/libs/cplusplus/cplusplus.pri)
+
+unix:QMAKE_RPATHDIR += $$IDE_LIBRARY_PATH
+
+# Input
+SOURCES += main.cpp
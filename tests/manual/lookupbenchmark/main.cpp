@@ -0,0 +1,173 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+// Measures the throughput of LookupContext::resolve, that is of the symbol
+// tables of Scope.
+//
+// The benchmark expects preprocessed sources, e.g. the Qt headers:
+//
+//   echo '#include <QtGui>' | g++ -E -P -x c++ -I$QTDIR/include - > qtgui.i
+//   ./lookupbenchmark -n 10 qtgui.i
+//
+// Every named symbol of the documents is used as the context of a lookup of
+// the names declared in the documents, so that both the large global and
+// namespace scopes and the small class and block scopes are searched.
+// Compare the numbers of two builds to measure a change of the tables; the
+// candidate count must not change.
+
+#include <cplusplus/CppDocument.h>
+#include <cplusplus/LookupContext.h>
+
+#include <Control.h>
+#include <Names.h>
+#include <Scope.h>
+#include <Symbols.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+
+#include <cstdio>
+#include <cstdlib>
+
+using namespace CPlusPlus;
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-n iterations] [-c contexts] file.i...\n", program);
+}
+
+static void collectSymbols(Scope *scope, QList<Symbol *> *symbols)
+{
+    for (unsigned i = 0; i < scope->symbolCount(); ++i) {
+        Symbol *symbol = scope->symbolAt(i);
+        if (symbol->name() && ! symbol->name()->isQualifiedNameId())
+            symbols->append(symbol);
+        if (ScopedSymbol *scoped = symbol->asScopedSymbol())
+            collectSymbols(scoped->members(), symbols);
+        if (Function *function = symbol->asFunction())
+            collectSymbols(function->arguments(), symbols);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    const char *program = argv[0];
+    args.removeFirst();
+
+    int iterations = 1;
+    int contextCount = 1000;
+    QStringList files;
+    while (! args.isEmpty()) {
+        const QString arg = args.takeFirst();
+        if (arg == QLatin1String("-n") && ! args.isEmpty())
+            iterations = qMax(1, args.takeFirst().toInt());
+        else if (arg == QLatin1String("-c") && ! args.isEmpty())
+            contextCount = qMax(1, args.takeFirst().toInt());
+        else if (arg.startsWith(QLatin1Char('-'))) {
+            usage(program);
+            return EXIT_FAILURE;
+        } else
+            files.append(arg);
+    }
+
+    if (files.isEmpty()) {
+        usage(program);
+        return EXIT_FAILURE;
+    }
+
+    QTime timer;
+    timer.start();
+
+    Snapshot snapshot;
+    foreach (const QString &fileName, files) {
+        QFile file(fileName);
+        if (! file.open(QFile::ReadOnly)) {
+            fprintf(stderr, "%s: cannot open %s\n", program, qPrintable(fileName));
+            return EXIT_FAILURE;
+        }
+
+        Document::Ptr doc = Document::create(fileName);
+        doc->setSource(file.readAll());
+        doc->parse();
+        doc->check();
+        snapshot.insert(fileName, doc);
+    }
+
+    const int checkTime = timer.restart();
+
+    int resolveTime = 0;
+    int lookupCount = 0;
+    int candidateCount = 0;
+
+    foreach (Document::Ptr doc, snapshot) {
+        QList<Symbol *> symbols;
+        collectSymbols(doc->globalSymbols(), &symbols);
+        if (symbols.isEmpty())
+            continue;
+
+        // Spread the contexts over the document.
+        const int step = qMax(1, symbols.size() / contextCount);
+        QList<LookupContext> contexts;
+        for (int i = 0; i < symbols.size(); i += step)
+            contexts.append(LookupContext(symbols.at(i), doc, doc, snapshot));
+
+        QList<Name *> names;
+        for (int i = 0; i < symbols.size(); i += qMax(1, symbols.size() / 100))
+            names.append(symbols.at(i)->name());
+
+        timer.restart();
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            foreach (const LookupContext &context, contexts) {
+                foreach (Name *name, names) {
+                    candidateCount += context.resolve(name).size();
+                    ++lookupCount;
+                }
+            }
+        }
+        resolveTime += timer.elapsed();
+    }
+
+    printf("%d file(s), %d iteration(s), check: %d ms\n",
+           files.size(), iterations, checkTime);
+    printf("resolve: %6d ms, %d lookups (%.0f lookups/s), %d candidates\n",
+           resolveTime, lookupCount,
+           resolveTime ? lookupCount * 1000.0 / resolveTime : 0.0,
+           candidateCount);
+
+    return EXIT_SUCCESS;
+}
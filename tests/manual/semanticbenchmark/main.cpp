@@ -0,0 +1,140 @@
+/***************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2008 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact:  Qt Software Information (qt-info@nokia.com)
+**
+**
+** Non-Open Source Usage
+**
+** Licensees may use this file in accordance with the Qt Beta Version
+** License Agreement, Agreement version 2.2 provided with the Software or,
+** alternatively, in accordance with the terms contained in a written
+** agreement between you and Nokia.
+**
+** GNU General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License versions 2.0 or 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the packaging
+** of this file.  Please review the following information to ensure GNU
+** General Public Licensing requirements will be met:
+**
+** http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt GPL Exception
+** version 1.3, included in the file GPL_EXCEPTION.txt in this package.
+**
+***************************************************************************/
+
+
+// Measures the throughput of Semantic::check.
+//
+// The benchmark expects preprocessed sources, e.g. the Qt headers:
+//
+//   echo '#include <QtGui>' | g++ -E -P -x c++ -I$QTDIR/include - > qtgui.i
+//   ./semanticbenchmark -n 10 qtgui.i
+//
+// Every file is parsed and checked -n times, each time with a fresh Control,
+// so that the cost of creating the canonical names and types is included.
+
+#include <AST.h>
+#include <Control.h>
+#include <Scope.h>
+#include <Semantic.h>
+#include <TranslationUnit.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+
+#include <cstdio>
+#include <cstdlib>
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-n iterations] file.i...\n", program);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    const char *program = argv[0];
+    args.removeFirst();
+
+    int iterations = 1;
+    QStringList files;
+    while (! args.isEmpty()) {
+        const QString arg = args.takeFirst();
+        if (arg == QLatin1String("-n") && ! args.isEmpty())
+            iterations = qMax(1, args.takeFirst().toInt());
+        else if (arg.startsWith(QLatin1Char('-'))) {
+            usage(program);
+            return EXIT_FAILURE;
+        } else
+            files.append(arg);
+    }
+
+    if (files.isEmpty()) {
+        usage(program);
+        return EXIT_FAILURE;
+    }
+
+    int parseTime = 0, checkTime = 0;
+    qint64 totalSize = 0;
+    unsigned declarationCount = 0;
+
+    foreach (const QString &fileName, files) {
+        QFile file(fileName);
+        if (! file.open(QFile::ReadOnly)) {
+            fprintf(stderr, "%s: cannot open %s\n", program, qPrintable(fileName));
+            return EXIT_FAILURE;
+        }
+
+        const QByteArray source = file.readAll();
+        const QByteArray fileNameUtf8 = fileName.toUtf8();
+
+        for (int i = 0; i < iterations; ++i) {
+            Control control;
+            StringLiteral *fileId = control.findOrInsertFileName(fileNameUtf8.constData(),
+                                                                 fileNameUtf8.size());
+            TranslationUnit unit(&control, fileId);
+            unit.setQtMocRunEnabled(true);
+            unit.setSource(source.constData(), source.size());
+
+            QTime timer;
+            timer.start();
+            unit.parse();
+            parseTime += timer.restart();
+
+            if (TranslationUnitAST *ast = unit.ast() ? unit.ast()->asTranslationUnit() : 0) {
+                Scope globalScope;
+                Semantic sem(&control);
+                for (DeclarationAST *decl = ast->declarations; decl; decl = decl->next) {
+                    sem.check(decl, &globalScope);
+                    ++declarationCount;
+                }
+            }
+            checkTime += timer.elapsed();
+            totalSize += source.size();
+        }
+    }
+
+    const double megabytes = totalSize / (1024.0 * 1024.0);
+    printf("%d file(s), %d iteration(s), %.1f MB, %u top-level declarations\n",
+           files.size(), iterations, megabytes, declarationCount);
+    printf("parse: %6d ms (%.1f MB/s)\n", parseTime,
+           parseTime ? megabytes * 1000.0 / parseTime : 0.0);
+    printf("check: %6d ms (%.1f MB/s, %.0f declarations/s)\n", checkTime,
+           checkTime ? megabytes * 1000.0 / checkTime : 0.0,
+           checkTime ? declarationCount * 1000.0 / checkTime : 0.0);
+
+    return EXIT_SUCCESS;
+}